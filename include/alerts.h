@@ -0,0 +1,107 @@
+#ifndef ALERTS_H
+#define ALERTS_H
+
+#include "common.h"
+#include "config.h"
+#include "filter.h"
+
+// Tracked (rule, process) pairs that are pending or firing
+#define ALERT_MAX_TRACKED 1024
+#define ALERT_NAME_LEN 32
+
+typedef enum {
+    ALERT_PROCESS,      // Filter expression, fires per matching process
+    ALERT_COUNT,        // count(FILTER) OP N
+    ALERT_SYSTEM        // system.FIELD OP N
+} AlertScope;
+
+typedef enum {
+    ALERT_SYS_MEM,      // Memory used (%)
+    ALERT_SYS_SWAP,     // Swap used (%)
+    ALERT_SYS_CPU,      // CPU busy (%)
+    ALERT_SYS_LOAD,     // 1-minute load average
+    ALERT_SYS_PROCS     // Number of processes
+} AlertSystemField;
+
+/**
+ * @brief A firing alert, for display.
+ */
+typedef struct {
+    char name[ALERT_NAME_LEN];
+    pid_t pid;                  // 0 for count and system rules
+    char process[MAX_NAME_LEN]; // Process name (process rules)
+    double value;               // Measured value (count and system rules)
+    time_t since;               // When it started firing
+} AlertEvent;
+
+/**
+ * @brief Cost of the last evaluation.
+ */
+typedef struct {
+    int rules;                  // Compiled rules
+    int evaluated;              // Rules evaluated in the last refresh
+    double eval_ms;             // Time spent in the last evaluation
+    int firing;                 // Alerts currently firing
+} AlertStats;
+
+/**
+ * @brief Compiles the alert rules of the configuration.
+ *
+ * Rule syntax: "NAME: CONDITION [for DURATION] [clear CONDITION]", where a
+ * condition is a filter expression (per process, e.g. "rss>8G"),
+ * "count(FILTER)>N" or "system.mem>90" (mem, swap, cpu, load, procs).
+ * DURATION is a number with an optional s/m/h suffix; the condition must
+ * hold that long before the alert fires. Without "clear" an alert resolves
+ * as soon as its condition is false; with it, only once the clear condition
+ * holds (hysteresis).
+ *
+ * @param sources Rule strings.
+ * @param count Number of rules.
+ * @param error Buffer for the first error, prefixed with the rule number.
+ * @param error_size Size of the error buffer.
+ * @return int 0 on success, -1 on error (no rules are active).
+ */
+int alerts_compile(const char sources[][ALERT_RULE_LEN], int count, char *error, size_t error_size);
+
+/**
+ * @brief Evaluates the rules against one snapshot.
+ *
+ * Rules are evaluated round-robin within a time budget; rules left over
+ * continue on the next refresh, so hundreds of rules cannot stall the UI.
+ * State changes are appended to the alert log and passed to the hook.
+ *
+ * @param processes Snapshot rows.
+ * @param count Number of rows.
+ * @param sysinfo System totals of the snapshot.
+ * @param load1 1-minute load average.
+ * @param budget_ms Evaluation time budget (0 = unlimited).
+ */
+void alerts_evaluate(const ProcessInfo processes[], int count, const sysinfo_t *sysinfo,
+                     float load1, int budget_ms);
+
+/**
+ * @brief Copies the firing alerts, oldest first.
+ *
+ * @return int Number of alerts copied.
+ */
+int alerts_firing(AlertEvent events[], int max_events);
+
+/**
+ * @brief Returns true if a process rule is firing for 'pid'.
+ */
+bool alerts_is_firing(pid_t pid);
+
+/**
+ * @brief Returns the scan flags the filters of the compiled rules need.
+ *
+ * See filter_scan_flags(); a rule on read rates or context switches must
+ * get them measured even while their columns are hidden.
+ */
+unsigned int alerts_scan_flags(void);
+
+/**
+ * @brief Returns the cost of the last evaluation.
+ */
+AlertStats alerts_stats(void);
+
+#endif // ALERTS_H
@@ -0,0 +1,154 @@
+#ifndef ALTTASKER_SHM_H
+#define ALTTASKER_SHM_H
+
+/*
+ * Layout of the shared-memory snapshot published by AltTasker
+ * (shm_snapshot=true) and a header-only reader for other local tools.
+ *
+ * The region is a POSIX shared memory object (/dev/shm/alttasker-UID) with
+ * a fixed layout: a header with system totals, one array per process field
+ * (structure of arrays) and a pool of NUL-terminated strings. A sequence
+ * counter makes it a seqlock: it is odd while the writer updates the region,
+ * so a reader copies what it needs and retries if the counter moved.
+ *
+ *     const AtsShmRegion *r = ats_shm_attach();
+ *     uint64_t seq;
+ *     do {
+ *         seq = ats_shm_read_begin(r);
+ *         ... read r->header.count, r->pid[i], ats_shm_string(r, r->name[i]) ...
+ *     } while (ats_shm_read_retry(r, seq));
+ *     ats_shm_detach(r);
+ *
+ * Readers only need this file. Define _POSIX_C_SOURCE 200809L (or _GNU_SOURCE)
+ * before including it; link with -lrt on glibc older than 2.34.
+ */
+
+#include <fcntl.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <sys/mman.h>
+#include <time.h>
+#include <unistd.h>
+
+#define ATS_SHM_MAGIC     0x4d485341u   // "ASHM"
+#define ATS_SHM_VERSION   1u
+#define ATS_SHM_MAX_ROWS  1024u         // Same as MAX_PROCESS
+#define ATS_SHM_POOL_SIZE (1024u * 1024u)
+
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t region_size;           // sizeof(AtsShmRegion) of the writer
+    uint32_t count;                 // Rows valid in every column
+    _Atomic uint64_t sequence;      // Odd while a snapshot is being written
+    int64_t timestamp_ns;           // CLOCK_REALTIME of the scan
+    // System totals (bytes, percent, seconds)
+    uint64_t total_mem;
+    uint64_t used_mem;
+    uint64_t available_mem;
+    uint64_t cached_mem;
+    uint64_t swap_total;
+    uint64_t swap_used;
+    uint64_t uptime;
+    float mem_usage_percent;
+    float cpu_usage_percent;
+    uint32_t total_processes;
+    uint32_t pool_used;             // Bytes of the string pool in use
+} AtsShmHeader;
+
+typedef struct {
+    AtsShmHeader header;
+    // One column per field, indexed by row (in scan order)
+    int32_t pid[ATS_SHM_MAX_ROWS];
+    int32_t ppid[ATS_SHM_MAX_ROWS];
+    uint32_t uid[ATS_SHM_MAX_ROWS];
+    float cpu_usage[ATS_SHM_MAX_ROWS];          // Percent
+    float mem_usage[ATS_SHM_MAX_ROWS];          // Percent of total memory
+    float read_rate[ATS_SHM_MAX_ROWS];          // Disk bytes/s (0 unless I/O is read)
+    float write_rate[ATS_SHM_MAX_ROWS];
+    uint64_t rss[ATS_SHM_MAX_ROWS];             // Bytes
+    uint64_t vsize[ATS_SHM_MAX_ROWS];           // Bytes
+    uint64_t start_ticks[ATS_SHM_MAX_ROWS];     // (pid, start_ticks) identifies a process
+    char state[ATS_SHM_MAX_ROWS];               // R, S, D, Z, T, I
+    // Offsets into pool; offset 0 is the empty string
+    uint32_t name[ATS_SHM_MAX_ROWS];
+    uint32_t user[ATS_SHM_MAX_ROWS];
+    uint32_t cmdline[ATS_SHM_MAX_ROWS];
+    char pool[ATS_SHM_POOL_SIZE];
+} AtsShmRegion;
+
+/**
+ * @brief Writes the shared memory object name for a user ("/alttasker-UID").
+ */
+static inline void ats_shm_name(char *buffer, size_t size, unsigned int uid) {
+    snprintf(buffer, size, "/alttasker-%u", uid);
+}
+
+/**
+ * @brief Maps the snapshot of the calling user read-only.
+ *
+ * @return const AtsShmRegion* The region, or NULL if no compatible publisher exists.
+ */
+static inline const AtsShmRegion* ats_shm_attach(void) {
+    char name[64];
+    ats_shm_name(name, sizeof(name), (unsigned int)getuid());
+
+    int fd = shm_open(name, O_RDONLY, 0);
+    if (fd < 0) return NULL;
+    void *map = mmap(NULL, sizeof(AtsShmRegion), PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) return NULL;
+
+    const AtsShmRegion *region = (const AtsShmRegion *)map;
+    if (region->header.magic != ATS_SHM_MAGIC || region->header.version != ATS_SHM_VERSION ||
+        region->header.region_size != sizeof(AtsShmRegion)) {
+        munmap(map, sizeof(AtsShmRegion));
+        return NULL;
+    }
+    return region;
+}
+
+/**
+ * @brief Unmaps a region returned by ats_shm_attach().
+ */
+static inline void ats_shm_detach(const AtsShmRegion *region) {
+    if (region) munmap((void *)region, sizeof(AtsShmRegion));
+}
+
+/**
+ * @brief Starts a read: waits until no write is in progress.
+ *
+ * @return uint64_t Sequence to pass to ats_shm_read_retry().
+ */
+static inline uint64_t ats_shm_read_begin(const AtsShmRegion *region) {
+    uint64_t seq;
+    while ((seq = atomic_load_explicit((_Atomic uint64_t *)&region->header.sequence,
+                                       memory_order_acquire)) & 1u) {
+        struct timespec pause = { 0, 100000 };  // The writer holds it for well under 1 ms
+        nanosleep(&pause, NULL);
+    }
+    return seq;
+}
+
+/**
+ * @brief Ends a read.
+ *
+ * @return bool True if the writer published meanwhile and the data read
+ *              since ats_shm_read_begin() must be discarded.
+ */
+static inline bool ats_shm_read_retry(const AtsShmRegion *region, uint64_t seq) {
+    atomic_thread_fence(memory_order_acquire);
+    return atomic_load_explicit((_Atomic uint64_t *)&region->header.sequence,
+                                memory_order_relaxed) != seq;
+}
+
+/**
+ * @brief Returns the string at a pool offset (only valid inside a read).
+ */
+static inline const char* ats_shm_string(const AtsShmRegion *region, uint32_t offset) {
+    return offset < ATS_SHM_POOL_SIZE ? region->pool + offset : "";
+}
+
+#endif // ALTTASKER_SHM_H
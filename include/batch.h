@@ -0,0 +1,22 @@
+#ifndef BATCH_H
+#define BATCH_H
+
+#include "common.h"
+#include "filter.h"
+
+/**
+ * @brief Prints one snapshot of the process table to stdout as plain text.
+ * 
+ * Scans /proc twice, one second apart, so that CPU% and the read/write
+ * rates (in the filter and the sort) cover that second rather than the
+ * process lifetime. Keeps the processes matching the filter, sorts them and
+ * prints one line per process without colors or terminal control codes, so
+ * the output can be piped into other tools.
+ * 
+ * @param filter Compiled filter (NULL or empty for all processes).
+ * @param sort Sort order of the rows.
+ * @return int 0 on success, non-zero on failure.
+ */
+int run_batch(const ProcessFilter *filter, SortMode sort);
+
+#endif // BATCH_H
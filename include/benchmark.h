@@ -0,0 +1,17 @@
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+/**
+ * @brief Times full /proc scans with every available data source.
+ * 
+ * Runs a warm-up scan followed by 'iterations' timed scans per backend and
+ * prints wall time and CPU time per refresh and per process to stdout. The
+ * syscalls of one refresh are counted by running it in a child under ptrace
+ * ("n/a" where ptrace is not permitted).
+ * 
+ * @param iterations Number of timed scans per backend.
+ * @return int 0 on success, non-zero on failure.
+ */
+int run_benchmark(int iterations);
+
+#endif // BENCHMARK_H
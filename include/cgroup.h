@@ -0,0 +1,49 @@
+#ifndef CGROUP_H
+#define CGROUP_H
+
+#include "common.h"
+#include "group.h"
+
+// Maximum number of cgroups tracked at once (empty ones are freed on refresh)
+#define MAX_CGROUPS 512
+#define CGROUP_PATH_LEN 256
+
+/**
+ * @brief Resolves the cgroup v2 membership of every process and reads the
+ *        cgroup files of every cgroup that contains one.
+ *
+ * /proc/[pid]/cgroup is read once per PID lifetime (cached in the per-PID
+ * table). cpu.stat, memory.current, memory.pressure and io.stat are read once
+ * per cgroup, so the cost scales with the number of cgroups rather than the
+ * number of processes. Cgroups left without processes are forgotten, so
+ * transient scopes don't use up MAX_CGROUPS. Call once per refresh.
+ *
+ * @param processes Process table.
+ * @param count Number of processes.
+ * @return int Number of cgroups sampled, or -1 if no cgroup2 hierarchy is mounted.
+ */
+int cgroup_refresh(const ProcessInfo processes[], int count);
+
+/**
+ * @brief Builds the cgroup tree as display groups.
+ *
+ * Groups are emitted depth-first (parents before children, siblings sorted
+ * by 'sort'), and only cgroups with processes among 'processes' in their
+ * subtree are included. CPU%, memory and disk rates come from the cgroup
+ * files sampled by cgroup_refresh(); when a file is missing (e.g. the root
+ * cgroup has no memory.current) the members' values are summed instead.
+ *
+ * @param processes Displayed processes (already filtered).
+ * @param count Number of processes.
+ * @param sort Order of siblings.
+ * @param total_mem Total system memory in bytes (for MEM%).
+ * @param groups Destination array.
+ * @param max_groups Capacity of the destination array.
+ * @param group_of Receives the group id (cgroup) of each process, -1 if unknown.
+ * @return int Number of groups.
+ */
+int cgroup_build_groups(const ProcessInfo processes[], int count, SortMode sort,
+                        unsigned long total_mem, ProcessGroup groups[], int max_groups,
+                        int group_of[]);
+
+#endif // CGROUP_H
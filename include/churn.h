@@ -0,0 +1,62 @@
+#ifndef CHURN_H
+#define CHURN_H
+
+#include "common.h"
+
+// Number of entries kept in the churn tracker's "recently exited" list
+#define CHURN_RECENT_EXITS 8
+// Bytes of the name kept per process for its exit record
+#define CHURN_NAME_LEN 64
+
+/**
+ * @brief Process churn between the last two snapshots.
+ */
+typedef struct {
+    bool valid;             // Two comparable snapshots were taken
+    int started;            // Processes in the last snapshot but not the one before
+    int exited;             // Processes in the one before but not the last
+    float start_rate;       // started per second
+    float exit_rate;        // exited per second
+} ChurnStats;
+
+/**
+ * @brief Compares a new snapshot of the process table with the previous one.
+ *
+ * Both snapshots are kept sorted by (pid, starttime) and compared in one
+ * merge pass, so a refresh costs O(n) (O(n log n) only when the rows are
+ * not in PID order already, as /proc lists them). A recycled PID counts as
+ * an exit plus a start. Rows of processes that started since the previous
+ * snapshot get is_new set; processes that disappeared are added to the
+ * "recently exited" list with the CPU, memory and lifetime they were last
+ * seen with (the exit itself happened before the next snapshot).
+ *
+ * A snapshot of MAX_PROCESS rows is taken as a scan that stopped early:
+ * only PIDs up to the last one both snapshots reached are compared, so
+ * churn above that PID is not counted rather than reported as exits.
+ *
+ * @param rows The freshly scanned rows (is_new is written).
+ * @param count Number of rows.
+ * @param uptime Seconds since boot when the rows were read.
+ */
+void churn_update(ProcessInfo rows[], int count, float uptime);
+
+/**
+ * @brief Forgets the previous snapshot, e.g. when kernel threads were
+ *        hidden, so the next update reports no churn.
+ */
+void churn_reset(void);
+
+/**
+ * @brief Returns the churn measured by the last churn_update().
+ */
+ChurnStats churn_stats(void);
+
+/**
+ * @brief Returns the recently exited processes, newest first.
+ *
+ * @param list Destination array with room for CHURN_RECENT_EXITS entries.
+ * @return int Number of entries copied.
+ */
+int churn_recent_exits(ExitedProcess list[]);
+
+#endif // CHURN_H
@@ -10,6 +10,7 @@
 #include <sys/types.h>
 #include <pwd.h>
 #include <time.h>
+#include <stdbool.h>
 
 #define MAX_NAME_LEN 256
 #define MAX_CMDLINE_LEN 512
@@ -22,7 +23,12 @@ typedef enum {
     SORT_BY_PID,
     SORT_BY_CPU,
     SORT_BY_MEM,
-    SORT_BY_USER
+    SORT_BY_USER,
+    SORT_BY_IO_READ,   // Disk read bytes/s
+    SORT_BY_IO_WRITE,  // Disk write bytes/s
+    SORT_BY_SCHED_WAIT,   // Run-queue wait per second
+    SORT_BY_CTX_SWITCHES, // Voluntary + involuntary context switches/s
+    SORT_BY_FAULTS        // Major faults/s, then minor faults/s
 } SortMode;
 
 
@@ -47,21 +53,82 @@ typedef struct {
     unsigned long vsize; // Virtual memory size
     unsigned long rss; // Resident Set Size
     time_t starttime;
+    unsigned long long start_ticks;  // Start time in clock ticks (identifies a PID's lifetime)
     float cpu_usage;
     float mem_usage;
     unsigned long utime;  // CPU time in user mode (for tracking)
     unsigned long stime;  // CPU time in kernel mode (for tracking)
     int tree_depth;  // Depth in process tree (0 = root)
+    int tree_folded; // Tree view: processes folded into this row (0 = expanded)
+    bool is_thread;  // Row is a thread of an expanded process (pid holds the TID)
+    bool is_kernel_thread;  // Kernel thread (PF_KTHREAD): no status/cmdline to read
+    bool is_new;     // Started since the previous snapshot (see churn.h)
+    // Delay accounting filled by the taskstats data source (0 when unavailable)
+    unsigned long long cpu_delay_ns;   // Time spent waiting for a CPU
+    unsigned long long blkio_delay_ns; // Time spent waiting for block I/O
+    // I/O counters from /proc/[pid]/io and rates between refreshes
+    unsigned long long read_bytes;     // Bytes read from storage
+    unsigned long long write_bytes;    // Bytes written to storage
+    unsigned long long rchar;          // Bytes passed to read() and friends
+    unsigned long long wchar;          // Bytes passed to write() and friends
+    float read_rate;                   // read_bytes per second
+    float write_rate;                  // write_bytes per second
+    float rchar_rate;                  // rchar per second
+    float wchar_rate;                  // wchar per second
+    // Proportional/unique memory from /proc/[pid]/smaps_rollup (visible rows only)
+    bool has_smaps;                    // pss/uss/swap below are valid
+    unsigned long pss;                 // Proportional Set Size (bytes)
+    unsigned long uss;                 // Unique Set Size: private pages (bytes)
+    unsigned long swap;                // Swapped-out memory (bytes)
+    // Socket fds joined against /proc/net (visible rows only, see sockets.h)
+    bool has_sockets;                  // Counts below are valid
+    int sockets;                       // Socket fds of any family
+    int tcp_sockets;                   // TCP sockets (IPv4 and IPv6)
+    int tcp_established;               // ... in ESTABLISHED state
+    int tcp_listen;                    // ... in LISTEN state
+    // Scheduler and fault counters: faults from stat, the others only with SCAN_READ_SCHED
+    unsigned long minflt;              // Minor page faults (no disk access)
+    unsigned long majflt;              // Major page faults (page read from disk)
+    bool has_sched;                    // Counters and rates below were read
+    unsigned long long sched_wait_ns;  // Time spent waiting on a run queue (schedstat)
+    unsigned long long nvcsw;          // Voluntary context switches (status)
+    unsigned long long nivcsw;         // Involuntary context switches (status)
+    float wait_rate;                   // Run-queue wait in ms per second
+    float csw_rate;                    // nvcsw per second
+    float icsw_rate;                   // nivcsw per second
+    float minflt_rate;                 // minflt per second
+    float majflt_rate;                 // majflt per second
 } ProcessInfo; // Process information structure
 
+typedef struct {
+    pid_t pid;
+    char name[MAX_NAME_LEN];
+    char user[MAX_NAME_LEN];
+    float cpu_usage;     // Last known CPU usage
+    unsigned long rss;   // Last known Resident Set Size
+    float lifetime;      // Seconds between start and exit
+    time_t exited_at;    // Wall-clock time the exit was noticed
+} ExitedProcess; // Recently exited process record
+
 typedef struct {
     unsigned long total_mem;
     unsigned long free_mem;
-    unsigned long used_mem;
+    unsigned long used_mem;      // total_mem - available_mem
+    unsigned long available_mem; // MemAvailable (estimate without swapping)
+    unsigned long cached_mem;    // Buffers + Cached + SReclaimable
+    unsigned long shared_mem;    // Shmem (tmpfs, shared anonymous memory)
+    unsigned long swap_total;
+    unsigned long swap_used;
     float mem_usage_percent;
     float cpu_usage_percent;
     unsigned int total_processes;
     unsigned long uptime; // System uptime in seconds
+    bool disk_valid;         // Disk throughput below was sampled
+    float disk_read_rate;    // System-wide disk reads (bytes/s)
+    float disk_write_rate;   // System-wide disk writes (bytes/s)
+    bool churn_valid;        // Process start/exit rates below were measured
+    float start_rate;        // Processes started per second
+    float exit_rate;         // Processes exited per second
 }sysinfo_t; // System information structure
 
 
@@ -8,6 +8,26 @@
 #define DEFAULT_VISIBLE_PROCESSES 20
 #define DEFAULT_SORT_BY 'M'  // Memory
 #define DEFAULT_SHOW_TREE false
+#define DEFAULT_CPU_BUDGET 0.0f         // Self CPU budget in percent (0 = off)
+#define DEFAULT_MIN_REFRESH_INTERVAL 1
+#define DEFAULT_MAX_REFRESH_INTERVAL 10
+#define DEFAULT_PROC_EVENTS false
+#define DEFAULT_EVENT_RESCAN_INTERVAL 30
+#define DEFAULT_DATA_SOURCE "auto"
+#define DEFAULT_SHOW_IO_COLUMNS false
+#define DEFAULT_SHOW_PSS_COLUMNS false
+#define DEFAULT_HIDE_KERNEL_THREADS false
+#define DEFAULT_SHOW_SOCKET_COLUMNS false
+#define DEFAULT_SHOW_SCHED_COLUMNS false
+#define DEFAULT_WATCH_INTERVAL_MS 20     // Watch mode sampling period (10-100 ms)
+#define DEFAULT_SHM_SNAPSHOT false
+#define DEFAULT_HISTORY false
+#define DEFAULT_HISTORY_MAX_MB 64        // Disk space of the history tiers together
+#define DEFAULT_EXPORTER_PORT 0          // 0 = no Prometheus exporter
+#define DEFAULT_EXPORTER_TOP 20
+#define DEFAULT_ALERT_BUDGET_MS 5        // Rule evaluation time per refresh
+#define MAX_ALERT_RULES 256
+#define ALERT_RULE_LEN 256
 
 // Color theme types
 typedef enum {
@@ -25,6 +45,29 @@ typedef struct {
     char default_sort;          // Default sort key (P/C/M/U)
     bool show_tree_view;        // Enable process tree
     ColorTheme theme;           // Color theme
+    float cpu_budget;           // Self CPU budget in percent (0 = fixed refresh)
+    int min_refresh_interval;   // Adaptive refresh lower bound in seconds
+    int max_refresh_interval;   // Adaptive refresh upper bound in seconds
+    bool proc_events;           // Track process fork/exec/exit via the proc connector
+    int event_rescan_interval;  // Full /proc rescan period in event mode (seconds)
+    char data_source[16];       // Scanner backend: auto, procfs, taskstats or io_uring
+    bool show_io_columns;       // Per-process I/O rates and system disk throughput
+    bool show_pss_columns;      // PSS/USS/swap from smaps_rollup (visible rows only)
+    bool hide_kernel_threads;   // Drop kernel threads; known ones are not even re-read
+    bool show_socket_columns;   // Socket and TCP connection counts (visible rows only)
+    bool show_sched_columns;    // Run-queue wait, context switch and fault rates
+    int watch_interval_ms;      // Sampling period of the watched process (ms)
+    bool shm_snapshot;          // Publish each scan to shared memory (alttasker_shm.h)
+    bool history;               // Record refreshes into the on-disk history (history.h)
+    char history_dir[256];      // Directory of the history files (empty = ~/.alttasker-history)
+    int history_max_mb;         // Disk space of the history, all resolutions (MiB)
+    int exporter_port;          // --daemon serves Prometheus /metrics on 127.0.0.1:port (0 = off)
+    int exporter_top;           // Per-process series for the top N by CPU and by RSS
+    char alert_rules[MAX_ALERT_RULES][ALERT_RULE_LEN];  // "alert=" lines, see alerts.h
+    int alert_rule_count;
+    char alert_hook[ALERT_RULE_LEN];    // Shell command run on each alert state change
+    char alert_log[ALERT_RULE_LEN];     // File alert state changes are appended to
+    int alert_budget_ms;        // Rule evaluation time per refresh (0 = unlimited)
     
     // Custom colors (if THEME_CUSTOM)
     struct {
@@ -0,0 +1,64 @@
+#ifndef CPU_STATS_H
+#define CPU_STATS_H
+
+#include "common.h"
+
+// Highest CPU number tracked (cores above it are ignored)
+#define MAX_CPUS 1024
+
+/**
+ * @brief Share of one interval spent in each state, in percent.
+ */
+typedef struct {
+    float user;         // user + nice
+    float system;       // system + irq + softirq
+    float iowait;
+    float steal;        // Time taken by the hypervisor
+} CpuShare;
+
+/**
+ * @brief One /proc/pressure line: "some" or "full" averages, in percent.
+ */
+typedef struct {
+    float avg10;
+    float avg60;
+    float avg300;
+} PressureAverages;
+
+typedef struct {
+    bool valid;                     // Shares below cover a full interval
+    int cpu_count;                  // Highest online CPU number + 1
+    CpuShare total;                 // Whole machine
+    CpuShare cores[MAX_CPUS];       // Per CPU number (zero if offline)
+    bool online[MAX_CPUS];
+    float load[3];                  // 1, 5 and 15 minute load averages
+    bool has_pressure;              // /proc/pressure exists (CONFIG_PSI, psi=1)
+    PressureAverages cpu_some;
+    PressureAverages memory_some;
+    PressureAverages memory_full;
+    PressureAverages io_some;
+    PressureAverages io_full;
+} CpuStats;
+
+/**
+ * @brief Samples /proc/stat, /proc/loadavg and /proc/pressure/{cpu,memory,io}.
+ *
+ * The files are opened once and re-read with a single pread() each per call.
+ * CPU shares are deltas against the previous call, so the first call only
+ * fills load and pressure (valid is false).
+ *
+ * @param stats Destination.
+ */
+void cpu_stats_sample(CpuStats *stats);
+
+/**
+ * @brief Returns the busy percentage (everything but idle) of a share.
+ */
+float cpu_share_busy(const CpuShare *share);
+
+/**
+ * @brief Closes the files kept open by cpu_stats_sample().
+ */
+void cpu_stats_close(void);
+
+#endif // CPU_STATS_H
@@ -0,0 +1,64 @@
+#ifndef CURSOR_H
+#define CURSOR_H
+
+#include "common.h"
+
+// Slots of the PID -> row index (power of two, above 2 * displayed rows)
+#define CURSOR_TABLE_SIZE 4096
+
+/**
+ * @brief Selected row, bound to a process rather than to a position.
+ *
+ * The identity is (pid, start_ticks, is_thread), so the cursor follows its
+ * process through re-sorts, never jumps to a process that reused the PID,
+ * and tells a process row from the row of its main thread (same TID).
+ */
+typedef struct {
+    pid_t pid;                      // Selected process (0 = none yet)
+    unsigned long long start_ticks; // Start time of the selected process
+    int row;                        // Row of the selection in the last located list
+    bool is_thread;                 // Selection is a thread row (pid holds the TID)
+} Cursor;
+
+/**
+ * @brief Finds the selected process in a new list of display rows.
+ *
+ * Indexes the rows by PID in one pass, then looks the selection up in O(1).
+ * If the process is gone (or was filtered out), the cursor stays at the
+ * same row, clamped to the list, and selects whatever is now there.
+ *
+ * @param cursor The cursor.
+ * @param rows Display rows in screen order.
+ * @param count Number of rows.
+ * @return int The selected row, or -1 if the list is empty.
+ */
+int cursor_locate(Cursor *cursor, const ProcessInfo rows[], int count);
+
+/**
+ * @brief Moves the selection by 'delta' rows (clamped) and rebinds it.
+ *
+ * @param cursor The cursor, located in 'rows'.
+ * @param rows Display rows, as passed to the last cursor_locate().
+ * @param count Number of rows.
+ * @param delta Rows to move; INT_MIN/INT_MAX jump to the first/last row.
+ */
+void cursor_move(Cursor *cursor, const ProcessInfo rows[], int count, int delta);
+
+/**
+ * @brief Adjusts a scroll offset so the selected row stays on screen.
+ *
+ * @param cursor The located cursor.
+ * @param scroll_offset Scroll offset to adjust.
+ * @param visible Rows that fit on screen.
+ * @param count Number of rows.
+ */
+void cursor_follow(const Cursor *cursor, int *scroll_offset, int visible, int count);
+
+/**
+ * @brief Returns the process row of a PID in the last located list (-1 if absent).
+ *
+ * Thread rows of expanded processes are not returned.
+ */
+int cursor_find(pid_t pid);
+
+#endif // CURSOR_H
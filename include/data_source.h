@@ -0,0 +1,96 @@
+#ifndef DATA_SOURCE_H
+#define DATA_SOURCE_H
+
+#include "common.h"
+
+/**
+ * @brief A backend the scanner uses to read per-process information.
+ *
+ * The /proc text reader (get_process_info()) is the default backend and is
+ * always available. Other backends may need privileges or kernel features,
+ * which open() probes for.
+ */
+typedef struct {
+    const char *name;
+
+    /**
+     * @brief Prepares the backend.
+     * @return int 0 if the backend is usable on this system, -1 otherwise.
+     */
+    int (*open)(void);
+
+    /**
+     * @brief Reads one process. Same contract as get_process_info().
+     */
+    int (*read)(pid_t pid, ProcessInfo *pinfo, unsigned long total_mem, unsigned int flags);
+
+    /**
+     * @brief Reads many processes at once (optional, NULL = read() per PID).
+     * @return int Number of rows written to 'processes'; vanished PIDs are skipped.
+     */
+    int (*read_batch)(const pid_t pids[], int count, ProcessInfo processes[],
+                      unsigned long total_mem, unsigned int flags);
+
+    /**
+     * @brief Releases backend resources.
+     */
+    void (*close)(void);
+} DataSource;
+
+/**
+ * @brief The /proc text file backend (stat, status, cmdline).
+ */
+extern const DataSource procfs_source;
+
+/**
+ * @brief The taskstats generic-netlink backend.
+ *
+ * Adds the delay accounting (CPU and block I/O wait) and context switches of
+ * the whole thread group, read in binary form. The kernel leaves uid, CPU
+ * time and I/O bytes of a TGID reply at 0, so everything else is read from
+ * /proc like procfs: it costs one netlink round trip more per process.
+ * Requires CAP_NET_ADMIN.
+ */
+extern const DataSource taskstats_source;
+
+/**
+ * @brief The io_uring backend.
+ *
+ * Reads the /proc files of up to 128 processes per round with two io_uring
+ * submissions (all opens, then all reads into preallocated buffers) instead
+ * of several blocking syscalls per file. Needs Linux 5.6+ with io_uring
+ * enabled; the text is parsed exactly like the procfs backend.
+ */
+extern const DataSource uring_source;
+
+/**
+ * @brief Returns all compiled-in backends, procfs first.
+ *
+ * @param count Pointer to store the number of backends.
+ * @return const DataSource* const* Array of backends.
+ */
+const DataSource* const* data_source_list(int *count);
+
+/**
+ * @brief Selects the backend used by scan_processes().
+ *
+ * "auto" opens every backend, times a sample of processes with each and
+ * keeps the fastest one. Any other value names a backend; if it is unknown
+ * or unavailable the procfs backend is used.
+ *
+ * @param name Backend name or "auto".
+ * @return const DataSource* The selected backend.
+ */
+const DataSource* data_source_select(const char *name);
+
+/**
+ * @brief Returns the backend currently used by scan_processes().
+ */
+const DataSource* data_source_current(void);
+
+/**
+ * @brief Closes the selected backend and reverts to procfs.
+ */
+void data_source_shutdown(void);
+
+#endif // DATA_SOURCE_H
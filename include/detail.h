@@ -0,0 +1,88 @@
+#ifndef DETAIL_H
+#define DETAIL_H
+
+#include "common.h"
+
+// Seconds between two reads of the same process in the detail pane
+#define DETAIL_REFRESH_SECONDS 5
+#define DETAIL_PATH_LEN 256
+
+// Sections of the pane, read in this order (cheap first)
+#define DETAIL_PATHS   0x01u    // cwd and exe links
+#define DETAIL_CGROUP  0x02u
+#define DETAIL_ENVIRON 0x04u
+#define DETAIL_LIMITS  0x08u
+#define DETAIL_FDS     0x10u
+#define DETAIL_MAPS    0x20u
+#define DETAIL_SMAPS   0x40u
+#define DETAIL_ALL     0x7Fu
+
+// Limit value meaning "unlimited"
+#define DETAIL_UNLIMITED (~0ULL)
+
+/**
+ * @brief Details of one process, filled in section by section.
+ *
+ * A section is valid once its bit is set in 'ready'; its bit in 'denied'
+ * means the file could not be read (permission or kernel thread).
+ */
+typedef struct {
+    pid_t pid;                          // 0 = nothing selected
+    unsigned long long start_ticks;
+    unsigned int ready;                 // DETAIL_* sections read
+    unsigned int denied;                // DETAIL_* sections that failed
+    bool loading;                       // A read of this process is in progress
+    time_t updated;                     // Wall-clock time the last full read finished
+    char cwd[DETAIL_PATH_LEN];
+    char exe[DETAIL_PATH_LEN];
+    char cgroup[DETAIL_PATH_LEN];       // cgroup v2 path ("0::" line)
+    int env_vars;                       // Variables in /proc/[pid]/environ
+    size_t env_bytes;
+    unsigned long long nofile_soft;     // "Max open files"
+    unsigned long long nofile_hard;
+    unsigned long long as_soft;         // "Max address space" (bytes)
+    unsigned long long nproc_soft;      // "Max processes"
+    int fd_count;                       // Entries of /proc/[pid]/fd
+    int map_count;                      // Lines of /proc/[pid]/maps
+    int file_maps;                      // Mappings backed by a file
+    unsigned long file_bytes;           // Size of file-backed mappings
+    unsigned long anon_bytes;           // Size of anonymous mappings (heap, stack included)
+    unsigned long rss;                  // smaps_rollup Rss
+    unsigned long pss;                  // smaps_rollup Pss
+    unsigned long uss;                  // Private_Clean + Private_Dirty
+    unsigned long swap;                 // smaps_rollup Swap
+} ProcessDetail;
+
+/**
+ * @brief Starts the detail reader thread.
+ *
+ * @return int 0 on success, -1 if the thread could not be started.
+ */
+int detail_open(void);
+
+/**
+ * @brief Selects the process shown in the pane.
+ *
+ * Cheap to call every frame: the reader is only woken when the selection
+ * changes. Reads of a previous selection are abandoned between sections
+ * and every few thousand fds or mappings.
+ *
+ * @param pid The selected process (0 to stop reading).
+ * @param start_ticks Its start time, which must still match when read.
+ */
+void detail_select(pid_t pid, unsigned long long start_ticks);
+
+/**
+ * @brief Copies the current details.
+ *
+ * @param detail Destination.
+ * @return bool True if the details changed since the previous call.
+ */
+bool detail_get(ProcessDetail *detail);
+
+/**
+ * @brief Stops and joins the reader thread.
+ */
+void detail_close(void);
+
+#endif // DETAIL_H
@@ -2,6 +2,12 @@
 #define DISPLAY_H
 
 #include "common.h"
+#include "group.h"
+#include "cpu_stats.h"
+#include "alerts.h"
+#include "detail.h"
+#include "watch.h"
+#include <stdbool.h>
 
 /**
  * @brief Displays system information in a formatted manner.
@@ -9,14 +15,26 @@
  * @param sysinfo Pointer to a sysinfo_t structure containing system information.
  */
 void display_system_info(const sysinfo_t* sysinfo);
+
+/**
+ * @brief Displays the CPU meters, load averages and pressure (PSI) line.
+ * 
+ * Up to 32 CPUs are drawn as bar meters, four per line; larger machines get
+ * a heatmap with one cell per CPU so the header stays a few lines tall.
+ * 
+ * @param stats Latest sample from cpu_stats_sample().
+ */
+void display_cpu_meters(const CpuStats *stats);
 /**
  * @brief Displays the list of processes in a formatted table with scrolling.
  * 
  * @param processes Array of ProcessInfo structures containing process information.
  * @param count Number of processes in the array.
  * @param scroll_offset Current scroll position (0-based index).
+ * @param selected_row Row drawn highlighted as the selection (-1 for none).
  */
-void display_processes(const ProcessInfo processes[], int count, int scroll_offset, int visible_processes);
+void display_processes(const ProcessInfo processes[], int count, int scroll_offset, int visible_processes,
+                       int selected_row);
 
 
 /**
@@ -28,6 +46,15 @@ void display_processes(const ProcessInfo processes[], int count, int scroll_offs
  */
 void format_memory(unsigned long size, char* buffer, size_t buffer_size);
 
+/**
+ * @brief Formats a byte rate into a compact string for narrow columns (e.g., "12.3K").
+ * 
+ * @param bytes_per_sec Rate in bytes per second.
+ * @param buffer Pointer to a buffer where the formatted string will be stored.
+ * @param buffer_size Size of the buffer (at least 8 bytes).
+ */
+void format_rate(float bytes_per_sec, char* buffer, size_t buffer_size);
+
 /**
  * @brief Applies color coding to a load value (CPU/Memory) based on its percentage.
  * 
@@ -63,10 +90,123 @@ const char* get_state_color(char state);
  * @brief Displays the command menu at the bottom of the screen.
  * 
  * @param current_sort Current sorting mode being used.
- * @param filter_user Current user filter (NULL if no filter).
+ * @param filter_text Active filter expression (NULL if no filter).
  * @param scroll_offset Current scroll position for navigation info.
  * @param total_processes Total number of processes for scroll indicators.
  */
-void display_command_menu(SortMode current_sort, const char* filter_user, int scroll_offset, int total_processes);
+void display_command_menu(SortMode current_sort, const char* filter_text, int scroll_offset, int total_processes);
+
+/**
+ * @brief Displays aggregated groups instead of individual processes.
+ * 
+ * One row per group shows the number of processes, summed CPU%, MEM%, RES
+ * (and disk rates when the I/O columns are on) and the most significant
+ * state. The members of the expanded group are listed below its row.
+ * 
+ * @param groups Groups in display order.
+ * @param group_count Number of groups.
+ * @param mode Grouping mode (for the column label).
+ * @param expanded_id Id of the expanded group (-1 for none).
+ * @param members Processes of the expanded group.
+ * @param member_count Number of members.
+ * @param scroll_offset First visible row (groups and members both count).
+ * @param visible_rows Number of rows to show.
+ */
+void display_groups(const ProcessGroup groups[], int group_count, GroupMode mode,
+                    int expanded_id, const ProcessInfo members[], int member_count,
+                    int scroll_offset, int visible_rows);
+
+/**
+ * @brief Displays the detail pane of the selected process.
+ *
+ * Sections not read yet show "…", sections that could not be read "-".
+ *
+ * @param detail Details from detail_get().
+ * @param name Process name of the selected row.
+ */
+void display_detail(const ProcessDetail *detail, const char *name);
+
+/**
+ * @brief Displays the watch pane: time series of one process, newest on the right.
+ *
+ * CPU, RSS and faults are drawn as sparklines (major faults in red), the
+ * state as one letter per sample, and with threads the busiest ones below.
+ *
+ * @param view Series from watch_get().
+ */
+void display_watch(const WatchView *view);
+
+/**
+ * @brief Returns the number of lines display_watch() prints for 'view'.
+ *
+ * Lets a new sample be drawn over the previous pane in place when its
+ * height is unchanged.
+ *
+ * @param view Series from watch_get().
+ * @return int Lines of the pane (0 when not watching).
+ */
+int display_watch_height(const WatchView *view);
+
+/**
+ * @brief Displays the "recently exited" list (short-lived processes included).
+ * 
+ * @param exits Recently exited processes, newest first.
+ * @param count Number of entries.
+ */
+void display_recent_exits(const ExitedProcess exits[], int count);
+
+/**
+ * @brief Displays the live search line below the process table.
+ * 
+ * @param query Current search text.
+ * @param mode_name Label of the search mode (e.g. "ignore case").
+ * @param matches Number of matching processes.
+ * @param editing true while keys are typed into the query.
+ * @param invalid true if the query is a regex that does not compile.
+ */
+void display_search_bar(const char *query, const char *mode_name, int matches,
+                        bool editing, bool invalid);
+
+/**
+ * @brief Displays the refresh status line below the command menu.
+ * 
+ * @param interval_ms Effective refresh interval in milliseconds.
+ * @param self_cpu_percent AltTasker's own CPU usage over the last refresh cycle.
+ * @param adaptive True if the CPU budget scheduler is enabled.
+ * @param degraded True if the last refresh reused cached cmdline/user values.
+ */
+void display_refresh_status(int interval_ms, float self_cpu_percent, bool adaptive, bool degraded);
+
+/**
+ * @brief Displays which daemon a --connect client is attached to.
+ * 
+ * @param path Socket path of the daemon.
+ * @param connected False while the daemon is unreachable (the last data stays on screen).
+ */
+void display_remote_status(const char *path, bool connected);
+
+/**
+ * @brief Displays which recorded frame a --history-range view shows.
+ * 
+ * Shown in place of the CPU meters, which are not recorded.
+ * 
+ * @param when Time of the frame.
+ * @param tier Resolution tier the window was read from (0 = 1s, 1 = 1m, 2 = 1h).
+ * @param index Frame of the window on screen (0 = oldest).
+ * @param count Frames in the window.
+ * @param cpu_percent Recorded system CPU usage (average over the frame).
+ */
+void display_history_status(time_t when, int tier, int index, int count, float cpu_percent);
+
+/**
+ * @brief Displays the alert summary and the firing alerts (up to five).
+ * 
+ * Nothing is drawn when no rules are configured.
+ * 
+ * @param events Firing alerts from alerts_firing().
+ * @param count Number of firing alerts.
+ * @param stats Rule count and cost of the last evaluation.
+ */
+void display_alerts(const AlertEvent events[], int count, const AlertStats *stats);
 
 #endif // DISPLAY_H
\ No newline at end of file
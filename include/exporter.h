@@ -0,0 +1,68 @@
+#ifndef EXPORTER_H
+#define EXPORTER_H
+
+#include "common.h"
+#include <poll.h>
+
+// Upper bound for exporter_top (series per metric = top processes)
+#define EXPORTER_MAX_TOP 100
+// Longest label value; longer names are cut
+#define EXPORTER_MAX_LABEL 64
+// Scrape connections served at once; later ones wait in the listen backlog
+#define EXPORTER_MAX_CONNECTIONS 16
+
+/**
+ * @brief Starts listening for Prometheus scrapes on 127.0.0.1:port.
+ *
+ * @param port TCP port.
+ * @return int Listening socket, or -1 on failure.
+ */
+int exporter_open(int port);
+
+/**
+ * @brief Renders the /metrics response for one scan.
+ *
+ * The whole HTTP response (headers included) is kept in one buffer that is
+ * reused across scans, so a scrape is a single send() of the last render and
+ * never reads /proc. Per-process series are limited to the top_n processes
+ * by CPU and the top_n by RSS, labelled with pid, comm name and user only.
+ *
+ * @param processes Scanned processes.
+ * @param count Number of processes.
+ * @param sysinfo System totals of the same scan.
+ * @param top_n Processes exported per ranking (clamped to EXPORTER_MAX_TOP).
+ */
+void exporter_render(const ProcessInfo processes[], int count, const sysinfo_t *sysinfo, int top_n);
+
+/**
+ * @brief Fills the poll entries of the exporter.
+ *
+ * fds[0] is the listening socket, followed by one entry per open scrape
+ * connection. Connections silent or stuck for a second are closed here.
+ *
+ * @param listen_fd Socket from exporter_open().
+ * @param fds Destination, room for EXPORTER_MAX_CONNECTIONS + 1 entries.
+ * @return int Number of entries filled.
+ */
+int exporter_poll_fds(int listen_fd, struct pollfd fds[]);
+
+/**
+ * @brief Accepts new connections and advances the open ones.
+ *
+ * Never blocks: requests are read as they arrive and an answer that doesn't
+ * fit the socket buffer is sent as it drains. GET /metrics returns the last
+ * render, any other path 404. Call after poll() on the entries from
+ * exporter_poll_fds().
+ *
+ * @param listen_fd Socket from exporter_open().
+ * @param fds Entries from exporter_poll_fds(), with revents set.
+ * @param count Number of entries.
+ */
+void exporter_serve(int listen_fd, const struct pollfd fds[], int count);
+
+/**
+ * @brief Closes the listening socket and open connections, frees the response buffer.
+ */
+void exporter_close(int listen_fd);
+
+#endif // EXPORTER_H
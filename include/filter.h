@@ -0,0 +1,116 @@
+#ifndef FILTER_H
+#define FILTER_H
+
+#include "common.h"
+
+#define MAX_FILTER_TERMS 16
+#define MAX_FILTER_LEN 256
+
+// Process attribute a filter term tests
+typedef enum {
+    FILTER_PID,
+    FILTER_PPID,
+    FILTER_UID,
+    FILTER_CPU,      // cpu_usage (%)
+    FILTER_MEM,      // mem_usage (%)
+    FILTER_RSS,      // bytes
+    FILTER_VIRT,     // bytes
+    FILTER_READ,     // disk read bytes/s
+    FILTER_WRITE,    // disk write bytes/s
+    FILTER_WAIT,     // run-queue wait, ms per second
+    FILTER_CSW,      // voluntary context switches/s
+    FILTER_ICSW,     // involuntary context switches/s
+    FILTER_MINF,     // minor faults/s
+    FILTER_MAJF,     // major faults/s
+    FILTER_STATE,
+    FILTER_USER,
+    FILTER_NAME,
+    FILTER_CMD
+} FilterField;
+
+typedef enum {
+    FILTER_OP_EQ,        // =
+    FILTER_OP_NE,        // !=
+    FILTER_OP_LT,        // <
+    FILTER_OP_LE,        // <=
+    FILTER_OP_GT,        // >
+    FILTER_OP_GE,        // >=
+    FILTER_OP_CONTAINS   // ~ (case-insensitive substring)
+} FilterOp;
+
+/**
+ * @brief One compiled comparison, e.g. "rss>500M".
+ *
+ * Values are converted once at compile time: numbers are parsed with their
+ * K/M/G suffix and text for '~' is lower-cased. States match exactly.
+ */
+typedef struct {
+    FilterField field;
+    FilterOp op;
+    int cost;                   // Relative evaluation cost (terms run cheapest first)
+    double number;              // Numeric fields
+    char state;                 // FILTER_STATE
+    char text[MAX_NAME_LEN];    // Text fields
+    size_t text_len;
+} FilterTerm;
+
+/**
+ * @brief A compiled filter expression: all terms must match.
+ */
+typedef struct {
+    int count;                  // 0 = matches everything
+    FilterTerm terms[MAX_FILTER_TERMS];
+    char source[MAX_FILTER_LEN];  // Expression as typed, for display
+} ProcessFilter;
+
+/**
+ * @brief Compiles a filter expression.
+ *
+ * The expression is a whitespace-separated list of terms that must all match,
+ * each of the form FIELD OP VALUE. Fields: pid, ppid, uid, cpu, mem, rss,
+ * virt, read, write, wait, csw, icsw, minf, majf, state, user, name, cmd. Operators: = != < <= > >= and
+ * ~ (case-insensitive substring, text fields only). Sizes accept K/M/G
+ * suffixes, e.g. "user=postgres cpu>20 state=D rss>500M name~java".
+ *
+ * @param expr The expression (NULL or empty compiles to match-all).
+ * @param filter Destination for the compiled filter.
+ * @param error Buffer for a message describing the first error (may be NULL).
+ * @param error_size Size of the error buffer.
+ * @return int 0 on success, -1 on a syntax error (filter is left empty).
+ */
+int filter_compile(const char *expr, ProcessFilter *filter, char *error, size_t error_size);
+
+/**
+ * @brief Returns the scan flags the fields of a filter need.
+ *
+ * read/write are only measured with SCAN_READ_IO and the scheduler and
+ * fault rates only with SCAN_READ_SCHED (see process_monitor.h), whether
+ * or not their columns are shown.
+ *
+ * @param filter The compiled filter (NULL needs nothing).
+ * @return unsigned int SCAN_READ_IO and/or SCAN_READ_SCHED, or 0.
+ */
+unsigned int filter_scan_flags(const ProcessFilter *filter);
+
+/**
+ * @brief Tests one process against a compiled filter.
+ *
+ * @param filter The compiled filter.
+ * @param process The process to test.
+ * @return bool true if every term matches.
+ */
+bool filter_match(const ProcessFilter *filter, const ProcessInfo *process);
+
+/**
+ * @brief Copies the processes matching a compiled filter.
+ *
+ * @param filter The compiled filter.
+ * @param processes Source array of all processes.
+ * @param count Number of processes in source array.
+ * @param filtered Destination array for matching processes.
+ * @return int Number of matching processes.
+ */
+int filter_apply(const ProcessFilter *filter, const ProcessInfo processes[], int count,
+                 ProcessInfo filtered[]);
+
+#endif // FILTER_H
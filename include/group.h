@@ -0,0 +1,77 @@
+#ifndef GROUP_H
+#define GROUP_H
+
+#include "common.h"
+
+// Slots of the aggregation hash table (power of two, above 2 * MAX_PROCESS)
+#define GROUP_TABLE_SIZE 2048
+
+typedef enum {
+    GROUP_NONE,         // Flat process list
+    GROUP_BY_USER,
+    GROUP_BY_COMMAND,   // Executable name (comm)
+    GROUP_BY_PARENT,    // Subtree below init / kthreadd
+    GROUP_BY_CGROUP     // cgroup v2 tree (see cgroup.h)
+} GroupMode;
+
+/**
+ * @brief Aggregated values of one group of processes.
+ */
+typedef struct {
+    int id;                     // Group index before sorting (see group_of)
+    char key[MAX_NAME_LEN];     // User, command name or "name (pid)" of the subtree root
+    pid_t root_pid;             // GROUP_BY_PARENT: subtree root
+    int count;                  // Number of processes
+    float cpu_usage;            // Sum of CPU%
+    float mem_usage;            // Sum of MEM%
+    unsigned long rss;          // Sum of RSS (bytes)
+    float read_rate;            // Sum of disk reads (bytes/s)
+    float write_rate;           // Sum of disk writes (bytes/s)
+    char state;                 // Most significant state (D > R > Z > T > S > I)
+    int depth;                  // GROUP_BY_CGROUP: nesting level in the tree
+    bool has_pressure;          // GROUP_BY_CGROUP: memory_pressure is valid
+    float memory_pressure;      // GROUP_BY_CGROUP: memory.pressure "some avg10" (%)
+} ProcessGroup;
+
+/**
+ * @brief Aggregates processes into groups in one hash-aggregation pass.
+ *
+ * @param processes Processes to aggregate.
+ * @param count Number of processes.
+ * @param mode GROUP_BY_USER, GROUP_BY_COMMAND or GROUP_BY_PARENT.
+ * @param groups Destination array, indexed by group id.
+ * @param max_groups Capacity of the destination array.
+ * @param group_of Optional array receiving the group id of each process
+ *                 (-1 if the process did not fit), may be NULL.
+ * @return int Number of groups.
+ */
+int group_processes(const ProcessInfo processes[], int count, GroupMode mode,
+                    ProcessGroup groups[], int max_groups, int group_of[]);
+
+/**
+ * @brief Sorts groups by an aggregate.
+ *
+ * P sorts by process count, C by CPU, M by memory, U by key and the I/O
+ * modes by summed disk rates; all but U are descending.
+ *
+ * @param groups Groups to sort.
+ * @param count Number of groups.
+ * @param mode Sorting mode.
+ */
+void sort_groups(ProcessGroup groups[], int count, SortMode mode);
+
+/**
+ * @brief Returns the more significant of two process states.
+ *
+ * @param a First state letter (0 for none).
+ * @param b Second state letter.
+ * @return char The state with the higher rank (D > R > Z > T > S > I).
+ */
+char group_max_state(char a, char b);
+
+/**
+ * @brief Returns a short label for a grouping mode (e.g. "user").
+ */
+const char* group_mode_name(GroupMode mode);
+
+#endif // GROUP_H
@@ -0,0 +1,176 @@
+#ifndef HISTORY_H
+#define HISTORY_H
+
+#include "common.h"
+#include <stdatomic.h>
+#include <stdint.h>
+
+/*
+ * On-disk history (history=true): one ring file per resolution in
+ * history_dir, each a fixed-size memory-mapped file so disk usage never
+ * grows past history_max_mb:
+ *
+ *     tier0.dat   one frame per refresh (at most one per second)
+ *     tier1.dat   one frame per minute, rolled up from tier0
+ *     tier2.dat   one frame per hour, rolled up from tier1
+ *
+ * A file is a header page, the frame times as one column (so a time range
+ * is found by binary search over a few pages) and the frames. A frame holds
+ * the system totals and the top HISTORY_ROWS processes as one array per
+ * field. Frames are only appended; the oldest is overwritten once the ring
+ * is full.
+ */
+
+#define HISTORY_MAGIC 0x54534948u     // "HIST"
+#define HISTORY_VERSION 1u
+#define HISTORY_TIERS 3
+#define HISTORY_ROWS 64               // Per frame: top half by CPU, the rest by RSS
+#define HISTORY_AGG_ROWS 1024         // Distinct processes one rollup bucket can hold
+#define HISTORY_NAME_LEN 16           // comm length, as in /proc/[pid]/stat
+
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t frame_size;            // sizeof(HistoryFrame) of the writer
+    uint32_t capacity;              // Frames in the ring
+    uint32_t resolution;            // Seconds per frame (1, 60, 3600)
+    uint32_t time_offset;           // File offset of the time column
+    uint64_t frame_offset;          // File offset of the first frame
+    _Atomic uint64_t written;       // Frames appended so far; the next goes to written % capacity
+} HistoryHeader;
+
+typedef struct {
+    int64_t time;                   // Wall-clock seconds (bucket start on rollup tiers)
+    uint32_t samples;               // Refreshes averaged into this frame
+    uint32_t count;                 // Rows valid in every column
+    // System totals (bytes, percent, seconds); memory is the peak of the frame
+    uint64_t total_mem;
+    uint64_t used_mem;
+    uint64_t available_mem;
+    uint64_t cached_mem;
+    uint64_t shared_mem;
+    uint64_t swap_total;
+    uint64_t swap_used;
+    uint64_t uptime;
+    float mem_usage_percent;
+    float cpu_usage_percent;        // Average of the frame
+    uint32_t total_processes;       // Peak of the frame
+    // One column per field, indexed by row
+    int32_t pid[HISTORY_ROWS];
+    int32_t ppid[HISTORY_ROWS];
+    uint32_t uid[HISTORY_ROWS];
+    float cpu_usage[HISTORY_ROWS];  // Average; 0 while outside the top rows
+    float mem_usage[HISTORY_ROWS];  // Peak
+    uint64_t rss[HISTORY_ROWS];     // Peak (bytes)
+    uint64_t vsize[HISTORY_ROWS];   // Peak (bytes)
+    uint64_t start_ticks[HISTORY_ROWS];
+    char state[HISTORY_ROWS];       // Last seen
+    char name[HISTORY_ROWS][HISTORY_NAME_LEN];
+} HistoryFrame;
+
+/**
+ * @brief A time window found by history_query(), read frame by frame.
+ */
+typedef struct {
+    int tier;                       // Finest tier that still covers the start
+    const HistoryHeader *header;    // Read-only mapping of the tier file
+    size_t map_size;
+    uint64_t written;               // Header 'written' when queried
+    uint64_t first;                 // Frame number (< written) of the first frame
+    int count;                      // Frames in the window
+} HistoryRange;
+
+/**
+ * @brief Writes the history directory into 'buffer'.
+ *
+ * history_dir from the configuration, or $HOME/.alttasker-history when it
+ * is empty (/tmp/alttasker-history-UID without $HOME).
+ *
+ * @param buffer Destination.
+ * @param size Size of the destination.
+ */
+void history_get_dir(char *buffer, size_t size);
+
+/**
+ * @brief Creates or reopens the tier files and starts recording.
+ *
+ * Existing files whose layout or size differ are recreated. Only one
+ * process records into a directory: the first tier is locked with flock().
+ *
+ * @param dir History directory (created if missing).
+ * @param max_mb Disk space of all tiers together (MiB).
+ * @return int 0 if this process records, -1 otherwise.
+ */
+int history_open(const char *dir, int max_mb);
+
+/**
+ * @brief Appends one refresh to the first tier and feeds the rollups.
+ *
+ * Refreshes less than a second after the previous one are skipped. A
+ * minute (hour) frame is written when the first sample of the next minute
+ * (hour) arrives. Does nothing unless history_open() succeeded.
+ *
+ * @param processes Scanned processes (not modified).
+ * @param count Number of processes.
+ * @param sysinfo System totals of the same refresh.
+ */
+void history_record(const ProcessInfo processes[], int count, const sysinfo_t *sysinfo);
+
+/**
+ * @brief Writes the partial rollups and unmaps the tier files.
+ */
+void history_close(void);
+
+/**
+ * @brief Parses "FROM[,TO]" into wall-clock times.
+ *
+ * Each end is "-30m"/"-8h"/"-2d" (relative to now), "HH:MM[:SS]" (the last
+ * such time before now) or "YYYY-MM-DD[ HH:MM[:SS]]". TO defaults to now.
+ *
+ * @param spec The range.
+ * @param from Destination for the start.
+ * @param to Destination for the end.
+ * @return int 0 on success, -1 if 'spec' is invalid or empty.
+ */
+int history_parse_range(const char *spec, time_t *from, time_t *to);
+
+/**
+ * @brief Finds the frames of [from, to] without reading the tier files.
+ *
+ * Picks the finest tier holding frames of the window that reaches back to
+ * 'from' or never overwrote a frame (else the coarsest one holding any),
+ * then binary-searches its time column.
+ *
+ * @param dir History directory.
+ * @param from Start of the window.
+ * @param to End of the window.
+ * @param range Destination; release with history_query_close().
+ * @return int Number of frames in the window (0 = none, -1 = no history).
+ */
+int history_query(const char *dir, time_t from, time_t to, HistoryRange *range);
+
+/**
+ * @brief Loads one frame of a window as process rows.
+ *
+ * Only the pages of that frame are touched. The rows are registered in the
+ * per-PID table, as after a scan.
+ *
+ * @param range The window.
+ * @param index Frame of the window (0 = oldest).
+ * @param processes Destination.
+ * @param max_processes Capacity of the destination.
+ * @param sysinfo Destination for the system totals of the frame.
+ * @param when Destination for the frame time.
+ * @return int Number of rows, or -1 if the frame was overwritten meanwhile.
+ */
+int history_load(const HistoryRange *range, int index, ProcessInfo processes[], int max_processes,
+                 sysinfo_t *sysinfo, time_t *when);
+
+/**
+ * @brief Unmaps a window.
+ *
+ * @param range The window.
+ */
+void history_query_close(HistoryRange *range);
+
+#endif // HISTORY_H
@@ -0,0 +1,56 @@
+#ifndef PROC_EVENTS_H
+#define PROC_EVENTS_H
+
+#include "common.h"
+#include <stdbool.h>
+
+// Number of entries kept in the "recently exited" list
+#define MAX_RECENT_EXITS 8
+
+/**
+ * @brief Subscribes to the kernel proc connector (NETLINK_CONNECTOR).
+ *
+ * Listening requires CAP_NET_ADMIN. When the socket can't be opened or the
+ * subscription is refused, AltTasker keeps polling /proc as before.
+ *
+ * @return int 0 if process events are being delivered, -1 otherwise.
+ */
+int proc_events_open(void);
+
+/**
+ * @brief Unsubscribes and closes the connector socket.
+ */
+void proc_events_close(void);
+
+/**
+ * @brief Returns true if the event-driven mode is active.
+ */
+bool proc_events_active(void);
+
+/**
+ * @brief Drains pending fork/exec/exit events and applies them to the table.
+ *
+ * New processes are read and appended, exec'd processes are re-read and
+ * exited processes are removed and recorded in the "recently exited" list.
+ * A process that exits before it could be read is listed too, with the
+ * name of its parent and the time since its fork event. Never blocks.
+ *
+ * @param processes Process table to update in place.
+ * @param count Pointer to the number of valid entries (updated).
+ * @param max_processes Capacity of the table.
+ * @param total_mem Total system memory in bytes.
+ * @return int Number of table changes, or -1 if events were lost and a
+ *         full rescan is needed.
+ */
+int proc_events_apply(ProcessInfo processes[], int *count, int max_processes,
+                      unsigned long total_mem);
+
+/**
+ * @brief Returns the recently exited processes, newest first.
+ *
+ * @param list Destination array with room for MAX_RECENT_EXITS entries.
+ * @return int Number of entries copied.
+ */
+int proc_events_recent_exits(ExitedProcess list[]);
+
+#endif // PROC_EVENTS_H
@@ -0,0 +1,141 @@
+#ifndef PROC_TABLE_H
+#define PROC_TABLE_H
+
+#include "common.h"
+#include <stdbool.h>
+
+// Number of slots in the per-PID table (power of two, well above MAX_PROCESS)
+#define PROC_TABLE_SIZE 4096
+
+/**
+ * @brief Per-PID state retained between refreshes.
+ *
+ * An entry is identified by (pid, start_ticks) so a recycled PID never
+ * inherits the cached attributes of the process that used it before.
+ */
+typedef struct {
+    pid_t pid;                          // 0 marks an empty slot
+    unsigned long long start_ticks;     // Start time since boot (clock ticks)
+    unsigned int seen;                  // Generation of the last scan that saw this PID
+    bool has_static;                    // uid/user/cmdline below are valid
+    uid_t uid;
+    char user[MAX_NAME_LEN];
+    char cmdline[MAX_CMDLINE_LEN];
+    char comm[64];                      // Name when cached; a change means exec()
+    double static_time;                 // Monotonic time uid/user/cmdline were read
+    bool is_kthread;                    // Kernel thread (PF_KTHREAD)
+    ino_t dir_ino;                      // Inode of /proc/[pid] when last read
+    // Previous I/O sample for per-second rates
+    bool has_io;
+    double io_time;                     // Monotonic time of the sample
+    unsigned long long read_bytes;
+    unsigned long long write_bytes;
+    unsigned long long rchar;
+    unsigned long long wchar;
+    int search_id;                      // Interned search string (0 = not indexed)
+    int cgroup_id;                      // cgroup v2 node + 1 (0 = not read yet, -1 = none)
+    unsigned int cgroup_serial;         // Serial of that node; stale once the node is freed (cgroup.c)
+    unsigned int tree_fold;             // Tree view: collapsed while equal to the fold epoch (tree.c)
+    // Last smaps_rollup sample (expensive, re-read every SMAPS_REFRESH_SECONDS)
+    bool has_smaps;
+    double smaps_time;                  // Monotonic time of the sample
+    unsigned long pss;
+    unsigned long uss;
+    unsigned long swap;
+    // Last socket count (re-read every SOCKETS_REFRESH_SECONDS)
+    bool has_sockets;
+    double sockets_time;                // Monotonic time of the count
+    int sockets;
+    int tcp_sockets;
+    int tcp_established;
+    int tcp_listen;
+    // Previous scheduler/fault sample for per-second rates
+    bool has_sched;
+    double sched_time;                  // Monotonic time of the sample
+    unsigned long long sched_wait_ns;
+    unsigned long long nvcsw;
+    unsigned long long nivcsw;
+    unsigned long minflt;
+    unsigned long majflt;
+} ProcEntry;
+
+/**
+ * @brief Looks up the entry for a PID.
+ *
+ * @param pid The process ID.
+ * @return ProcEntry* The entry, or NULL if the PID is not tracked.
+ */
+ProcEntry* proc_table_lookup(pid_t pid);
+
+/**
+ * @brief Returns the entry for (pid, start_ticks), creating it if needed.
+ *
+ * If the PID is tracked with a different start time (PID reuse), the entry
+ * is reset. The entry is marked as seen in the current generation.
+ *
+ * @param pid The process ID.
+ * @param start_ticks Process start time since boot in clock ticks.
+ * @return ProcEntry* The entry, or NULL if the table is full.
+ */
+ProcEntry* proc_table_upsert(pid_t pid, unsigned long long start_ticks);
+
+/**
+ * @brief Starts a new scan generation.
+ *
+ * Must be called before a full /proc walk so that proc_table_end_scan()
+ * can tell which PIDs disappeared.
+ */
+void proc_table_begin_scan(void);
+
+/**
+ * @brief Marks an entry as seen in the current generation without re-reading it.
+ *
+ * @param entry The entry (NULL is ignored).
+ */
+void proc_table_mark_seen(ProcEntry *entry);
+
+/**
+ * @brief Evicts every entry that was not seen since proc_table_begin_scan().
+ */
+void proc_table_end_scan(void);
+
+/**
+ * @brief Removes a single PID from the table.
+ *
+ * @param pid The process ID.
+ */
+void proc_table_remove(pid_t pid);
+
+/**
+ * @brief Registers a function called for every entry about to be dropped.
+ *
+ * Called when a PID is evicted or removed, and when a recycled PID resets its
+ * entry, so modules keeping references in an entry can release them.
+ *
+ * @param hook The function (NULL to unregister).
+ */
+void proc_table_set_evict_hook(void (*hook)(ProcEntry *entry));
+
+/**
+ * @brief FNV-1a hash of a string, for the tables keyed by text.
+ *
+ * @param text NUL-terminated string.
+ * @return unsigned int The hash.
+ */
+unsigned int hash_string(const char *text);
+
+/**
+ * @brief Empties a slot of an open-addressing table of ints.
+ *
+ * Same backward-shift deletion as the per-PID table: later entries of the
+ * probe chain move back so lookups never hit a hole (no tombstones).
+ *
+ * @param slots Slots with linear probing (0 = empty).
+ * @param size Number of slots (power of two).
+ * @param slot The slot to empty.
+ * @param hash_of Returns the hash a stored value was inserted with.
+ */
+void hash_slots_delete(int slots[], unsigned int size, unsigned int slot,
+                       unsigned int (*hash_of)(int value));
+
+#endif // PROC_TABLE_H
@@ -3,15 +3,80 @@
 
 
 #include "common.h"
+#include "proc_table.h"
+
+// Scan flags: skip expensive per-process reads and reuse the values cached
+// from the last full read of the same (pid, starttime). Processes seen for
+// the first time are always read in full.
+#define SCAN_SKIP_STATUS  0x01u  // Skip /proc/[pid]/status (uid, user)
+#define SCAN_SKIP_CMDLINE 0x02u  // Skip /proc/[pid]/cmdline
+// Optional reads, only done when the matching columns are shown
+#define SCAN_READ_IO      0x04u  // Read /proc/[pid]/io and compute I/O rates
+
+#define SCAN_HIDE_KTHREADS 0x08u  // Leave kernel threads out (known ones are not even read)
+#define SCAN_READ_SCHED   0x10u  // Read schedstat and all of status; compute latency/fault rates
+
+// Task flag of kernel threads in /proc/[pid]/stat (PF_KTHREAD in linux/sched.h)
+#define PF_KTHREAD 0x00200000u
+
+// uid/user/cmdline rarely change during a process's life: they are re-read
+// only this often (and after exec()); kernel threads are never re-read
+#define STATIC_REFRESH_SECONDS 30.0
+
+// PIDs handed to a batching backend (e.g. io_uring) per call
+#define SCAN_BATCH_SIZE 256
+
+// Bytes read from /proc/[pid]/stat and status (the Uid line is near the top)
+#define PROC_STAT_TEXT_SIZE 1024
+#define PROC_STATUS_TEXT_SIZE 1024
+// The context switch counts are the last lines of status
+#define PROC_STATUS_FULL_SIZE 4096
+#define PROC_SCHEDSTAT_TEXT_SIZE 128
+
+/**
+ * @brief /proc/[pid] file contents already read by a batching backend.
+ *
+ * Files that were not read are NULL; process_info_from_text() then uses the
+ * cached values or reads them itself.
+ */
+typedef struct {
+    const char *stat;           // NUL-terminated, required
+    const char *status;         // NUL-terminated
+    const char *cmdline;        // Raw bytes (NUL-separated arguments)
+    size_t cmdline_len;
+    const char *io;             // NUL-terminated
+    const char *schedstat;      // NUL-terminated
+} ProcText;
+
+// Minimum age of a cached smaps_rollup sample before it is read again
+#define SMAPS_REFRESH_SECONDS 5.0
 
 /**
  * @brief Scans the /proc directory and fills the processes array with information about each process.      
  * 
  * @param processes 
  * @param max_processes 
+ * @param total_mem Total system memory in bytes, used to calculate memory percentage.
+ * @param flags Combination of SCAN_* flags (0 for a full scan).
  * @return int 
  */
-int scan_processes(ProcessInfo processes[], int max_processes, unsigned long total_mem);
+int scan_processes(ProcessInfo processes[], int max_processes, unsigned long total_mem,
+                   unsigned int flags);
+
+/**
+ * @brief Re-reads the processes already in the table without walking /proc.
+ * 
+ * Used between full rescans when process arrival/exit is tracked through
+ * proc connector events. Rows whose process has vanished are dropped.
+ * 
+ * @param processes Process table to refresh in place.
+ * @param count Number of valid entries in the table.
+ * @param total_mem Total system memory in bytes, used to calculate memory percentage.
+ * @param flags Combination of SCAN_* flags.
+ * @return int New number of valid entries.
+ */
+int refresh_processes(ProcessInfo processes[], int count, unsigned long total_mem,
+                      unsigned int flags);
 
 /** 
  * @brief Retrieves information about a specific process given its PID.
@@ -19,9 +84,50 @@ int scan_processes(ProcessInfo processes[], int max_processes, unsigned long tot
  * @param pid The process ID.
  * @param pinfo Pointer to a ProcessInfo structure to store the process information.
  * @param total_mem Total system memory in bytes, used to calculate memory percentage.
+ * @param flags Combination of SCAN_* flags (0 for a full read).
  * @return int Returns 0 on success, or a negative value on failure.
  */
-int get_process_info(pid_t pid, ProcessInfo *pinfo, unsigned long total_mem);
+int get_process_info(pid_t pid, ProcessInfo *pinfo, unsigned long total_mem,
+                     unsigned int flags);
+
+/**
+ * @brief Fills a ProcessInfo from /proc/[pid] files that were already read.
+ * 
+ * Same result as get_process_info(), for backends that read the files of
+ * many processes at once. Files missing from 'text' are read synchronously
+ * unless the flags allow the cached values to be used.
+ * 
+ * @param pid The process ID.
+ * @param text The file contents.
+ * @param system_uptime Seconds since boot (from /proc/uptime).
+ * @param pinfo Pointer to a ProcessInfo structure to store the process information.
+ * @param total_mem Total system memory in bytes, used to calculate memory percentage.
+ * @param flags Combination of SCAN_* flags.
+ * @return int 0 on success, -1 if stat could not be parsed or the process is gone.
+ */
+int process_info_from_text(pid_t pid, const ProcText *text, float system_uptime,
+                           ProcessInfo *pinfo, unsigned long total_mem, unsigned int flags);
+
+/**
+ * @brief Returns true if the cached uid/user/cmdline of an entry can be used
+ *        without reading status and cmdline again.
+ */
+bool proc_static_is_fresh(const ProcEntry *entry);
+
+/**
+ * @brief Reads the system uptime in seconds from /proc/uptime (0 on failure).
+ */
+float read_uptime(void);
+
+/**
+ * @brief Reads a clock (e.g. CLOCK_PROCESS_CPUTIME_ID) in seconds, 0 on failure.
+ */
+double clock_seconds(clockid_t clock);
+
+/**
+ * @brief Seconds on CLOCK_MONOTONIC, the time base of every interval and rate.
+ */
+double monotonic_seconds(void);
 
 /**
  * @brief Checks if a given string represents a valid process ID (PID).
@@ -42,6 +148,15 @@ int is_pid(const char* str);
 int get_uid(const char* username, uid_t* uid);
 
 
+/**
+ * @brief Resolves a UID to a username, falling back to the numeric UID.
+ * 
+ * @param uid The user ID.
+ * @param buffer Pointer to a buffer where the username will be stored.
+ * @param size Size of the buffer.
+ */
+void get_username(uid_t uid, char *buffer, size_t size);
+
 /**
  * @brief Retrieves the command line of a process given its PID.
  * 
@@ -65,12 +180,78 @@ int get_cmdline(pid_t pid, char *buffer, size_t size);
  */
 void get_system_info(sysinfo_t *sysinfo);
 
+/**
+ * @brief Reads the I/O counters of a process from /proc/[pid]/io.
+ * 
+ * Needs the same privileges as ptrace; fields stay 0 when access is denied.
+ * 
+ * @param pid The process ID.
+ * @param pinfo Process to fill (read_bytes, write_bytes, rchar, wchar).
+ * @return int 0 on success, -1 on failure.
+ */
+int get_process_io(pid_t pid, ProcessInfo *pinfo);
+
+/**
+ * @brief Reads PSS, USS and swap of a process from /proc/[pid]/smaps_rollup.
+ * 
+ * The kernel walks every mapping of the process to produce this file, so it
+ * is far more expensive than stat or status. Needs ptrace access.
+ * 
+ * @param pid The process ID.
+ * @param pinfo Process to fill (pss, uss, swap, has_smaps).
+ * @return int 0 on success, -1 on failure.
+ */
+int get_process_smaps(pid_t pid, ProcessInfo *pinfo);
+
+/**
+ * @brief Fills PSS/USS/swap for a few rows, typically the visible ones.
+ * 
+ * Each (pid, starttime) is re-read at most every SMAPS_REFRESH_SECONDS; in
+ * between the values cached in the per-PID table are used.
+ * 
+ * @param rows Rows to fill.
+ * @param count Number of rows.
+ */
+void update_smaps(ProcessInfo rows[], int count);
+
+/**
+ * @brief Converts the I/O counters of a process into per-second rates.
+ * 
+ * Uses the previous sample of the same (pid, starttime) kept in the per-PID
+ * table. Rates are 0 on the first sample.
+ * 
+ * @param pinfo Process with fresh counters.
+ */
+void update_io_rates(ProcessInfo *pinfo);
+
+/**
+ * @brief Converts the scheduler and fault counters of a process into per-second rates.
+ * 
+ * Same as update_io_rates() for run-queue wait, context switches and page
+ * faults. Only meaningful for rows read with SCAN_READ_SCHED.
+ * 
+ * @param pinfo Process with fresh counters.
+ */
+void update_sched_rates(ProcessInfo *pinfo);
+
+/**
+ * @brief Samples system-wide disk throughput from /proc/diskstats.
+ * 
+ * Only whole disks are counted (partitions, loop, ram, dm and md devices are
+ * skipped to avoid double counting). The first call only primes the sample.
+ * 
+ * @param sysinfo System information to fill (disk_* fields).
+ */
+void get_disk_stats(sysinfo_t *sysinfo);
+
 /**
  * @brief Sorts the processes array according to the specified sort mode.
  * 
  * @param processes Array of process information to sort.
  * @param count Number of processes in the array.
- * @param mode Sorting mode (SORT_BY_PID, SORT_BY_CPU, SORT_BY_MEM, SORT_BY_USER).
+ * @param mode Sorting mode (SORT_BY_PID, SORT_BY_CPU, SORT_BY_MEM, SORT_BY_USER,
+ *             SORT_BY_IO_READ, SORT_BY_IO_WRITE, SORT_BY_SCHED_WAIT,
+ *             SORT_BY_CTX_SWITCHES, SORT_BY_FAULTS).
  */
 void sort_processes(ProcessInfo processes[], int count, SortMode mode);
 
@@ -103,12 +284,4 @@ int filter_processes_advanced(const ProcessInfo processes[], int count,
                                const char* name_filter, char state_filter,
                                float mem_threshold_mb);
 
-/**
- * @brief Builds process tree by calculating tree depth for each process.
- * 
- * @param processes Array of processes to build tree for.
- * @param count Number of processes.
- */
-void build_process_tree(ProcessInfo processes[], int count);
-
 #endif // PROCESS_MONITOR_H
\ No newline at end of file
@@ -0,0 +1,70 @@
+#ifndef REFRESH_BUDGET_H
+#define REFRESH_BUDGET_H
+
+#include <stdbool.h>
+
+// Every this many degraded refreshes, one full refresh is done to refresh
+// cached attributes and re-measure the cost of a full scan
+#define BUDGET_FULL_SCAN_EVERY 8
+
+/**
+ * @brief Adaptive refresh scheduler that keeps AltTasker's own CPU usage
+ *        under a configured budget.
+ *
+ * Each refresh is bracketed by refresh_budget_begin()/refresh_budget_end(),
+ * which measure the CPU time it consumed. The effective refresh interval is
+ * stretched or shrunk (within [min_ms, max_ms]) so that cost / interval stays
+ * below the budget. When even max_ms cannot satisfy the budget, refreshes are
+ * degraded: status and cmdline reads are skipped and cached values reused.
+ */
+typedef struct {
+    float budget_percent;       // Target self CPU share (0 = fixed interval)
+    int base_ms;                // Configured refresh interval
+    int min_ms;                 // Lower bound for the effective interval
+    int max_ms;                 // Upper bound for the effective interval
+    int interval_ms;            // Current effective refresh interval
+
+    double full_cost;           // Smoothed CPU seconds of a full refresh
+    double degraded_cost;       // Smoothed CPU seconds of a degraded refresh
+    double last_cost;           // CPU seconds of the most recent refresh
+    float self_cpu_percent;     // Own CPU share over the last refresh cycle
+
+    bool degraded;              // Next refresh skips expensive fields
+    bool current_degraded;      // Refresh in progress is degraded
+    int degraded_streak;        // Degraded refreshes since the last full one
+
+    double refresh_cpu_start;   // Process CPU time at refresh_budget_begin()
+    double cycle_cpu_start;     // Process CPU time at the previous refresh end
+    double cycle_wall_start;    // Monotonic time at the previous refresh end
+} RefreshBudget;
+
+/**
+ * @brief Initializes the scheduler.
+ *
+ * @param budget Scheduler state to initialize.
+ * @param budget_percent CPU budget in percent of one core (0 disables adaptation).
+ * @param base_ms Configured refresh interval in milliseconds.
+ * @param min_ms Smallest allowed refresh interval in milliseconds.
+ * @param max_ms Largest allowed refresh interval in milliseconds.
+ */
+void refresh_budget_init(RefreshBudget *budget, float budget_percent,
+                         int base_ms, int min_ms, int max_ms);
+
+/**
+ * @brief Marks the start of a refresh (scan + render).
+ */
+void refresh_budget_begin(RefreshBudget *budget);
+
+/**
+ * @brief Marks the end of a refresh and recomputes the effective interval.
+ */
+void refresh_budget_end(RefreshBudget *budget);
+
+/**
+ * @brief Returns the SCAN_* flags the refresh in progress should use.
+ *
+ * @return unsigned int 0 for a full scan, or skip flags on degraded refreshes.
+ */
+unsigned int refresh_budget_scan_flags(const RefreshBudget *budget);
+
+#endif // REFRESH_BUDGET_H
@@ -0,0 +1,63 @@
+#ifndef REMOTE_H
+#define REMOTE_H
+
+#include "common.h"
+
+// Wire protocol between "--daemon" and "--connect" (same host, host byte order)
+#define REMOTE_MAGIC 0x4b534154u   // "TASK"
+#define REMOTE_VERSION 4
+#define REMOTE_MAX_CLIENTS 32
+#define REMOTE_MAX_MESSAGE (16u * 1024u * 1024u)
+
+/**
+ * @brief Writes the default socket path for this user into 'buffer'.
+ *
+ * $XDG_RUNTIME_DIR/alttasker.sock, or /tmp/alttasker-UID.sock without it.
+ *
+ * @param buffer Destination.
+ * @param size Size of the destination.
+ */
+void remote_default_path(char *buffer, size_t size);
+
+/**
+ * @brief Runs the snapshot daemon until SIGINT/SIGTERM.
+ *
+ * Scans /proc once per refresh_interval (I/O counters included, so clients
+ * can show the I/O columns) and serves the result on a Unix domain socket.
+ * A client receives one full snapshot when it connects and then only the
+ * rows that changed, the PIDs that exited and the system totals after each
+ * scan. Clients that stop reading are dropped and may reconnect.
+ *
+ * @param path Socket path (created with mode 0600).
+ * @return int 0 on clean shutdown, 1 on setup failure.
+ */
+int run_daemon(const char *path);
+
+/**
+ * @brief Connects to a running daemon.
+ *
+ * @param path Socket path.
+ * @return int 0 on success, -1 if no daemon is listening.
+ */
+int remote_connect(const char *path);
+
+/**
+ * @brief Applies every message the daemon sent since the last call.
+ *
+ * Never blocks. The rows are kept sorted by PID and also registered in the
+ * per-PID table, so search, cgroup grouping and smaps work as with a local
+ * scan. If the connection was lost, one reconnect is attempted.
+ *
+ * @param processes Destination for the current process table.
+ * @param max_processes Capacity of the destination.
+ * @param sysinfo Destination for the daemon's system totals.
+ * @return int Number of processes, or -1 while disconnected.
+ */
+int remote_receive(ProcessInfo processes[], int max_processes, sysinfo_t *sysinfo);
+
+/**
+ * @brief Closes the client connection.
+ */
+void remote_close(void);
+
+#endif // REMOTE_H
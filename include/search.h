@@ -0,0 +1,73 @@
+#ifndef SEARCH_H
+#define SEARCH_H
+
+#include "common.h"
+
+// Maximum number of distinct interned search strings
+#define SEARCH_MAX_STRINGS 4096
+// Number of trigram posting lists (power of two)
+#define TRIGRAM_BITS 14
+#define TRIGRAM_BUCKETS (1 << TRIGRAM_BITS)
+
+typedef enum {
+    SEARCH_IGNORE_CASE,  // Substring, case-insensitive
+    SEARCH_MATCH_CASE,   // Substring, case-sensitive
+    SEARCH_REGEX         // POSIX extended regex, case-insensitive
+} SearchMode;
+
+/**
+ * @brief Prepares the search index.
+ *
+ * Registers with the per-PID table so strings of exited processes are
+ * released as soon as their PID is evicted.
+ */
+void search_init(void);
+
+/**
+ * @brief Frees every interned string and posting list.
+ */
+void search_shutdown(void);
+
+/**
+ * @brief Brings the index up to date with the process table.
+ *
+ * Each process is indexed by "name\ncmdline". Identical strings (e.g. many
+ * workers of one server) are interned once and share one set of trigram
+ * postings. Only processes that are new or exec'd since the last call are
+ * (re)indexed; exited ones were already released through the per-PID table.
+ *
+ * @param processes Process table.
+ * @param count Number of processes.
+ */
+void search_index_update(const ProcessInfo processes[], int count);
+
+/**
+ * @brief Sets the active query.
+ *
+ * @param query Text or regex to search for (empty matches everything).
+ * @param mode How the query is matched.
+ * @return int 0 on success, -1 if the regex does not compile (nothing matches).
+ */
+int search_set_query(const char *query, SearchMode mode);
+
+/**
+ * @brief Keeps only the processes matching the active query.
+ *
+ * Candidate strings come from the posting list of the query's rarest
+ * trigram and are then verified, so the cost depends on the number of
+ * candidates rather than on the total length of all command lines. Queries
+ * shorter than three characters and regexes test every distinct string.
+ *
+ * @param processes Source rows (must have been passed to search_index_update()).
+ * @param count Number of source rows.
+ * @param matched Destination for matching rows (may equal processes).
+ * @return int Number of matching rows.
+ */
+int search_apply(const ProcessInfo processes[], int count, ProcessInfo matched[]);
+
+/**
+ * @brief Returns a short label for a search mode (e.g. "regex").
+ */
+const char* search_mode_name(SearchMode mode);
+
+#endif // SEARCH_H
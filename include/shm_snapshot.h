@@ -0,0 +1,33 @@
+#ifndef SHM_SNAPSHOT_H
+#define SHM_SNAPSHOT_H
+
+#include "common.h"
+
+/**
+ * @brief Creates and maps the shared-memory snapshot (see alttasker_shm.h).
+ *
+ * Only one process per user publishes: the object is locked with flock(),
+ * so a second AltTasker instance simply does not publish.
+ *
+ * @return int 0 if this process is the publisher, -1 otherwise.
+ */
+int shm_snapshot_open(void);
+
+/**
+ * @brief Publishes one scan into the shared region under the seqlock.
+ *
+ * Rows are written in scan order; strings that do not fit the pool are
+ * published as empty. Does nothing unless shm_snapshot_open() succeeded.
+ *
+ * @param processes Scanned processes (not modified).
+ * @param count Number of processes.
+ * @param sysinfo System totals of the same refresh.
+ */
+void shm_snapshot_publish(const ProcessInfo processes[], int count, const sysinfo_t *sysinfo);
+
+/**
+ * @brief Unmaps and removes the shared region.
+ */
+void shm_snapshot_close(void);
+
+#endif // SHM_SNAPSHOT_H
@@ -0,0 +1,43 @@
+#ifndef SOCKETS_H
+#define SOCKETS_H
+
+#include "common.h"
+
+// Minimum age of a process's socket counts before its fds are read again
+#define SOCKETS_REFRESH_SECONDS 5.0
+// fd links read per call of update_sockets(); a larger fd table is
+// continued on the next call
+#define SOCKETS_FD_BUDGET 8192
+
+/**
+ * @brief Indexes the connections of /proc/net/{tcp,tcp6,udp,udp6} by inode.
+ *
+ * The tables are parsed once per call into an inode -> (protocol, state)
+ * hash, so joining a process's socket fds against them costs O(1) per fd.
+ * Connections are those of AltTasker's network namespace.
+ *
+ * @return int Number of connections indexed, or -1 if /proc/net is unreadable.
+ */
+int sockets_refresh(void);
+
+/**
+ * @brief Fills the socket counts of a few rows, typically the visible ones.
+ *
+ * Socket fds ("socket:[inode]" links in /proc/[pid]/fd) are counted and
+ * joined against the index of the last sockets_refresh(). Each (pid,
+ * starttime) is re-read at most every SOCKETS_REFRESH_SECONDS, and at most
+ * SOCKETS_FD_BUDGET fd links are read per call: a process with a huge fd
+ * table is counted across several calls and keeps its previous counts
+ * (or none) until it is done. Other users' processes need root.
+ *
+ * @param rows Rows to fill (has_sockets and the socket counts).
+ * @param count Number of rows.
+ */
+void update_sockets(ProcessInfo rows[], int count);
+
+/**
+ * @brief Frees the connection index and any fd scan in progress.
+ */
+void sockets_close(void);
+
+#endif // SOCKETS_H
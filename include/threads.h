@@ -0,0 +1,40 @@
+#ifndef THREADS_H
+#define THREADS_H
+
+#include "common.h"
+
+// Maximum number of threads listed for an expanded process
+#define MAX_THREADS 512
+
+/**
+ * @brief Reads the threads of one process from /proc/[pid]/task/[tid].
+ * 
+ * Only the expanded process is scanned, so the cost is proportional to its
+ * thread count rather than multiplying the normal scan. CPU usage is the
+ * delta since the previous call for the same process (lifetime average on
+ * the first call). Rows have is_thread set, pid = TID and ppid = PID.
+ * 
+ * @param pid The process whose threads to read.
+ * @param parent The process row, used for user and memory columns (may be NULL).
+ * @param threads Destination array.
+ * @param max_threads Capacity of the destination array.
+ * @return int Number of threads read, or -1 if the process is gone.
+ */
+int scan_threads(pid_t pid, const ProcessInfo *parent, ProcessInfo threads[], int max_threads);
+
+/**
+ * @brief Copies display rows and inserts thread rows right after their process.
+ * 
+ * @param rows Display rows (already filtered and sorted).
+ * @param count Number of display rows.
+ * @param threads Thread rows returned by scan_threads().
+ * @param thread_count Number of thread rows.
+ * @param out Destination array.
+ * @param max_out Capacity of the destination array.
+ * @return int Number of rows written to out.
+ */
+int insert_thread_rows(const ProcessInfo rows[], int count,
+                       const ProcessInfo threads[], int thread_count,
+                       ProcessInfo out[], int max_out);
+
+#endif // THREADS_H
@@ -0,0 +1,43 @@
+#ifndef TREE_H
+#define TREE_H
+
+#include "common.h"
+
+// Slots of the PID -> row table (power of two, above 2 * MAX_PROCESS)
+#define TREE_TABLE_SIZE 2048
+
+/**
+ * @brief Orders rows as a process tree and folds collapsed subtrees.
+ *
+ * Children are listed below their parent in the order of 'rows' (so the
+ * current sort applies among siblings); a process whose parent is not in
+ * 'rows' is a root. Subtree totals (CPU%, MEM%, RSS, process count) are
+ * summed in one post-order pass. A collapsed node is written with the totals
+ * of its whole subtree and tree_folded set to the number of processes hidden
+ * below it; its descendants are skipped without being visited.
+ *
+ * @param rows Display rows (already filtered and sorted).
+ * @param count Number of rows.
+ * @param out Destination array, in tree order with tree_depth set.
+ * @param max_out Capacity of the destination array.
+ * @return int Number of rows written to out.
+ */
+int tree_build(const ProcessInfo rows[], int count, ProcessInfo out[], int max_out);
+
+/**
+ * @brief Folds or unfolds the subtree of a process.
+ *
+ * The state is kept per (pid, start time) in the process table, so it
+ * survives refreshes and is dropped when the process exits.
+ *
+ * @param pid The process to toggle.
+ * @return int 1 if now collapsed, 0 if expanded, -1 if the PID is unknown.
+ */
+int tree_toggle(pid_t pid);
+
+/**
+ * @brief Unfolds every collapsed subtree.
+ */
+void tree_expand_all(void);
+
+#endif // TREE_H
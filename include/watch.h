@@ -0,0 +1,86 @@
+#ifndef WATCH_H
+#define WATCH_H
+
+#include "common.h"
+
+// Sampling period bounds of the watch mode (milliseconds)
+#define WATCH_MIN_INTERVAL_MS 10
+#define WATCH_MAX_INTERVAL_MS 100
+// Samples kept and drawn, one column each
+#define WATCH_COLUMNS 72
+// Threads sampled with the process, and how often new ones are looked for
+#define WATCH_MAX_THREADS 64
+#define WATCH_TASK_RESCAN_MS 1000
+
+/**
+ * @brief One sample of the watched process.
+ */
+typedef struct {
+    float cpu;                  // CPU % since the previous sample (100 = one core)
+    unsigned long rss;          // Resident Set Size (bytes)
+    char state;                 // R, S, D, ... as in /proc/[pid]/stat
+    float minflt_rate;          // Minor faults per second
+    float majflt_rate;          // Major faults per second
+} WatchSample;
+
+/**
+ * @brief CPU series of one thread, aligned with the process samples.
+ */
+typedef struct {
+    pid_t tid;
+    char name[16];
+    float cpu[WATCH_COLUMNS];   // 0 before the thread was first sampled
+    float cpu_total;            // Sum of cpu[], to rank the threads
+} WatchThread;
+
+/**
+ * @brief What the watch pane shows, oldest sample first.
+ */
+typedef struct {
+    pid_t pid;                          // 0 = not watching
+    char name[MAX_NAME_LEN];
+    int interval_ms;
+    bool exited;                        // The process is gone, sampling stopped
+    int count;                          // Valid entries of samples[]
+    WatchSample samples[WATCH_COLUMNS];
+    unsigned long long total_samples;   // Taken since the watch started
+    int thread_count;                   // Valid entries of threads[] (0 without threads)
+    WatchThread threads[WATCH_MAX_THREADS];
+} WatchView;
+
+/**
+ * @brief Starts sampling one process from a background thread.
+ *
+ * /proc/[pid]/stat (and the schedstat of up to WATCH_MAX_THREADS threads)
+ * is opened once and re-read with pread() every 'interval_ms', so a sample
+ * costs one syscall per file and nothing else is read. The process CPU
+ * comes from utime + stime, which cover the whole thread group.
+ * A previous watch is stopped first.
+ *
+ * @param pid The process to watch.
+ * @param start_ticks Its start time, which must still match when opened.
+ * @param interval_ms Sampling period, clamped to WATCH_MIN/MAX_INTERVAL_MS.
+ * @param with_threads Also sample the CPU of each thread.
+ * @return int 0 on success, -1 if the process is gone or the thread failed.
+ */
+int watch_start(pid_t pid, unsigned long long start_ticks, int interval_ms, bool with_threads);
+
+/**
+ * @brief Stops the sampler and closes its files.
+ */
+void watch_stop(void);
+
+/**
+ * @brief Returns true while a watch is started (even if its process exited).
+ */
+bool watch_active(void);
+
+/**
+ * @brief Copies the current series.
+ *
+ * @param view Destination.
+ * @return bool True if samples were added since the previous call.
+ */
+bool watch_get(WatchView *view);
+
+#endif // WATCH_H
@@ -0,0 +1,588 @@
+#define _POSIX_C_SOURCE 200809L
+#include <fcntl.h>
+#include <sys/wait.h>
+#include "alerts.h"
+#include "process_monitor.h"
+
+// Hash buckets of the tracked (rule, process) table
+#define TRACK_BUCKETS 1024
+
+typedef struct {
+    AlertScope scope;
+    ProcessFilter filter;       // PROCESS: the test; COUNT: the processes counted
+    AlertSystemField field;     // SYSTEM
+    FilterOp op;                // COUNT and SYSTEM: value OP threshold
+    double threshold;
+} AlertCondition;
+
+typedef struct {
+    char name[ALERT_NAME_LEN];
+    AlertCondition condition;
+    AlertCondition clear;
+    bool has_clear;
+    double hold;                // Seconds the condition must hold before firing
+    int tracked;                // Tracked processes (process rules)
+    // State of count and system rules
+    bool pending;
+    bool firing;
+    double since;               // Monotonic time the condition started holding
+    time_t fired_at;
+    double value;               // Last measured value
+} AlertRule;
+
+// A process that matches (pending) or fired a process rule
+typedef struct {
+    bool used;
+    int rule;
+    pid_t pid;
+    unsigned long long start_ticks;
+    bool firing;
+    double since;
+    time_t fired_at;
+    unsigned int seen;          // Evaluation stamp of the last match
+    int next;                   // Next entry in the bucket + 1 (0 = end)
+    char process[MAX_NAME_LEN];
+} TrackedProcess;
+
+static const struct {
+    const char *name;
+    AlertSystemField field;
+} system_fields[] = {
+    { "mem", ALERT_SYS_MEM },
+    { "swap", ALERT_SYS_SWAP },
+    { "cpu", ALERT_SYS_CPU },
+    { "load", ALERT_SYS_LOAD },
+    { "procs", ALERT_SYS_PROCS },
+};
+
+static AlertRule rules[MAX_ALERT_RULES];
+static int rule_count = 0;
+static TrackedProcess tracked[ALERT_MAX_TRACKED];
+static int buckets[TRACK_BUCKETS];     // First entry + 1 (0 = empty)
+static int next_rule = 0;              // Where the next evaluation resumes
+static unsigned int eval_stamp = 0;
+static AlertStats stats;
+
+// Parses "30", "30s", "5m", "1h"
+static int parse_duration(const char *text, double *seconds) {
+    char *end;
+    double value = strtod(text, &end);
+    if (end == text || value < 0) return -1;
+
+    switch (*end) {
+        case 'h': value *= 3600.0; end++; break;
+        case 'm': value *= 60.0; end++; break;
+        case 's': end++; break;
+        default: break;
+    }
+    if (*end != '\0') return -1;
+
+    *seconds = value;
+    return 0;
+}
+
+// Parses "OP NUMBER" after a count() or system field
+static int parse_comparison(const char *text, AlertCondition *condition) {
+    while (isspace((unsigned char)*text)) text++;
+
+    if (strncmp(text, "!=", 2) == 0)      { condition->op = FILTER_OP_NE; text += 2; }
+    else if (strncmp(text, "<=", 2) == 0) { condition->op = FILTER_OP_LE; text += 2; }
+    else if (strncmp(text, ">=", 2) == 0) { condition->op = FILTER_OP_GE; text += 2; }
+    else if (*text == '=')                { condition->op = FILTER_OP_EQ; text++; }
+    else if (*text == '<')                { condition->op = FILTER_OP_LT; text++; }
+    else if (*text == '>')                { condition->op = FILTER_OP_GT; text++; }
+    else return -1;
+
+    char *end;
+    condition->threshold = strtod(text, &end);
+    if (end == text) return -1;
+    while (isspace((unsigned char)*end)) end++;
+    return (*end == '\0') ? 0 : -1;
+}
+
+static int compile_condition(const char *text, AlertCondition *condition,
+                             char *error, size_t error_size) {
+    while (isspace((unsigned char)*text)) text++;
+
+    if (strncmp(text, "count(", 6) == 0) {
+        const char *close = strrchr(text, ')');
+        if (!close) {
+            snprintf(error, error_size, "Missing ')': %s", text);
+            return -1;
+        }
+        char inner[MAX_FILTER_LEN];
+        snprintf(inner, sizeof(inner), "%.*s", (int)(close - text - 6), text + 6);
+
+        condition->scope = ALERT_COUNT;
+        if (filter_compile(inner, &condition->filter, error, error_size) != 0) return -1;
+        if (parse_comparison(close + 1, condition) != 0) {
+            snprintf(error, error_size, "Expected OP NUMBER after count(): %s", text);
+            return -1;
+        }
+        return 0;
+    }
+
+    if (strncmp(text, "system.", 7) == 0) {
+        const char *name = text + 7;
+        size_t name_len = 0;
+        while (isalpha((unsigned char)name[name_len])) name_len++;
+
+        condition->scope = ALERT_SYSTEM;
+        bool found = false;
+        for (size_t i = 0; i < sizeof(system_fields) / sizeof(system_fields[0]); i++) {
+            if (strlen(system_fields[i].name) == name_len &&
+                strncmp(system_fields[i].name, name, name_len) == 0) {
+                condition->field = system_fields[i].field;
+                found = true;
+                break;
+            }
+        }
+        if (!found) {
+            snprintf(error, error_size, "Unknown system field (mem, swap, cpu, load, procs): %s", text);
+            return -1;
+        }
+        if (parse_comparison(name + name_len, condition) != 0) {
+            snprintf(error, error_size, "Expected OP NUMBER: %s", text);
+            return -1;
+        }
+        return 0;
+    }
+
+    condition->scope = ALERT_PROCESS;
+    if (filter_compile(text, &condition->filter, error, error_size) != 0) return -1;
+    if (condition->filter.count == 0) {
+        snprintf(error, error_size, "Empty condition");
+        return -1;
+    }
+    return 0;
+}
+
+// Splits "NAME: CONDITION [for DURATION] [clear CONDITION]"
+static int compile_rule(const char *source, AlertRule *rule, char *error, size_t error_size) {
+    memset(rule, 0, sizeof(AlertRule));
+
+    const char *colon = strchr(source, ':');
+    if (!colon) {
+        snprintf(error, error_size, "Expected NAME: CONDITION");
+        return -1;
+    }
+    while (isspace((unsigned char)*source)) source++;
+    size_t name_len = (size_t)(colon - source);
+    while (name_len > 0 && isspace((unsigned char)source[name_len - 1])) name_len--;
+    if (name_len == 0 || name_len >= ALERT_NAME_LEN) {
+        snprintf(error, error_size, "Name must be 1-%d characters", ALERT_NAME_LEN - 1);
+        return -1;
+    }
+    memcpy(rule->name, source, name_len);
+    rule->name[name_len] = '\0';
+
+    // "for" and "clear" cannot be filter terms (they have no operator)
+    char buffer[ALERT_RULE_LEN];
+    char condition[ALERT_RULE_LEN] = "";
+    char clear[ALERT_RULE_LEN] = "";
+    snprintf(buffer, sizeof(buffer), "%s", colon + 1);
+
+    char *target = condition;
+    bool expect_duration = false;
+    char *save = NULL;
+    for (char *token = strtok_r(buffer, " \t", &save); token; token = strtok_r(NULL, " \t", &save)) {
+        if (expect_duration) {
+            if (parse_duration(token, &rule->hold) != 0) {
+                snprintf(error, error_size, "Bad duration: %s", token);
+                return -1;
+            }
+            expect_duration = false;
+        } else if (strcmp(token, "for") == 0) {
+            expect_duration = true;
+        } else if (strcmp(token, "clear") == 0) {
+            target = clear;
+            rule->has_clear = true;
+        } else {
+            size_t used = strlen(target);
+            snprintf(target + used, ALERT_RULE_LEN - used, "%s%s", used ? " " : "", token);
+        }
+    }
+    if (expect_duration) {
+        snprintf(error, error_size, "Missing duration after 'for'");
+        return -1;
+    }
+
+    if (compile_condition(condition, &rule->condition, error, error_size) != 0) return -1;
+    if (rule->has_clear) {
+        if (compile_condition(clear, &rule->clear, error, error_size) != 0) return -1;
+        if (rule->clear.scope != rule->condition.scope) {
+            snprintf(error, error_size, "'clear' must test the same kind of value as the condition");
+            return -1;
+        }
+    }
+    return 0;
+}
+
+int alerts_compile(const char sources[][ALERT_RULE_LEN], int count, char *error, size_t error_size) {
+    rule_count = 0;
+    memset(tracked, 0, sizeof(tracked));
+    memset(buckets, 0, sizeof(buckets));
+    memset(&stats, 0, sizeof(stats));
+    next_rule = 0;
+    if (error && error_size > 0) error[0] = '\0';
+
+    if (count > MAX_ALERT_RULES) count = MAX_ALERT_RULES;
+    for (int i = 0; i < count; i++) {
+        char message[256];
+        if (compile_rule(sources[i], &rules[i], message, sizeof(message)) != 0) {
+            if (error && error_size > 0) {
+                snprintf(error, error_size, "alert rule %d (%s): %s", i + 1, sources[i], message);
+            }
+            return -1;
+        }
+    }
+
+    rule_count = count;
+    stats.rules = count;
+    return 0;
+}
+
+static bool compare(double value, FilterOp op, double threshold) {
+    switch (op) {
+        case FILTER_OP_EQ: return value == threshold;
+        case FILTER_OP_NE: return value != threshold;
+        case FILTER_OP_LT: return value < threshold;
+        case FILTER_OP_LE: return value <= threshold;
+        case FILTER_OP_GT: return value > threshold;
+        case FILTER_OP_GE: return value >= threshold;
+        default:           return false;
+    }
+}
+
+static double scalar_value(const AlertCondition *condition, const ProcessInfo processes[],
+                           int count, const sysinfo_t *sysinfo, float load1) {
+    if (condition->scope == ALERT_COUNT) {
+        int matches = 0;
+        for (int i = 0; i < count; i++) {
+            if (filter_match(&condition->filter, &processes[i])) matches++;
+        }
+        return matches;
+    }
+
+    switch (condition->field) {
+        case ALERT_SYS_MEM:   return sysinfo->mem_usage_percent;
+        case ALERT_SYS_SWAP:
+            return sysinfo->swap_total ? (double)sysinfo->swap_used * 100.0 / (double)sysinfo->swap_total : 0.0;
+        case ALERT_SYS_CPU:   return sysinfo->cpu_usage_percent;
+        case ALERT_SYS_LOAD:  return load1;
+        case ALERT_SYS_PROCS: return count;
+        default:              return 0.0;
+    }
+}
+
+extern char **environ;
+
+// Runs the hook detached (double fork, so no child is left to reap). The
+// arguments and environment are built before fork(): with the detail and
+// watch threads running, the child may only make async-signal-safe calls.
+static void run_hook(const char *name, bool firing, pid_t pid, double value) {
+    static const char *const names[] = { "ALERT_NAME=", "ALERT_STATE=", "ALERT_PID=", "ALERT_VALUE=" };
+    char vars[4][ALERT_NAME_LEN + 32];
+    snprintf(vars[0], sizeof(vars[0]), "%s%s", names[0], name);
+    snprintf(vars[1], sizeof(vars[1]), "%s%s", names[1], firing ? "firing" : "resolved");
+    snprintf(vars[2], sizeof(vars[2]), "%s%d", names[2], (int)pid);
+    snprintf(vars[3], sizeof(vars[3]), "%s%.2f", names[3], value);
+
+    int env_count = 0;
+    while (environ[env_count]) env_count++;
+    char **envp = malloc((env_count + 5) * sizeof(char *));
+    if (!envp) return;
+
+    // Inherited variables, minus any stale ALERT_* of the same names
+    int n = 0;
+    for (int i = 0; i < env_count; i++) {
+        bool replaced = false;
+        for (int v = 0; v < 4 && !replaced; v++) {
+            replaced = strncmp(environ[i], names[v], strlen(names[v])) == 0;
+        }
+        if (!replaced) envp[n++] = environ[i];
+    }
+    for (int v = 0; v < 4; v++) {
+        envp[n++] = vars[v];
+    }
+    envp[n] = NULL;
+    char *argv[] = { "sh", "-c", global_config.alert_hook, NULL };
+
+    pid_t child = fork();
+    if (child < 0) {
+        free(envp);
+        return;
+    }
+    if (child > 0) {
+        free(envp);
+        waitpid(child, NULL, 0);
+        return;
+    }
+
+    if (fork() != 0) _exit(0);
+
+    // The hook must not write into the UI
+    int null_fd = open("/dev/null", O_RDWR);
+    if (null_fd >= 0) {
+        dup2(null_fd, STDIN_FILENO);
+        dup2(null_fd, STDOUT_FILENO);
+        dup2(null_fd, STDERR_FILENO);
+        if (null_fd > STDERR_FILENO) close(null_fd);
+    }
+
+    execve("/bin/sh", argv, envp);
+    _exit(127);
+}
+
+// Logs a state change and runs the hook
+static void notify(const AlertRule *rule, bool firing, pid_t pid, const char *process, double value) {
+    if (global_config.alert_log[0] != '\0') {
+        FILE *log = fopen(global_config.alert_log, "a");
+        if (log) {
+            char stamp[32];
+            time_t now = time(NULL);
+            struct tm tm;
+            localtime_r(&now, &tm);
+            strftime(stamp, sizeof(stamp), "%Y-%m-%d %H:%M:%S", &tm);
+
+            fprintf(log, "%s %s %s", stamp, firing ? "FIRING" : "RESOLVED", rule->name);
+            if (pid > 0) {
+                fprintf(log, " pid=%d name=%s\n", (int)pid, process);
+            } else {
+                fprintf(log, " value=%.2f\n", value);
+            }
+            fclose(log);
+        }
+    }
+
+    if (global_config.alert_hook[0] != '\0') {
+        run_hook(rule->name, firing, pid, value);
+    }
+}
+
+static void evaluate_scalar_rule(AlertRule *rule, const ProcessInfo processes[], int count,
+                                 const sysinfo_t *sysinfo, float load1, double now) {
+    rule->value = scalar_value(&rule->condition, processes, count, sysinfo, load1);
+    bool holds = compare(rule->value, rule->condition.op, rule->condition.threshold);
+
+    if (rule->firing) {
+        bool resolved = !holds;
+        if (rule->has_clear) {
+            double clear_value = scalar_value(&rule->clear, processes, count, sysinfo, load1);
+            resolved = compare(clear_value, rule->clear.op, rule->clear.threshold);
+        }
+        if (resolved) {
+            rule->firing = false;
+            rule->pending = false;
+            stats.firing--;
+            notify(rule, false, 0, NULL, rule->value);
+        }
+        return;
+    }
+
+    if (!holds) {
+        rule->pending = false;
+        return;
+    }
+    if (!rule->pending) {
+        rule->pending = true;
+        rule->since = now;
+    }
+    if (now - rule->since >= rule->hold) {
+        rule->firing = true;
+        rule->fired_at = time(NULL);
+        stats.firing++;
+        notify(rule, true, 0, NULL, rule->value);
+    }
+}
+
+static unsigned int bucket_of(int rule, pid_t pid) {
+    return ((unsigned int)pid * 2654435761u + (unsigned int)rule * 40503u) % TRACK_BUCKETS;
+}
+
+static TrackedProcess* find_tracked(int rule, const ProcessInfo *p) {
+    for (int i = buckets[bucket_of(rule, p->pid)]; i != 0; i = tracked[i - 1].next) {
+        TrackedProcess *t = &tracked[i - 1];
+        if (t->rule == rule && t->pid == p->pid && t->start_ticks == p->start_ticks) return t;
+    }
+    return NULL;
+}
+
+static TrackedProcess* add_tracked(int rule, const ProcessInfo *p, double now) {
+    for (int i = 0; i < ALERT_MAX_TRACKED; i++) {
+        TrackedProcess *t = &tracked[i];
+        if (t->used) continue;
+
+        unsigned int bucket = bucket_of(rule, p->pid);
+        memset(t, 0, sizeof(TrackedProcess));
+        t->used = true;
+        t->rule = rule;
+        t->pid = p->pid;
+        t->start_ticks = p->start_ticks;
+        t->since = now;
+        t->next = buckets[bucket];
+        buckets[bucket] = i + 1;
+        rules[rule].tracked++;
+        return t;
+    }
+    return NULL;  // Table full: further matches are not tracked until entries free up
+}
+
+static void remove_tracked(TrackedProcess *t) {
+    int index = (int)(t - tracked) + 1;
+    int *link = &buckets[bucket_of(t->rule, t->pid)];
+    while (*link != 0 && *link != index) link = &tracked[*link - 1].next;
+    if (*link == index) *link = t->next;
+
+    rules[t->rule].tracked--;
+    t->used = false;
+}
+
+static void resolve_tracked(TrackedProcess *t) {
+    stats.firing--;
+    notify(&rules[t->rule], false, t->pid, t->process, 0.0);
+    remove_tracked(t);
+}
+
+static void evaluate_process_rule(int index, const ProcessInfo processes[], int count, double now) {
+    AlertRule *rule = &rules[index];
+    unsigned int stamp = ++eval_stamp;
+
+    for (int i = 0; i < count; i++) {
+        const ProcessInfo *p = &processes[i];
+        if (!filter_match(&rule->condition.filter, p)) continue;
+
+        TrackedProcess *t = find_tracked(index, p);
+        if (!t) t = add_tracked(index, p, now);
+        if (!t) continue;
+        t->seen = stamp;
+
+        if (!t->firing && now - t->since >= rule->hold) {
+            t->firing = true;
+            t->fired_at = time(NULL);
+            snprintf(t->process, sizeof(t->process), "%s", p->name);
+            stats.firing++;
+            notify(rule, true, p->pid, p->name, 0.0);
+        }
+    }
+
+    if (rule->tracked == 0) return;
+
+    // Entries whose process no longer matches (or exited)
+    for (int i = 0; i < ALERT_MAX_TRACKED; i++) {
+        TrackedProcess *t = &tracked[i];
+        if (!t->used || t->rule != index || t->seen == stamp) continue;
+
+        if (!t->firing) {
+            remove_tracked(t);  // Condition broke before the hold time passed
+            continue;
+        }
+        if (!rule->has_clear) {
+            resolve_tracked(t);
+            continue;
+        }
+
+        // Hysteresis: stays firing until the clear condition holds
+        const ProcessInfo *p = NULL;
+        for (int j = 0; j < count; j++) {
+            if (processes[j].pid == t->pid && processes[j].start_ticks == t->start_ticks) {
+                p = &processes[j];
+                break;
+            }
+        }
+        if (!p || filter_match(&rule->clear.filter, p)) resolve_tracked(t);
+    }
+}
+
+void alerts_evaluate(const ProcessInfo processes[], int count, const sysinfo_t *sysinfo,
+                     float load1, int budget_ms) {
+    if (rule_count == 0 || !sysinfo) return;
+
+    double start = monotonic_seconds();
+    double deadline = start + budget_ms / 1000.0;
+    int evaluated = 0;
+
+    while (evaluated < rule_count) {
+        int index = next_rule;
+        next_rule = (next_rule + 1) % rule_count;
+
+        if (rules[index].condition.scope == ALERT_PROCESS) {
+            evaluate_process_rule(index, processes, count, start);
+        } else {
+            evaluate_scalar_rule(&rules[index], processes, count, sysinfo, load1, start);
+        }
+        evaluated++;
+
+        // Always make progress, then stop at the budget and resume here next time
+        if (budget_ms > 0 && monotonic_seconds() >= deadline) break;
+    }
+
+    stats.evaluated = evaluated;
+    stats.eval_ms = (monotonic_seconds() - start) * 1000.0;
+}
+
+int alerts_firing(AlertEvent events[], int max_events) {
+    int n = 0;
+
+    for (int r = 0; r < rule_count && n < max_events; r++) {
+        if (!rules[r].firing) continue;
+        AlertEvent *e = &events[n++];
+        memset(e, 0, sizeof(AlertEvent));
+        snprintf(e->name, sizeof(e->name), "%.31s", rules[r].name);
+        e->value = rules[r].value;
+        e->since = rules[r].fired_at;
+    }
+    for (int i = 0; i < ALERT_MAX_TRACKED && n < max_events; i++) {
+        const TrackedProcess *t = &tracked[i];
+        if (!t->used || !t->firing) continue;
+        AlertEvent *e = &events[n++];
+        snprintf(e->name, sizeof(e->name), "%.31s", rules[t->rule].name);
+        e->pid = t->pid;
+        snprintf(e->process, sizeof(e->process), "%s", t->process);
+        e->value = 0.0;
+        e->since = t->fired_at;
+    }
+
+    // Oldest first (insertion sort, the list is short)
+    for (int i = 1; i < n; i++) {
+        AlertEvent event = events[i];
+        int j = i - 1;
+        while (j >= 0 && events[j].since > event.since) {
+            events[j + 1] = events[j];
+            j--;
+        }
+        events[j + 1] = event;
+    }
+    return n;
+}
+
+bool alerts_is_firing(pid_t pid) {
+    if (stats.firing == 0) return false;
+
+    // Called for every displayed row: one bucket chain per process rule
+    for (int r = 0; r < rule_count; r++) {
+        if (rules[r].tracked == 0) continue;
+        for (int i = buckets[bucket_of(r, pid)]; i != 0; i = tracked[i - 1].next) {
+            const TrackedProcess *t = &tracked[i - 1];
+            if (t->rule == r && t->pid == pid && t->firing) return true;
+        }
+    }
+    return false;
+}
+
+static unsigned int condition_scan_flags(const AlertCondition *condition) {
+    return condition->scope == ALERT_SYSTEM ? 0 : filter_scan_flags(&condition->filter);
+}
+
+unsigned int alerts_scan_flags(void) {
+    unsigned int flags = 0;
+    for (int r = 0; r < rule_count; r++) {
+        flags |= condition_scan_flags(&rules[r].condition);
+        if (rules[r].has_clear) flags |= condition_scan_flags(&rules[r].clear);
+    }
+    return flags;
+}
+
+AlertStats alerts_stats(void) {
+    return stats;
+}
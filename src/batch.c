@@ -0,0 +1,98 @@
+#define _POSIX_C_SOURCE 200809L
+#include <errno.h>
+#include "batch.h"
+#include "process_monitor.h"
+#include "data_source.h"
+#include "config.h"
+
+// Time between the two samples: CPU% and disk rates cover this span
+#define BATCH_SAMPLE_MS 1000
+
+// CPU time of a process in the first sample
+typedef struct {
+    pid_t pid;
+    unsigned long long start_ticks;
+    unsigned long ticks;        // utime + stime
+} CpuSample;
+
+static ProcessInfo batch_processes[MAX_PROCESS];
+static CpuSample first_sample[MAX_PROCESS];
+
+static int compare_samples(const void *a, const void *b) {
+    const CpuSample *sa = a, *sb = b;
+    if (sa->pid != sb->pid) return sa->pid < sb->pid ? -1 : 1;
+    return 0;
+}
+
+// Replaces the lifetime average of scan_processes() with the CPU% between samples
+static void apply_cpu_rates(ProcessInfo rows[], int count, int first_count, double elapsed) {
+    long ticks_per_sec = sysconf(_SC_CLK_TCK);
+    for (int i = 0; i < count; i++) {
+        ProcessInfo *p = &rows[i];
+        unsigned long ticks = p->utime + p->stime;
+        CpuSample key = { .pid = p->pid };
+        const CpuSample *before = bsearch(&key, first_sample, first_count, sizeof(CpuSample),
+                                          compare_samples);
+        // A process started in between used all of its CPU time within the span
+        unsigned long used = (before && before->start_ticks == p->start_ticks && ticks >= before->ticks)
+                           ? ticks - before->ticks : ticks;
+        p->cpu_usage = (float)((double)used / ticks_per_sec / elapsed * 100.0);
+        if (p->cpu_usage > 999.9f) p->cpu_usage = 999.9f;
+    }
+}
+
+int run_batch(const ProcessFilter *filter, SortMode sort) {
+    sysinfo_t sysinfo;
+    memset(&sysinfo, 0, sizeof(sysinfo));
+    get_system_info(&sysinfo);
+
+    data_source_select(global_config.data_source);
+
+    // Rates need two samples: the first only primes the I/O counters and CPU times
+    unsigned int flags = SCAN_READ_IO | filter_scan_flags(filter);
+    int first_count = scan_processes(batch_processes, MAX_PROCESS, sysinfo.total_mem, flags);
+    double first_time = monotonic_seconds();
+    if (first_count < 0) {
+        data_source_shutdown();
+        return 1;
+    }
+    for (int i = 0; i < first_count; i++) {
+        first_sample[i].pid = batch_processes[i].pid;
+        first_sample[i].start_ticks = batch_processes[i].start_ticks;
+        first_sample[i].ticks = batch_processes[i].utime + batch_processes[i].stime;
+    }
+    qsort(first_sample, first_count, sizeof(CpuSample), compare_samples);
+
+    struct timespec pause = { .tv_sec = BATCH_SAMPLE_MS / 1000,
+                              .tv_nsec = (BATCH_SAMPLE_MS % 1000) * 1000000L };
+    while (nanosleep(&pause, &pause) != 0 && errno == EINTR) {}
+
+    int count = scan_processes(batch_processes, MAX_PROCESS, sysinfo.total_mem, flags);
+    if (count < 0) {
+        data_source_shutdown();
+        return 1;
+    }
+    apply_cpu_rates(batch_processes, count, first_count, monotonic_seconds() - first_time);
+
+    // Compact matches in place: the filter reads rows where they are
+    int matched = 0;
+    for (int i = 0; i < count; i++) {
+        if (!filter_match(filter, &batch_processes[i])) continue;
+        if (matched != i) batch_processes[matched] = batch_processes[i];
+        matched++;
+    }
+
+    sort_processes(batch_processes, matched, sort);
+
+    printf("%-7s %-10s %6s %6s %10s %5s  %s\n",
+           "PID", "USER", "CPU%", "MEM%", "RSS(KB)", "STATE", "COMMAND");
+    for (int i = 0; i < matched; i++) {
+        const ProcessInfo *p = &batch_processes[i];
+        printf("%-7d %-10.10s %6.1f %6.2f %10lu %5c  %s\n",
+               p->pid, p->user, p->cpu_usage, p->mem_usage, p->rss / 1024, p->state,
+               p->cmdline[0] ? p->cmdline : p->name);
+    }
+
+    data_source_shutdown();
+    return 0;
+}
@@ -0,0 +1,105 @@
+#define _POSIX_C_SOURCE 200809L
+#include <signal.h>
+#include <sys/ptrace.h>
+#include <sys/wait.h>
+#include "benchmark.h"
+#include "common.h"
+#include "process_monitor.h"
+#include "data_source.h"
+
+static ProcessInfo bench_processes[MAX_PROCESS];
+
+// Counts the syscalls of one scan: a forked child runs it under ptrace and
+// the parent counts syscall stops. Returns -1 if ptrace is not permitted.
+static long count_scan_syscalls(const char *source, unsigned long total_mem, unsigned int flags) {
+    fflush(stdout);
+    pid_t child = fork();
+    if (child < 0) return -1;
+    
+    if (child == 0) {
+        // Backend setup and the warm-up scan happen before tracing starts
+        data_source_select(source);
+        scan_processes(bench_processes, MAX_PROCESS, total_mem, 0);
+        if (ptrace(PTRACE_TRACEME, 0, NULL, NULL) != 0) _exit(1);
+        kill(getpid(), SIGSTOP);
+        scan_processes(bench_processes, MAX_PROCESS, total_mem, flags);
+        _exit(0);
+    }
+    
+    int status;
+    if (waitpid(child, &status, 0) < 0) return -1;
+    if (!WIFSTOPPED(status)) return -1;  // PTRACE_TRACEME was refused
+    ptrace(PTRACE_SETOPTIONS, child, NULL, (void *)(long)(PTRACE_O_TRACESYSGOOD | PTRACE_O_EXITKILL));
+    
+    // Every syscall stops twice (entry and exit), except the final exit_group
+    long stops = 0;
+    while (ptrace(PTRACE_SYSCALL, child, NULL, NULL) == 0 && waitpid(child, &status, 0) == child) {
+        if (WIFEXITED(status)) {
+            return WEXITSTATUS(status) == 0 ? (stops + 1) / 2 - 1 : -1;
+        }
+        if (WIFSIGNALED(status)) break;
+        if (WIFSTOPPED(status) && WSTOPSIG(status) == (SIGTRAP | 0x80)) stops++;
+    }
+    
+    kill(child, SIGKILL);
+    waitpid(child, NULL, 0);
+    return -1;
+}
+
+// Times 'iterations' scans with the current backend and prints one result row
+static void bench_scans(const char *source, const char *label, int iterations,
+                        unsigned long total_mem, unsigned int flags) {
+    // Warm-up: fills caches so every timed scan sees the same state
+    int count = scan_processes(bench_processes, MAX_PROCESS, total_mem, 0);
+
+    double wall_start = monotonic_seconds();
+    double cpu_start = clock_seconds(CLOCK_PROCESS_CPUTIME_ID);
+    for (int i = 0; i < iterations; i++) {
+        count = scan_processes(bench_processes, MAX_PROCESS, total_mem, flags);
+    }
+    double wall = (monotonic_seconds() - wall_start) / iterations;
+    double cpu = (clock_seconds(CLOCK_PROCESS_CPUTIME_ID) - cpu_start) / iterations;
+
+    long syscalls = count_scan_syscalls(source, total_mem, flags);
+    
+    char syscalls_str[24] = "n/a";
+    if (syscalls >= 0) snprintf(syscalls_str, sizeof(syscalls_str), "%ld", syscalls);
+    printf("  %-24s %6d %12.3f %12.3f %12.2f %10s\n", label, count,
+           wall * 1000.0, cpu * 1000.0, count > 0 ? wall * 1e6 / count : 0.0, syscalls_str);
+}
+
+int run_benchmark(int iterations) {
+    if (iterations <= 0) iterations = 20;
+
+    sysinfo_t sysinfo;
+    get_system_info(&sysinfo);
+
+    printf("AltTasker scan benchmark (%d scans per backend)\n\n", iterations);
+    printf("  %-24s %6s %12s %12s %12s %10s\n", "BACKEND", "PROCS", "WALL ms", "CPU ms", "us/PROC",
+           "SYSCALLS");
+
+    int count = 0;
+    const DataSource *const *sources = data_source_list(&count);
+    for (int i = 0; i < count; i++) {
+        if (data_source_select(sources[i]->name) != sources[i]) {
+            printf("  %-24s unavailable (needs privileges or kernel support)\n", sources[i]->name);
+            continue;
+        }
+
+        bench_scans(sources[i]->name, sources[i]->name, iterations, sysinfo.total_mem, 0);
+
+        // Degraded refresh as used when over the CPU budget
+        char label[64];
+        snprintf(label, sizeof(label), "%s (stat only)", sources[i]->name);
+        bench_scans(sources[i]->name, label, iterations, sysinfo.total_mem,
+                    SCAN_SKIP_STATUS | SCAN_SKIP_CMDLINE);
+        
+        // Known kernel threads are skipped without any read
+        snprintf(label, sizeof(label), "%s (no kthreads)", sources[i]->name);
+        bench_scans(sources[i]->name, label, iterations, sysinfo.total_mem, SCAN_HIDE_KTHREADS);
+    }
+
+    data_source_shutdown();
+    printf("\n");
+    return 0;
+}
@@ -0,0 +1,392 @@
+#define _POSIX_C_SOURCE 200809L
+#include <fcntl.h>
+#include "cgroup.h"
+#include "process_monitor.h"
+#include "proc_table.h"
+
+// Slots of the path lookup table (power of two, twice the node capacity)
+#define CGROUP_SLOTS (2 * MAX_CGROUPS)
+
+// One cgroup v2 directory and its last sample
+typedef struct {
+    char path[CGROUP_PATH_LEN];     // Relative to the cgroup2 mount, "/" for the root
+    unsigned int hash;
+    unsigned int serial;            // New for every path a slot holds (0 = free slot)
+    int parent;                     // Node index, -1 for the root
+    int depth;
+    // cpu.stat
+    bool has_cpu;
+    bool cpu_sampled;               // cpu_usec holds a previous sample
+    unsigned long long cpu_usec;
+    float cpu_percent;
+    // memory.current / memory.pressure
+    bool has_memory;
+    unsigned long long memory_current;
+    bool has_pressure;
+    float memory_pressure;
+    // io.stat (summed over devices)
+    bool has_io;
+    bool io_sampled;
+    unsigned long long io_rbytes;
+    unsigned long long io_wbytes;
+    float read_rate;
+    float write_rate;
+    double sample_time;
+    int procs;                      // Processes in this cgroup or below (last refresh)
+} CgroupNode;
+
+static CgroupNode nodes[MAX_CGROUPS];
+static int node_limit = 0;          // Slots ever used
+static int free_nodes[MAX_CGROUPS];
+static int free_count = 0;
+static unsigned int next_serial = 1;
+// Live nodes, parents before children (slot order is not, once slots are reused)
+static int order[MAX_CGROUPS];
+static int order_count = 0;
+static int slots[CGROUP_SLOTS];     // Open addressing by path hash, node + 1 (0 = empty)
+static char mount_point[BUFFER_SIZE];
+static int mount_state = 0;  // 0 = not looked up, 1 = found, -1 = no cgroup2
+
+// Reads a small file with one read(); returns the length or -1
+static int read_file(const char *path, char *buffer, size_t size) {
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return -1;
+
+    ssize_t len = read(fd, buffer, size - 1);
+    close(fd);
+    if (len < 0) return -1;
+
+    buffer[len] = '\0';
+    return (int)len;
+}
+
+// Finds the cgroup2 mount point (usually /sys/fs/cgroup, or .../unified on hybrid systems)
+static bool find_mount(void) {
+    if (mount_state != 0) return mount_state > 0;
+
+    mount_state = -1;
+    FILE *fp = fopen("/proc/self/mountinfo", "r");
+    if (!fp) return false;
+
+    char line[BUFFER_SIZE];
+    while (fgets(line, sizeof(line), fp)) {
+        const char *separator = strstr(line, " - ");
+        if (!separator || strncmp(separator + 3, "cgroup2 ", 8) != 0) continue;
+
+        if (sscanf(line, "%*d %*d %*s %*s %511s", mount_point) == 1) {
+            mount_state = 1;
+            break;
+        }
+    }
+    fclose(fp);
+    return mount_state > 0;
+}
+
+static unsigned int home_slot(unsigned int hash) {
+    return hash & (CGROUP_SLOTS - 1);
+}
+
+// Hash a node was slotted by; slots hold node + 1
+static unsigned int node_hash(int slot_value) {
+    return nodes[slot_value - 1].hash;
+}
+
+static bool nodes_full(void) {
+    return free_count == 0 && node_limit >= MAX_CGROUPS;
+}
+
+// Returns the node for 'path', creating it and its ancestors (-1 if full)
+static int intern_path(const char *path) {
+    unsigned int hash = hash_string(path);
+    unsigned int slot = home_slot(hash);
+    while (slots[slot] != 0) {
+        const CgroupNode *node = &nodes[slots[slot] - 1];
+        if (node->hash == hash && strcmp(node->path, path) == 0) return slots[slot] - 1;
+        slot = (slot + 1) & (CGROUP_SLOTS - 1);
+    }
+
+    int parent = -1;
+    if (strcmp(path, "/") != 0) {
+        char parent_path[CGROUP_PATH_LEN];
+        snprintf(parent_path, sizeof(parent_path), "%s", path);
+        char *slash = strrchr(parent_path, '/');
+        if (!slash) return -1;
+        if (slash == parent_path) slash[1] = '\0';  // Child of the root
+        else *slash = '\0';
+
+        parent = intern_path(parent_path);
+        if (parent < 0) return -1;
+
+        // Interning the parents may have moved our empty slot along the chain
+        slot = home_slot(hash);
+        while (slots[slot] != 0) {
+            slot = (slot + 1) & (CGROUP_SLOTS - 1);
+        }
+    }
+
+    int index;
+    if (free_count > 0) {
+        index = free_nodes[--free_count];
+    } else if (node_limit < MAX_CGROUPS) {
+        index = node_limit++;
+    } else {
+        return -1;
+    }
+
+    CgroupNode *node = &nodes[index];
+    memset(node, 0, sizeof(CgroupNode));
+    snprintf(node->path, sizeof(node->path), "%s", path);
+    node->hash = hash;
+    node->serial = next_serial++;
+    if (next_serial == 0) next_serial = 1;  // 0 marks a free slot
+    node->parent = parent;
+    node->depth = (parent >= 0) ? nodes[parent].depth + 1 : 0;
+    slots[slot] = index + 1;
+    order[order_count++] = index;
+    return index;
+}
+
+// Frees every node without processes in its subtree, except the root
+static void evict_empty(void) {
+    int kept = 0;
+    for (int i = 0; i < order_count; i++) {
+        int index = order[i];
+        CgroupNode *node = &nodes[index];
+        if (node->procs > 0 || node->parent < 0) {
+            order[kept++] = index;
+            continue;
+        }
+
+        unsigned int slot = home_slot(node->hash);
+        while (slots[slot] != index + 1) {
+            slot = (slot + 1) & (CGROUP_SLOTS - 1);
+        }
+        hash_slots_delete(slots, CGROUP_SLOTS, slot, node_hash);
+        node->serial = 0;
+        free_nodes[free_count++] = index;
+    }
+    order_count = kept;
+}
+
+// Node of a process, or -1 if unknown or its node was freed since
+static int entry_node(const ProcEntry *entry) {
+    if (!entry || entry->cgroup_id <= 0) return -1;
+    const CgroupNode *node = &nodes[entry->cgroup_id - 1];
+    return node->serial == entry->cgroup_serial ? entry->cgroup_id - 1 : -1;
+}
+
+// Reads the v2 ("0::") line of /proc/[pid]/cgroup; returns node or -1
+static int resolve_pid(pid_t pid) {
+    char path[BUFFER_SIZE];
+    char buffer[2048];
+    snprintf(path, sizeof(path), "/proc/%d/cgroup", pid);
+    if (read_file(path, buffer, sizeof(buffer)) < 0) return -1;
+
+    char *line = strstr(buffer, "0::");
+    if (!line || (line != buffer && line[-1] != '\n')) return -1;
+
+    line += 3;
+    line[strcspn(line, "\n")] = '\0';
+    if (strlen(line) >= CGROUP_PATH_LEN) return -1;
+
+    return intern_path(line);
+}
+
+static void sample_node(CgroupNode *node, double now) {
+    char path[BUFFER_SIZE + CGROUP_PATH_LEN + 32];  // Mount + cgroup + file name
+    char buffer[4096];
+    double elapsed = now - node->sample_time;
+
+    snprintf(path, sizeof(path), "%s%s/cpu.stat", mount_point, node->path);
+    unsigned long long usec;
+    node->has_cpu = read_file(path, buffer, sizeof(buffer)) > 0 &&
+                    sscanf(buffer, "usage_usec %llu", &usec) == 1;
+    if (node->has_cpu) {
+        if (node->cpu_sampled && elapsed > 0.0 && usec >= node->cpu_usec) {
+            node->cpu_percent = (float)((usec - node->cpu_usec) / 1e6 / elapsed * 100.0);
+        }
+        node->cpu_usec = usec;
+        node->cpu_sampled = true;
+    }
+
+    snprintf(path, sizeof(path), "%s%s/memory.current", mount_point, node->path);
+    node->has_memory = read_file(path, buffer, sizeof(buffer)) > 0 &&
+                       sscanf(buffer, "%llu", &node->memory_current) == 1;
+
+    snprintf(path, sizeof(path), "%s%s/memory.pressure", mount_point, node->path);
+    node->has_pressure = read_file(path, buffer, sizeof(buffer)) > 0 &&
+                         sscanf(buffer, "some avg10=%f", &node->memory_pressure) == 1;
+
+    // io.stat: "MAJ:MIN rbytes=N wbytes=N rios=N ..." per device
+    snprintf(path, sizeof(path), "%s%s/io.stat", mount_point, node->path);
+    node->has_io = read_file(path, buffer, sizeof(buffer)) >= 0;
+    if (node->has_io) {
+        unsigned long long rbytes = 0, wbytes = 0;
+        for (char *line = buffer; *line; ) {
+            char *end = strchr(line, '\n');
+            if (end) *end = '\0';
+
+            const char *field = strstr(line, "rbytes=");
+            if (field) rbytes += strtoull(field + 7, NULL, 10);
+            field = strstr(line, "wbytes=");
+            if (field) wbytes += strtoull(field + 7, NULL, 10);
+
+            if (!end) break;
+            line = end + 1;
+        }
+
+        if (node->io_sampled && elapsed > 0.0) {
+            node->read_rate = (rbytes >= node->io_rbytes) ? (float)((rbytes - node->io_rbytes) / elapsed) : 0.0f;
+            node->write_rate = (wbytes >= node->io_wbytes) ? (float)((wbytes - node->io_wbytes) / elapsed) : 0.0f;
+        }
+        node->io_rbytes = rbytes;
+        node->io_wbytes = wbytes;
+        node->io_sampled = true;
+    }
+
+    node->sample_time = now;
+}
+
+int cgroup_refresh(const ProcessInfo processes[], int count) {
+    if (!processes || !find_mount()) return -1;
+
+    for (int i = 0; i < order_count; i++) {
+        nodes[order[i]].procs = 0;
+    }
+
+    for (int i = 0; i < count; i++) {
+        if (processes[i].is_thread) continue;
+
+        ProcEntry *entry = proc_table_lookup(processes[i].pid);
+        if (!entry || entry->start_ticks != processes[i].start_ticks) continue;
+
+        // Membership is read once per PID lifetime (again if its node was freed)
+        int node = entry_node(entry);
+        if (node < 0 && entry->cgroup_id >= 0 && !nodes_full()) {
+            node = resolve_pid(processes[i].pid);
+            // Out of nodes part way up the path: retry once some are freed
+            entry->cgroup_id = (node >= 0) ? node + 1 : (nodes_full() ? 0 : -1);
+            entry->cgroup_serial = (node >= 0) ? nodes[node].serial : 0;
+        }
+        if (node >= 0) nodes[node].procs++;
+    }
+
+    // Parents come before their children in order[], so one reverse pass sums subtrees
+    for (int i = order_count - 1; i > 0; i--) {
+        const CgroupNode *node = &nodes[order[i]];
+        if (node->parent >= 0) nodes[node->parent].procs += node->procs;
+    }
+
+    // Scopes of exited services and sessions come and go: only keep populated ones
+    evict_empty();
+
+    double now = monotonic_seconds();
+    int sampled = 0;
+    for (int i = 0; i < order_count; i++) {
+        if (nodes[order[i]].procs > 0) {
+            sample_node(&nodes[order[i]], now);
+            sampled++;
+        }
+    }
+    return sampled;
+}
+
+// Per-node values for the current build, indexed like nodes[]
+static ProcessGroup node_groups[MAX_CGROUPS];
+static SortMode sibling_sort;
+
+static int compare_nodes(const void *a, const void *b) {
+    const ProcessGroup *ga = &node_groups[*(const int *)a];
+    const ProcessGroup *gb = &node_groups[*(const int *)b];
+
+    switch (sibling_sort) {
+        case SORT_BY_PID:      return gb->count - ga->count;
+        case SORT_BY_CPU:
+        case SORT_BY_SCHED_WAIT:
+        case SORT_BY_CTX_SWITCHES:
+        case SORT_BY_FAULTS:   return (gb->cpu_usage > ga->cpu_usage) - (gb->cpu_usage < ga->cpu_usage);
+        case SORT_BY_USER:     return strcmp(ga->key, gb->key);
+        case SORT_BY_IO_READ:  return (gb->read_rate > ga->read_rate) - (gb->read_rate < ga->read_rate);
+        case SORT_BY_IO_WRITE: return (gb->write_rate > ga->write_rate) - (gb->write_rate < ga->write_rate);
+        case SORT_BY_MEM:
+        default:               return (gb->rss > ga->rss) - (gb->rss < ga->rss);
+    }
+}
+
+// Appends 'node' and its non-empty subtree in depth-first order
+static int emit_tree(int node, ProcessGroup groups[], int written, int max_groups) {
+    if (written >= max_groups) return written;
+    groups[written++] = node_groups[node];
+
+    int children[MAX_CGROUPS];
+    int child_count = 0;
+    for (int i = 0; i < order_count; i++) {
+        int child = order[i];
+        if (nodes[child].parent == node && node_groups[child].count > 0) {
+            children[child_count++] = child;
+        }
+    }
+    qsort(children, child_count, sizeof(int), compare_nodes);
+
+    for (int c = 0; c < child_count; c++) {
+        written = emit_tree(children[c], groups, written, max_groups);
+    }
+    return written;
+}
+
+int cgroup_build_groups(const ProcessInfo processes[], int count, SortMode sort,
+                        unsigned long total_mem, ProcessGroup groups[], int max_groups,
+                        int group_of[]) {
+    if (!processes || !groups || order_count == 0) return 0;
+
+    memset(node_groups, 0, node_limit * sizeof(ProcessGroup));
+
+    // Members' values, used where a cgroup file is missing
+    for (int i = 0; i < count; i++) {
+        const ProcEntry *entry = proc_table_lookup(processes[i].pid);
+        int node = entry_node(entry);
+        if (group_of) group_of[i] = node;
+        if (node < 0) continue;
+
+        ProcessGroup *g = &node_groups[node];
+        g->count++;
+        g->cpu_usage += processes[i].cpu_usage;
+        g->rss += processes[i].rss;
+        g->read_rate += processes[i].read_rate;
+        g->write_rate += processes[i].write_rate;
+        g->state = group_max_state(g->state, processes[i].state);
+    }
+    for (int i = order_count - 1; i > 0; i--) {
+        ProcessGroup *child = &node_groups[order[i]];
+        ProcessGroup *parent = &node_groups[nodes[order[i]].parent];
+        parent->count += child->count;
+        parent->cpu_usage += child->cpu_usage;
+        parent->rss += child->rss;
+        parent->read_rate += child->read_rate;
+        parent->write_rate += child->write_rate;
+        parent->state = group_max_state(parent->state, child->state);
+    }
+
+    // Prefer the kernel's own per-cgroup accounting
+    for (int o = 0; o < order_count; o++) {
+        int i = order[o];
+        const CgroupNode *node = &nodes[i];
+        ProcessGroup *g = &node_groups[i];
+
+        g->id = i;
+        g->depth = node->depth;
+        memcpy(g->key, node->path, CGROUP_PATH_LEN);  // MAX_NAME_LEN == CGROUP_PATH_LEN
+        if (node->has_cpu && node->cpu_sampled) g->cpu_usage = node->cpu_percent;
+        if (node->has_memory) g->rss = (unsigned long)node->memory_current;
+        if (node->has_io && node->io_sampled) {
+            g->read_rate = node->read_rate;
+            g->write_rate = node->write_rate;
+        }
+        g->has_pressure = node->has_pressure;
+        g->memory_pressure = node->memory_pressure;
+        g->mem_usage = total_mem > 0 ? (float)g->rss / total_mem * 100.0f : 0.0f;
+    }
+
+    sibling_sort = sort;
+    return node_groups[0].count > 0 ? emit_tree(0, groups, 0, max_groups) : 0;
+}
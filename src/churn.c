@@ -0,0 +1,147 @@
+#include <limits.h>
+#include "churn.h"
+#include "process_monitor.h"
+
+// What a snapshot keeps of a row: its key and enough to report its exit
+typedef struct {
+    pid_t pid;
+    unsigned long long start_ticks;
+    int row;                    // Index in the rows of the snapshot
+    uid_t uid;
+    float cpu_usage;
+    unsigned long rss;
+    char name[CHURN_NAME_LEN];
+} ChurnEntry;
+
+// Two snapshots, swapped after every update
+static ChurnEntry snapshots[2][MAX_PROCESS];
+static ChurnEntry *previous = snapshots[0];
+static ChurnEntry *current = snapshots[1];
+static int previous_count = 0;
+static pid_t previous_limit = INT_MAX;  // Highest PID the previous snapshot covered
+static bool have_previous = false;
+static double previous_time = 0.0;
+static float previous_uptime = 0.0f;     // Seconds since boot at the previous snapshot
+static ChurnStats last_stats;
+
+static ExitedProcess recent_exits[CHURN_RECENT_EXITS];
+static int exits_head = 0;   // Next slot to write
+static int exits_count = 0;
+
+static int compare_keys(const ChurnEntry *a, const ChurnEntry *b) {
+    if (a->pid != b->pid) return a->pid < b->pid ? -1 : 1;
+    if (a->start_ticks != b->start_ticks) return a->start_ticks < b->start_ticks ? -1 : 1;
+    return 0;
+}
+
+static int compare_entries(const void *a, const void *b) {
+    return compare_keys((const ChurnEntry *)a, (const ChurnEntry *)b);
+}
+
+// The process exited some time after the previous snapshot: like its CPU and
+// memory, its lifetime is the one it was last seen with
+static void record_exit(const ChurnEntry *entry, float last_seen_uptime) {
+    ExitedProcess *rec = &recent_exits[exits_head];
+
+    memset(rec, 0, sizeof(ExitedProcess));
+    rec->pid = entry->pid;
+    snprintf(rec->name, sizeof(rec->name), "%s", entry->name);
+    get_username(entry->uid, rec->user, sizeof(rec->user));
+    rec->cpu_usage = entry->cpu_usage;
+    rec->rss = entry->rss;
+    rec->exited_at = time(NULL);
+
+    double start_sec = (double)entry->start_ticks / sysconf(_SC_CLK_TCK);
+    rec->lifetime = last_seen_uptime > start_sec ? (float)(last_seen_uptime - start_sec) : 0.0f;
+
+    exits_head = (exits_head + 1) % CHURN_RECENT_EXITS;
+    if (exits_count < CHURN_RECENT_EXITS) exits_count++;
+}
+
+void churn_update(ProcessInfo rows[], int count, float uptime) {
+    if (!rows || count < 0) return;
+    if (count > MAX_PROCESS) count = MAX_PROCESS;
+
+    bool sorted = true;
+    for (int i = 0; i < count; i++) {
+        ChurnEntry *entry = &current[i];
+        const ProcessInfo *p = &rows[i];
+        rows[i].is_new = false;
+        entry->pid = p->pid;
+        entry->start_ticks = p->start_ticks;
+        entry->row = i;
+        entry->uid = p->uid;
+        entry->cpu_usage = p->cpu_usage;
+        entry->rss = p->rss;
+        snprintf(entry->name, sizeof(entry->name), "%.*s", CHURN_NAME_LEN - 1, p->name);
+        if (i > 0 && sorted && compare_keys(&current[i - 1], entry) > 0) sorted = false;
+    }
+    // readdir() lists /proc in PID order, so this is usually skipped
+    if (!sorted) qsort(current, count, sizeof(ChurnEntry), compare_entries);
+
+    // A full table means the scan stopped early: it only covered PIDs up to its last one
+    pid_t limit = (count >= MAX_PROCESS) ? current[count - 1].pid : INT_MAX;
+    pid_t common = limit < previous_limit ? limit : previous_limit;
+
+    double now = monotonic_seconds();
+    memset(&last_stats, 0, sizeof(last_stats));
+    if (have_previous) {
+        int i = 0, j = 0;
+        while (i < previous_count || j < count) {
+            int order = (i >= previous_count) ? 1 :
+                        (j >= count) ? -1 : compare_keys(&previous[i], &current[j]);
+            if (order < 0) {
+                if (previous[i].pid <= common) {
+                    record_exit(&previous[i], previous_uptime);
+                    last_stats.exited++;
+                }
+                i++;
+            } else if (order > 0) {
+                if (current[j].pid <= common) {
+                    rows[current[j].row].is_new = true;
+                    last_stats.started++;
+                }
+                j++;
+            } else {
+                i++;
+                j++;
+            }
+        }
+        double elapsed = now - previous_time;
+        if (elapsed > 0.0) {
+            last_stats.start_rate = (float)(last_stats.started / elapsed);
+            last_stats.exit_rate = (float)(last_stats.exited / elapsed);
+        }
+        last_stats.valid = true;
+    }
+
+    ChurnEntry *swap = previous;
+    previous = current;
+    current = swap;
+    previous_count = count;
+    previous_limit = limit;
+    previous_time = now;
+    previous_uptime = uptime;
+    have_previous = true;
+}
+
+void churn_reset(void) {
+    have_previous = false;
+    previous_count = 0;
+    previous_limit = INT_MAX;
+    memset(&last_stats, 0, sizeof(last_stats));
+}
+
+ChurnStats churn_stats(void) {
+    return last_stats;
+}
+
+int churn_recent_exits(ExitedProcess list[]) {
+    if (!list) return 0;
+
+    for (int i = 0; i < exits_count; i++) {
+        int slot = (exits_head - 1 - i + CHURN_RECENT_EXITS) % CHURN_RECENT_EXITS;
+        list[i] = recent_exits[slot];
+    }
+    return exits_count;
+}
@@ -31,6 +31,28 @@ void config_set_defaults(void) {
     global_config.default_sort = DEFAULT_SORT_BY;
     global_config.show_tree_view = DEFAULT_SHOW_TREE;
     global_config.theme = THEME_DEFAULT;
+    global_config.cpu_budget = DEFAULT_CPU_BUDGET;
+    global_config.min_refresh_interval = DEFAULT_MIN_REFRESH_INTERVAL;
+    global_config.max_refresh_interval = DEFAULT_MAX_REFRESH_INTERVAL;
+    global_config.proc_events = DEFAULT_PROC_EVENTS;
+    global_config.event_rescan_interval = DEFAULT_EVENT_RESCAN_INTERVAL;
+    snprintf(global_config.data_source, sizeof(global_config.data_source), "%s", DEFAULT_DATA_SOURCE);
+    global_config.show_io_columns = DEFAULT_SHOW_IO_COLUMNS;
+    global_config.show_pss_columns = DEFAULT_SHOW_PSS_COLUMNS;
+    global_config.hide_kernel_threads = DEFAULT_HIDE_KERNEL_THREADS;
+    global_config.show_socket_columns = DEFAULT_SHOW_SOCKET_COLUMNS;
+    global_config.show_sched_columns = DEFAULT_SHOW_SCHED_COLUMNS;
+    global_config.watch_interval_ms = DEFAULT_WATCH_INTERVAL_MS;
+    global_config.shm_snapshot = DEFAULT_SHM_SNAPSHOT;
+    global_config.history = DEFAULT_HISTORY;
+    global_config.history_dir[0] = '\0';
+    global_config.history_max_mb = DEFAULT_HISTORY_MAX_MB;
+    global_config.exporter_port = DEFAULT_EXPORTER_PORT;
+    global_config.exporter_top = DEFAULT_EXPORTER_TOP;
+    global_config.alert_rule_count = 0;
+    global_config.alert_hook[0] = '\0';
+    global_config.alert_log[0] = '\0';
+    global_config.alert_budget_ms = DEFAULT_ALERT_BUDGET_MS;
     
     // Default custom colors (ANSI codes)
     global_config.custom_colors.running = 32;    // Green
@@ -89,7 +111,7 @@ void config_load(const char *filename) {
         return;
     }
     
-    char line[256];
+    char line[512];
     while (fgets(line, sizeof(line), file)) {
         // Skip comments and empty lines
         if (line[0] == '#' || line[0] == '\n') {
@@ -99,6 +121,24 @@ void config_load(const char *filename) {
         // Remove trailing newline
         line[strcspn(line, "\n")] = 0;
         
+        // Alert rules, commands and paths contain spaces: the value is the rest of the line
+        if (strncmp(line, "alert=", 6) == 0) {
+            if (global_config.alert_rule_count < MAX_ALERT_RULES) {
+                snprintf(global_config.alert_rules[global_config.alert_rule_count++],
+                         ALERT_RULE_LEN, "%.255s", line + 6);
+            }
+            continue;
+        } else if (strncmp(line, "alert_hook=", 11) == 0) {
+            snprintf(global_config.alert_hook, sizeof(global_config.alert_hook), "%.255s", line + 11);
+            continue;
+        } else if (strncmp(line, "alert_log=", 10) == 0) {
+            snprintf(global_config.alert_log, sizeof(global_config.alert_log), "%.255s", line + 10);
+            continue;
+        } else if (strncmp(line, "history_dir=", 12) == 0) {
+            snprintf(global_config.history_dir, sizeof(global_config.history_dir), "%.255s", line + 12);
+            continue;
+        }
+        
         // Parse key=value pairs
         char key[64], value[64];
         if (sscanf(line, "%63[^=]=%63s", key, value) == 2) {
@@ -110,6 +150,30 @@ void config_load(const char *filename) {
                 global_config.default_sort = value[0];
             } else if (strcmp(key, "show_tree_view") == 0) {
                 global_config.show_tree_view = (strcmp(value, "true") == 0);
+            } else if (strcmp(key, "show_io_columns") == 0) {
+                global_config.show_io_columns = (strcmp(value, "true") == 0);
+            } else if (strcmp(key, "show_pss_columns") == 0) {
+                global_config.show_pss_columns = (strcmp(value, "true") == 0);
+            } else if (strcmp(key, "hide_kernel_threads") == 0) {
+                global_config.hide_kernel_threads = (strcmp(value, "true") == 0);
+            } else if (strcmp(key, "show_socket_columns") == 0) {
+                global_config.show_socket_columns = (strcmp(value, "true") == 0);
+            } else if (strcmp(key, "show_sched_columns") == 0) {
+                global_config.show_sched_columns = (strcmp(value, "true") == 0);
+            } else if (strcmp(key, "watch_interval_ms") == 0) {
+                global_config.watch_interval_ms = atoi(value);
+            } else if (strcmp(key, "shm_snapshot") == 0) {
+                global_config.shm_snapshot = (strcmp(value, "true") == 0);
+            } else if (strcmp(key, "history") == 0) {
+                global_config.history = (strcmp(value, "true") == 0);
+            } else if (strcmp(key, "history_max_mb") == 0) {
+                global_config.history_max_mb = atoi(value);
+            } else if (strcmp(key, "exporter_port") == 0) {
+                global_config.exporter_port = atoi(value);
+            } else if (strcmp(key, "exporter_top") == 0) {
+                global_config.exporter_top = atoi(value);
+            } else if (strcmp(key, "alert_budget_ms") == 0) {
+                global_config.alert_budget_ms = atoi(value);
             } else if (strcmp(key, "theme") == 0) {
                 if (strcmp(value, "dark") == 0) {
                     config_apply_theme(THEME_DARK);
@@ -120,6 +184,18 @@ void config_load(const char *filename) {
                 } else if (strcmp(value, "custom") == 0) {
                     global_config.theme = THEME_CUSTOM;
                 }
+            } else if (strcmp(key, "cpu_budget") == 0) {
+                global_config.cpu_budget = (float)atof(value);
+            } else if (strcmp(key, "min_refresh_interval") == 0) {
+                global_config.min_refresh_interval = atoi(value);
+            } else if (strcmp(key, "max_refresh_interval") == 0) {
+                global_config.max_refresh_interval = atoi(value);
+            } else if (strcmp(key, "proc_events") == 0) {
+                global_config.proc_events = (strcmp(value, "true") == 0);
+            } else if (strcmp(key, "event_rescan_interval") == 0) {
+                global_config.event_rescan_interval = atoi(value);
+            } else if (strcmp(key, "data_source") == 0) {
+                snprintf(global_config.data_source, sizeof(global_config.data_source), "%.15s", value);
             } else if (strcmp(key, "color_running") == 0) {
                 global_config.custom_colors.running = atoi(value);
             } else if (strcmp(key, "color_sleeping") == 0) {
@@ -152,6 +228,21 @@ void config_save(const char *filename) {
     fprintf(file, "# Refresh interval in seconds (1-10)\n");
     fprintf(file, "refresh_interval=%d\n\n", global_config.refresh_interval);
     
+    fprintf(file, "# Self CPU budget in percent; adapts the refresh rate to scan cost (0 = off)\n");
+    fprintf(file, "cpu_budget=%.2f\n\n", global_config.cpu_budget);
+    
+    fprintf(file, "# Bounds for the adaptive refresh interval in seconds\n");
+    fprintf(file, "min_refresh_interval=%d\n", global_config.min_refresh_interval);
+    fprintf(file, "max_refresh_interval=%d\n\n", global_config.max_refresh_interval);
+    
+    fprintf(file, "# Track process start/exit through the kernel proc connector (needs CAP_NET_ADMIN)\n");
+    fprintf(file, "proc_events=%s\n", global_config.proc_events ? "true" : "false");
+    fprintf(file, "# Full /proc rescan period in seconds while proc_events is active\n");
+    fprintf(file, "event_rescan_interval=%d\n\n", global_config.event_rescan_interval);
+    
+    fprintf(file, "# Scanner data source: auto (fastest available), procfs, taskstats, io_uring\n");
+    fprintf(file, "data_source=%s\n\n", global_config.data_source);
+    
     fprintf(file, "# Number of visible processes (10-100)\n");
     fprintf(file, "visible_processes=%d\n\n", global_config.visible_processes);
     
@@ -161,6 +252,54 @@ void config_save(const char *filename) {
     fprintf(file, "# Show process tree view: true or false\n");
     fprintf(file, "show_tree_view=%s\n\n", global_config.show_tree_view ? "true" : "false");
     
+    fprintf(file, "# Show per-process I/O rate columns and disk throughput: true or false\n");
+    fprintf(file, "show_io_columns=%s\n\n", global_config.show_io_columns ? "true" : "false");
+    
+    fprintf(file, "# Show PSS/USS/swap columns from smaps_rollup: true or false\n");
+    fprintf(file, "show_pss_columns=%s\n\n", global_config.show_pss_columns ? "true" : "false");
+    
+    fprintf(file, "# Show socket and TCP connection count columns: true or false\n");
+    fprintf(file, "show_socket_columns=%s\n\n", global_config.show_socket_columns ? "true" : "false");
+    
+    fprintf(file, "# Show run-queue wait, context switch and page fault rate columns: true or false\n");
+    fprintf(file, "show_sched_columns=%s\n\n", global_config.show_sched_columns ? "true" : "false");
+    
+    fprintf(file, "# Watch mode sampling period in milliseconds (10-100)\n");
+    fprintf(file, "watch_interval_ms=%d\n\n", global_config.watch_interval_ms);
+    
+    fprintf(file, "# Hide kernel threads (known ones are skipped without reading /proc): true or false\n");
+    fprintf(file, "hide_kernel_threads=%s\n\n", global_config.hide_kernel_threads ? "true" : "false");
+    
+    fprintf(file, "# Publish each scan to shared memory for other tools: true or false\n");
+    fprintf(file, "shm_snapshot=%s\n\n", global_config.shm_snapshot ? "true" : "false");
+    
+    fprintf(file, "# Record refreshes into the on-disk history (view with --history-range): true or false\n");
+    fprintf(file, "history=%s\n", global_config.history ? "true" : "false");
+    fprintf(file, "# History directory (empty = ~/.alttasker-history)\n");
+    fprintf(file, "history_dir=%s\n", global_config.history_dir);
+    fprintf(file, "# Disk space of the history in MiB (1s, 1m and 1h resolutions together)\n");
+    fprintf(file, "history_max_mb=%d\n\n", global_config.history_max_mb);
+    
+    fprintf(file, "# Prometheus /metrics port for --daemon on 127.0.0.1 (0 = off)\n");
+    fprintf(file, "exporter_port=%d\n\n", global_config.exporter_port);
+    
+    fprintf(file, "# Processes exported per ranking (top N by CPU and by RSS, max 100)\n");
+    fprintf(file, "exporter_top=%d\n\n", global_config.exporter_top);
+    
+    fprintf(file, "# Alert rules: alert=NAME: CONDITION [for DURATION] [clear CONDITION]\n");
+    fprintf(file, "# e.g. alert=bigmem: rss>8G for 30s clear rss<7G\n");
+    fprintf(file, "#      alert=zombies: count(state=Z)>50\n");
+    fprintf(file, "#      alert=memory: system.mem>90 for 1m clear system.mem<85\n");
+    for (int i = 0; i < global_config.alert_rule_count; i++) {
+        fprintf(file, "alert=%s\n", global_config.alert_rules[i]);
+    }
+    fprintf(file, "# Command run on alert state changes (ALERT_NAME, ALERT_STATE, ALERT_PID, ALERT_VALUE)\n");
+    fprintf(file, "alert_hook=%s\n", global_config.alert_hook);
+    fprintf(file, "# File alert state changes are appended to (empty = no log)\n");
+    fprintf(file, "alert_log=%s\n", global_config.alert_log);
+    fprintf(file, "# Rule evaluation time per refresh in milliseconds (0 = unlimited)\n");
+    fprintf(file, "alert_budget_ms=%d\n\n", global_config.alert_budget_ms);
+    
     fprintf(file, "# Color theme: default, dark, light, colorblind, custom\n");
     const char *theme_name = "default";
     switch (global_config.theme) {
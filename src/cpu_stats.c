@@ -0,0 +1,187 @@
+#define _POSIX_C_SOURCE 200809L
+#include <fcntl.h>
+#include "cpu_stats.h"
+
+// Room per "cpuN ..." line of /proc/stat (ten 20-digit counters fit)
+#define STAT_LINE_BYTES 256
+
+// Jiffies of one CPU line, grouped like CpuShare
+typedef struct {
+    unsigned long long user, system, iowait, steal, total;
+} CpuTicks;
+
+typedef struct {
+    const char *path;
+    int fd;             // -1 = not opened yet, -2 = unavailable
+} StatFile;
+
+enum { FILE_STAT, FILE_LOADAVG, FILE_PSI_CPU, FILE_PSI_MEMORY, FILE_PSI_IO, FILE_COUNT };
+
+static StatFile files[FILE_COUNT] = {
+    { "/proc/stat", -1 },
+    { "/proc/loadavg", -1 },
+    { "/proc/pressure/cpu", -1 },
+    { "/proc/pressure/memory", -1 },
+    { "/proc/pressure/io", -1 },
+};
+
+static char *stat_buffer = NULL;
+static size_t stat_size = 0;
+static CpuTicks prev_ticks[MAX_CPUS + 1];   // [0] = aggregate, [n + 1] = cpu n
+static bool prev_online[MAX_CPUS + 1];
+static bool sampled = false;
+
+// Reads a whole file from offset 0 with one pread(); returns the length or -1
+static int read_file(StatFile *file, char *buffer, size_t size) {
+    if (file->fd == -2) return -1;
+    if (file->fd == -1) {
+        file->fd = open(file->path, O_RDONLY | O_CLOEXEC);
+        if (file->fd < 0) {
+            file->fd = -2;
+            return -1;
+        }
+    }
+
+    ssize_t len = pread(file->fd, buffer, size - 1, 0);
+    if (len < 0) return -1;
+
+    buffer[len] = '\0';
+    return (int)len;
+}
+
+// Parses the counters after "cpu" / "cpuN"
+static const char* parse_ticks(const char *p, CpuTicks *ticks) {
+    unsigned long long value[8] = {0};  // user nice system idle iowait irq softirq steal
+    char *end;
+    for (int i = 0; i < 8; i++) {
+        value[i] = strtoull(p, &end, 10);
+        if (end == p) break;
+        p = end;
+    }
+
+    ticks->user = value[0] + value[1];
+    ticks->system = value[2] + value[5] + value[6];
+    ticks->iowait = value[4];
+    ticks->steal = value[7];
+    // guest time is already part of user, so it is not added again
+    ticks->total = ticks->user + ticks->system + value[3] + ticks->iowait + ticks->steal;
+    return p;
+}
+
+static float share_of(unsigned long long now, unsigned long long before, unsigned long long total) {
+    if (total == 0 || now < before) return 0.0f;
+    return (float)(now - before) * 100.0f / (float)total;
+}
+
+static void compute_share(const CpuTicks *now, const CpuTicks *before, CpuShare *share) {
+    unsigned long long total = (now->total > before->total) ? now->total - before->total : 0;
+    share->user = share_of(now->user, before->user, total);
+    share->system = share_of(now->system, before->system, total);
+    share->iowait = share_of(now->iowait, before->iowait, total);
+    share->steal = share_of(now->steal, before->steal, total);
+}
+
+static void sample_stat(CpuStats *stats) {
+    if (!stat_buffer) {
+        // Only the cpu lines at the top are needed, the interrupt counters
+        // that follow may be cut off
+        long configured = sysconf(_SC_NPROCESSORS_CONF);
+        if (configured < 1) configured = 1;
+        if (configured > MAX_CPUS) configured = MAX_CPUS;
+        stat_size = (size_t)(configured + 2) * STAT_LINE_BYTES;
+        stat_buffer = malloc(stat_size);
+        if (!stat_buffer) return;
+    }
+    if (read_file(&files[FILE_STAT], stat_buffer, stat_size) <= 0) return;
+
+    CpuTicks ticks[MAX_CPUS + 1];
+    bool online[MAX_CPUS + 1] = { false };
+
+    const char *p = stat_buffer;
+    while (strncmp(p, "cpu", 3) == 0) {
+        p += 3;
+        int slot = 0;
+        if (*p != ' ') {
+            char *end;
+            long cpu = strtol(p, &end, 10);
+            if (end == p || cpu < 0 || cpu >= MAX_CPUS) break;
+            slot = (int)cpu + 1;
+            p = end;
+        }
+        p = parse_ticks(p, &ticks[slot]);
+        online[slot] = true;
+        if (slot > stats->cpu_count) stats->cpu_count = slot;
+
+        p = strchr(p, '\n');
+        if (!p) break;
+        p++;
+    }
+
+    if (sampled && online[0] && prev_online[0]) {
+        compute_share(&ticks[0], &prev_ticks[0], &stats->total);
+        for (int cpu = 0; cpu < stats->cpu_count; cpu++) {
+            // A CPU that just came online has no previous sample
+            stats->online[cpu] = online[cpu + 1];
+            if (online[cpu + 1] && prev_online[cpu + 1]) {
+                compute_share(&ticks[cpu + 1], &prev_ticks[cpu + 1], &stats->cores[cpu]);
+            }
+        }
+        stats->valid = true;
+    }
+
+    memcpy(prev_ticks, ticks, sizeof(prev_ticks));
+    memcpy(prev_online, online, sizeof(prev_online));
+    sampled = true;
+}
+
+// Parses "some avg10=0.00 avg60=0.00 avg300=0.00 total=0" style lines
+static void parse_pressure(const char *buffer, PressureAverages *some, PressureAverages *full) {
+    const char *line = strstr(buffer, "some ");
+    if (line && some) {
+        sscanf(line, "some avg10=%f avg60=%f avg300=%f", &some->avg10, &some->avg60, &some->avg300);
+    }
+    line = strstr(buffer, "full ");
+    if (line && full) {
+        sscanf(line, "full avg10=%f avg60=%f avg300=%f", &full->avg10, &full->avg60, &full->avg300);
+    }
+}
+
+void cpu_stats_sample(CpuStats *stats) {
+    if (!stats) return;
+
+    memset(stats, 0, sizeof(CpuStats));
+    sample_stat(stats);
+
+    char buffer[BUFFER_SIZE];
+    if (read_file(&files[FILE_LOADAVG], buffer, sizeof(buffer)) > 0) {
+        sscanf(buffer, "%f %f %f", &stats->load[0], &stats->load[1], &stats->load[2]);
+    }
+
+    // The "full" line of cpu only exists for cgroups, so it is not read here
+    if (read_file(&files[FILE_PSI_CPU], buffer, sizeof(buffer)) > 0) {
+        parse_pressure(buffer, &stats->cpu_some, NULL);
+        stats->has_pressure = true;
+    }
+    if (read_file(&files[FILE_PSI_MEMORY], buffer, sizeof(buffer)) > 0) {
+        parse_pressure(buffer, &stats->memory_some, &stats->memory_full);
+    }
+    if (read_file(&files[FILE_PSI_IO], buffer, sizeof(buffer)) > 0) {
+        parse_pressure(buffer, &stats->io_some, &stats->io_full);
+    }
+}
+
+float cpu_share_busy(const CpuShare *share) {
+    if (!share) return 0.0f;
+    float busy = share->user + share->system + share->iowait + share->steal;
+    return busy > 100.0f ? 100.0f : busy;
+}
+
+void cpu_stats_close(void) {
+    for (int i = 0; i < FILE_COUNT; i++) {
+        if (files[i].fd >= 0) close(files[i].fd);
+        files[i].fd = -1;
+    }
+    free(stat_buffer);
+    stat_buffer = NULL;
+    sampled = false;
+}
@@ -0,0 +1,94 @@
+#include <limits.h>
+#include "cursor.h"
+
+// PID -> row index of the last located list (-1 = empty slot)
+static int row_slots[CURSOR_TABLE_SIZE];
+static const ProcessInfo *indexed_rows = NULL;
+static int indexed_count = 0;
+
+static unsigned int hash_pid(pid_t pid) {
+    return (unsigned int)pid * 2654435761u;
+}
+
+static void build_index(const ProcessInfo rows[], int count) {
+    for (int s = 0; s < CURSOR_TABLE_SIZE; s++) row_slots[s] = -1;
+    // Never fill the table completely, lookups stop at an empty slot
+    if (count > CURSOR_TABLE_SIZE / 2) count = CURSOR_TABLE_SIZE / 2;
+    for (int i = 0; i < count; i++) {
+        unsigned int slot = hash_pid(rows[i].pid) & (CURSOR_TABLE_SIZE - 1);
+        while (row_slots[slot] >= 0) slot = (slot + 1) & (CURSOR_TABLE_SIZE - 1);
+        row_slots[slot] = i;
+    }
+    indexed_rows = rows;
+    indexed_count = count;
+}
+
+// An expanded main thread has the PID of its process: is_thread tells them apart
+static int find_row(pid_t pid, bool is_thread) {
+    if (!indexed_rows) return -1;
+    unsigned int slot = hash_pid(pid) & (CURSOR_TABLE_SIZE - 1);
+    while (row_slots[slot] >= 0) {
+        const ProcessInfo *p = &indexed_rows[row_slots[slot]];
+        if (p->pid == pid && p->is_thread == is_thread) return row_slots[slot];
+        slot = (slot + 1) & (CURSOR_TABLE_SIZE - 1);
+    }
+    return -1;
+}
+
+int cursor_find(pid_t pid) {
+    return find_row(pid, false);
+}
+
+static void bind(Cursor *cursor, const ProcessInfo rows[], int row) {
+    cursor->row = row;
+    cursor->pid = rows[row].pid;
+    cursor->start_ticks = rows[row].start_ticks;
+    cursor->is_thread = rows[row].is_thread;
+}
+
+int cursor_locate(Cursor *cursor, const ProcessInfo rows[], int count) {
+    if (!cursor) return -1;
+    build_index(rows, count > 0 ? count : 0);
+    if (!rows || count <= 0) {
+        cursor->row = -1;
+        return -1;
+    }
+
+    int row = cursor->pid > 0 ? find_row(cursor->pid, cursor->is_thread) : -1;
+    if (row >= 0 && rows[row].start_ticks == cursor->start_ticks) {
+        cursor->row = row;
+        return row;
+    }
+
+    // Gone: keep the position instead of jumping back to the top
+    row = cursor->row;
+    if (row < 0) row = 0;
+    if (row >= count) row = count - 1;
+    bind(cursor, rows, row);
+    return row;
+}
+
+void cursor_move(Cursor *cursor, const ProcessInfo rows[], int count, int delta) {
+    if (!cursor || !rows || count <= 0) return;
+    long row = (long)cursor->row;
+    if (delta == INT_MIN) {
+        row = 0;
+    } else if (delta == INT_MAX) {
+        row = count - 1;
+    } else {
+        row += delta;
+    }
+    if (row < 0) row = 0;
+    if (row >= count) row = count - 1;
+    bind(cursor, rows, (int)row);
+}
+
+void cursor_follow(const Cursor *cursor, int *scroll_offset, int visible, int count) {
+    if (!cursor || !scroll_offset || visible <= 0) return;
+    if (cursor->row >= 0) {
+        if (cursor->row < *scroll_offset) *scroll_offset = cursor->row;
+        if (cursor->row >= *scroll_offset + visible) *scroll_offset = cursor->row - visible + 1;
+    }
+    if (*scroll_offset > count - visible) *scroll_offset = count - visible;
+    if (*scroll_offset < 0) *scroll_offset = 0;
+}
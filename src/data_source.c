@@ -0,0 +1,116 @@
+#define _POSIX_C_SOURCE 200809L
+#include "data_source.h"
+#include "process_monitor.h"
+
+// Number of processes timed per backend when auto-selecting
+#define SELECT_SAMPLE_SIZE 64
+
+static int procfs_open(void) {
+    return 0;  // /proc is always there
+}
+
+static void procfs_close(void) {
+}
+
+const DataSource procfs_source = {
+    .name = "procfs",
+    .open = procfs_open,
+    .read = get_process_info,
+    .close = procfs_close,
+};
+
+static const DataSource *const sources[] = {
+    &procfs_source,
+    &taskstats_source,
+    &uring_source,
+};
+
+static const DataSource *current = &procfs_source;
+
+const DataSource* const* data_source_list(int *count) {
+    if (count) *count = (int)(sizeof(sources) / sizeof(sources[0]));
+    return sources;
+}
+
+const DataSource* data_source_current(void) {
+    return current;
+}
+
+// Collects up to 'max' PIDs from /proc for timing
+static int sample_pids(pid_t pids[], int max) {
+    DIR *proc_dir = opendir(PROC_DIR);
+    if (!proc_dir) return 0;
+
+    int count = 0;
+    struct dirent *entry;
+    while ((entry = readdir(proc_dir)) != NULL && count < max) {
+        if (is_pid(entry->d_name)) {
+            pids[count++] = (pid_t)atoi(entry->d_name);
+        }
+    }
+    closedir(proc_dir);
+    return count;
+}
+
+// Average wall time per process read, in seconds
+static double time_source(const DataSource *source, const pid_t pids[], int count) {
+    static ProcessInfo rows[SELECT_SAMPLE_SIZE];
+    int ok = 0;
+
+    double start = monotonic_seconds();
+    if (source->read_batch) {
+        ok = source->read_batch(pids, count, rows, 0, 0);
+    } else {
+        for (int i = 0; i < count; i++) {
+            if (source->read(pids[i], &rows[0], 0, 0) == 0) ok++;
+        }
+    }
+    double elapsed = monotonic_seconds() - start;
+
+    return ok > 0 ? elapsed / ok : -1.0;
+}
+
+const DataSource* data_source_select(const char *name) {
+    int count = 0;
+    const DataSource *const *list = data_source_list(&count);
+
+    data_source_shutdown();
+
+    // Explicit choice
+    if (name && strcmp(name, "auto") != 0) {
+        for (int i = 0; i < count; i++) {
+            if (strcmp(list[i]->name, name) == 0 && list[i]->open() == 0) {
+                current = list[i];
+                return current;
+            }
+        }
+        return current;  // Unknown or unavailable: stay on procfs
+    }
+
+    // Auto: time every available backend on the same PIDs, keep the fastest
+    pid_t pids[SELECT_SAMPLE_SIZE];
+    int sampled = sample_pids(pids, SELECT_SAMPLE_SIZE);
+    double best_cost = time_source(&procfs_source, pids, sampled);
+
+    for (int i = 0; i < count; i++) {
+        if (list[i] == &procfs_source || list[i]->open() != 0) continue;
+
+        double cost = time_source(list[i], pids, sampled);
+        if (cost > 0.0 && (best_cost < 0.0 || cost < best_cost)) {
+            if (current != &procfs_source) current->close();
+            current = list[i];
+            best_cost = cost;
+        } else {
+            list[i]->close();
+        }
+    }
+
+    return current;
+}
+
+void data_source_shutdown(void) {
+    if (current != &procfs_source) {
+        current->close();
+    }
+    current = &procfs_source;
+}
@@ -0,0 +1,345 @@
+#define _POSIX_C_SOURCE 200809L
+#include <pthread.h>
+#include <dirent.h>
+#include <unistd.h>
+#include "detail.h"
+
+// Entries between two checks whether the selection moved on
+#define DETAIL_CHUNK 4096
+
+static pthread_t reader;
+static bool reader_running = false;
+static pthread_mutex_t detail_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t detail_wake = PTHREAD_COND_INITIALIZER;
+
+// Shared with the reader, guarded by detail_lock
+static ProcessDetail published;         // What the pane shows
+static bool published_changed = false;
+static pid_t wanted_pid = 0;
+static unsigned long long wanted_start = 0;
+static unsigned int wanted_seq = 0;     // Bumped on every new selection
+static bool stopping = false;
+
+// True if the read for selection 'seq' should be abandoned
+static bool abandoned(unsigned int seq) {
+    pthread_mutex_lock(&detail_lock);
+    bool result = stopping || wanted_seq != seq;
+    pthread_mutex_unlock(&detail_lock);
+    return result;
+}
+
+// Makes 'work' visible to the UI unless the selection moved on meanwhile
+static void publish(const ProcessDetail *work, unsigned int seq) {
+    pthread_mutex_lock(&detail_lock);
+    if (!stopping && wanted_seq == seq) {
+        published = *work;
+        published_changed = true;
+    }
+    pthread_mutex_unlock(&detail_lock);
+}
+
+// Start time (field 22 of /proc/[pid]/stat), 0 if the process is gone
+static unsigned long long read_start_ticks(pid_t pid) {
+    char path[64];
+    char buffer[1024];
+    snprintf(path, sizeof(path), "/proc/%d/stat", pid);
+    FILE *fp = fopen(path, "r");
+    if (!fp) return 0;
+    size_t len = fread(buffer, 1, sizeof(buffer) - 1, fp);
+    fclose(fp);
+    buffer[len] = '\0';
+
+    // The name may contain spaces and ')', so count fields after the last ')'
+    const char *p = strrchr(buffer, ')');
+    if (!p) return 0;
+    int field = 2;
+    for (p++; *p && field < 22; p++) {
+        if (*p == ' ') field++;
+    }
+    return strtoull(p, NULL, 10);
+}
+
+static bool read_link(pid_t pid, const char *name, char *buffer, size_t size) {
+    char path[64];
+    snprintf(path, sizeof(path), "/proc/%d/%s", pid, name);
+    ssize_t len = readlink(path, buffer, size - 1);
+    if (len < 0) {
+        buffer[0] = '\0';
+        return false;
+    }
+    buffer[len] = '\0';
+    return true;
+}
+
+static FILE* open_proc(pid_t pid, const char *name) {
+    char path[64];
+    snprintf(path, sizeof(path), "/proc/%d/%s", pid, name);
+    return fopen(path, "r");
+}
+
+static bool read_cgroup(pid_t pid, ProcessDetail *work) {
+    FILE *fp = open_proc(pid, "cgroup");
+    if (!fp) return false;
+    char line[DETAIL_PATH_LEN + 8];
+    bool found = false;
+    while (fgets(line, sizeof(line), fp)) {
+        if (strncmp(line, "0::", 3) == 0) {
+            line[strcspn(line, "\n")] = '\0';
+            snprintf(work->cgroup, sizeof(work->cgroup), "%.*s", (int)sizeof(work->cgroup) - 1, line + 3);
+            found = true;
+            break;
+        }
+    }
+    fclose(fp);
+    return found;
+}
+
+// environ can be large, so it is counted in chunks without being stored
+static bool read_environ(pid_t pid, ProcessDetail *work, unsigned int seq) {
+    FILE *fp = open_proc(pid, "environ");
+    if (!fp) return false;
+    char chunk[65536];
+    size_t len;
+    work->env_vars = 0;
+    work->env_bytes = 0;
+    char last = '\0';
+    while ((len = fread(chunk, 1, sizeof(chunk), fp)) > 0) {
+        for (size_t i = 0; i < len; i++) {
+            if (chunk[i] == '\0') work->env_vars++;
+        }
+        work->env_bytes += len;
+        last = chunk[len - 1];
+        if (abandoned(seq)) break;
+    }
+    if (work->env_bytes > 0 && last != '\0') work->env_vars++;  // Unterminated last variable
+    bool ok = !ferror(fp);
+    fclose(fp);
+    return ok;
+}
+
+static unsigned long long parse_limit(const char *text) {
+    while (*text == ' ') text++;
+    if (strncmp(text, "unlimited", 9) == 0) return DETAIL_UNLIMITED;
+    return strtoull(text, NULL, 10);
+}
+
+// /proc/[pid]/limits: a fixed-width table, values start at column 26
+static bool read_limits(pid_t pid, ProcessDetail *work) {
+    FILE *fp = open_proc(pid, "limits");
+    if (!fp) return false;
+    char line[256];
+    while (fgets(line, sizeof(line), fp)) {
+        if (strlen(line) < 26) continue;
+        const char *values = line + 25;
+        if (strncmp(line, "Max open files", 14) == 0) {
+            work->nofile_soft = parse_limit(values);
+            while (*values == ' ') values++;
+            values += strcspn(values, " ");
+            work->nofile_hard = parse_limit(values);
+        } else if (strncmp(line, "Max address space", 17) == 0) {
+            work->as_soft = parse_limit(values);
+        } else if (strncmp(line, "Max processes", 13) == 0) {
+            work->nproc_soft = parse_limit(values);
+        }
+    }
+    fclose(fp);
+    return true;
+}
+
+static bool read_fds(pid_t pid, ProcessDetail *work, unsigned int seq) {
+    char path[64];
+    snprintf(path, sizeof(path), "/proc/%d/fd", pid);
+    DIR *dir = opendir(path);
+    if (!dir) return false;
+    struct dirent *entry;
+    int count = 0;
+    while ((entry = readdir(dir)) != NULL) {
+        if (entry->d_name[0] == '.') continue;
+        if (++count % DETAIL_CHUNK == 0 && abandoned(seq)) break;
+    }
+    closedir(dir);
+    work->fd_count = count;
+    return true;
+}
+
+static bool read_maps(pid_t pid, ProcessDetail *work, unsigned int seq) {
+    FILE *fp = open_proc(pid, "maps");
+    if (!fp) return false;
+    char line[512];
+    work->map_count = 0;
+    work->file_maps = 0;
+    work->file_bytes = 0;
+    work->anon_bytes = 0;
+    while (fgets(line, sizeof(line), fp)) {
+        unsigned long start, end, inode;
+        if (sscanf(line, "%lx-%lx %*s %*s %*s %lu", &start, &end, &inode) == 3) {
+            work->map_count++;
+            if (inode != 0) {
+                work->file_maps++;
+                work->file_bytes += end - start;
+            } else {
+                work->anon_bytes += end - start;
+            }
+            if (work->map_count % DETAIL_CHUNK == 0 && abandoned(seq)) break;
+        }
+        // Skip the rest of an overlong path
+        while (!strchr(line, '\n') && fgets(line, sizeof(line), fp)) {}
+    }
+    fclose(fp);
+    return true;
+}
+
+static bool read_smaps(pid_t pid, ProcessDetail *work) {
+    FILE *fp = open_proc(pid, "smaps_rollup");
+    if (!fp) return false;
+    char line[256];
+    unsigned long kb;
+    unsigned long private_kb = 0;
+    bool found = false;
+    while (fgets(line, sizeof(line), fp)) {
+        if (sscanf(line, "Rss: %lu kB", &kb) == 1) {
+            work->rss = kb * 1024;
+            found = true;
+        } else if (sscanf(line, "Pss: %lu kB", &kb) == 1) {
+            work->pss = kb * 1024;
+        } else if (sscanf(line, "Private_Clean: %lu kB", &kb) == 1 ||
+                   sscanf(line, "Private_Dirty: %lu kB", &kb) == 1) {
+            private_kb += kb;
+        } else if (sscanf(line, "Swap: %lu kB", &kb) == 1) {
+            work->swap = kb * 1024;
+        }
+    }
+    fclose(fp);
+    work->uss = private_kb * 1024;
+    return found;  // Kernel threads have an empty rollup
+}
+
+// Reads every section of one process, publishing after each
+static void read_process(pid_t pid, unsigned long long start_ticks, unsigned int seq, bool fresh) {
+    ProcessDetail work;
+    pthread_mutex_lock(&detail_lock);
+    work = published;
+    pthread_mutex_unlock(&detail_lock);
+    if (fresh || work.pid != pid) {
+        memset(&work, 0, sizeof(work));
+        work.pid = pid;
+        work.start_ticks = start_ticks;
+    }
+    work.loading = true;
+    publish(&work, seq);
+
+    if (read_start_ticks(pid) != start_ticks) {
+        // Exited (or the PID was reused): nothing to show
+        work.ready = DETAIL_ALL;
+        work.denied = DETAIL_ALL;
+        work.loading = false;
+        publish(&work, seq);
+        return;
+    }
+
+    for (unsigned int section = DETAIL_PATHS; section & DETAIL_ALL; section <<= 1) {
+        bool ok = false;
+        switch (section) {
+            case DETAIL_PATHS: {
+                bool cwd = read_link(pid, "cwd", work.cwd, sizeof(work.cwd));
+                bool exe = read_link(pid, "exe", work.exe, sizeof(work.exe));
+                ok = cwd || exe;
+                break;
+            }
+            case DETAIL_CGROUP:  ok = read_cgroup(pid, &work); break;
+            case DETAIL_ENVIRON: ok = read_environ(pid, &work, seq); break;
+            case DETAIL_LIMITS:  ok = read_limits(pid, &work); break;
+            case DETAIL_FDS:     ok = read_fds(pid, &work, seq); break;
+            case DETAIL_MAPS:    ok = read_maps(pid, &work, seq); break;
+            case DETAIL_SMAPS:   ok = read_smaps(pid, &work); break;
+        }
+        if (abandoned(seq)) return;
+        work.ready |= section;
+        if (ok) {
+            work.denied &= ~section;
+        } else {
+            work.denied |= section;
+        }
+        publish(&work, seq);
+    }
+
+    work.loading = false;
+    work.updated = time(NULL);
+    publish(&work, seq);
+}
+
+static void* reader_main(void *arg) {
+    (void)arg;
+    unsigned int done_seq = 0;
+    time_t next_read = 0;
+
+    pthread_mutex_lock(&detail_lock);
+    while (!stopping) {
+        if (wanted_pid == 0) {
+            pthread_cond_wait(&detail_wake, &detail_lock);
+            continue;
+        }
+        if (wanted_seq == done_seq && time(NULL) < next_read) {
+            // Same process: re-read at the slower detail cadence
+            struct timespec deadline = { .tv_sec = next_read, .tv_nsec = 0 };
+            pthread_cond_timedwait(&detail_wake, &detail_lock, &deadline);
+            continue;
+        }
+        pid_t pid = wanted_pid;
+        unsigned long long start_ticks = wanted_start;
+        unsigned int seq = wanted_seq;
+        pthread_mutex_unlock(&detail_lock);
+
+        read_process(pid, start_ticks, seq, seq != done_seq);
+        done_seq = seq;
+        next_read = time(NULL) + DETAIL_REFRESH_SECONDS;
+
+        pthread_mutex_lock(&detail_lock);
+    }
+    pthread_mutex_unlock(&detail_lock);
+    return NULL;
+}
+
+int detail_open(void) {
+    if (reader_running) return 0;
+    stopping = false;
+    if (pthread_create(&reader, NULL, reader_main, NULL) != 0) return -1;
+    reader_running = true;
+    return 0;
+}
+
+void detail_select(pid_t pid, unsigned long long start_ticks) {
+    pthread_mutex_lock(&detail_lock);
+    if (pid != wanted_pid || start_ticks != wanted_start) {
+        wanted_pid = pid;
+        wanted_start = start_ticks;
+        wanted_seq++;
+        // Clear the pane right away rather than showing the previous process
+        memset(&published, 0, sizeof(published));
+        published.pid = pid;
+        published.start_ticks = start_ticks;
+        published.loading = pid > 0;
+        published_changed = true;
+        pthread_cond_signal(&detail_wake);
+    }
+    pthread_mutex_unlock(&detail_lock);
+}
+
+bool detail_get(ProcessDetail *detail) {
+    pthread_mutex_lock(&detail_lock);
+    bool changed = published_changed;
+    if (detail) *detail = published;
+    published_changed = false;
+    pthread_mutex_unlock(&detail_lock);
+    return changed;
+}
+
+void detail_close(void) {
+    if (!reader_running) return;
+    pthread_mutex_lock(&detail_lock);
+    stopping = true;
+    pthread_cond_signal(&detail_wake);
+    pthread_mutex_unlock(&detail_lock);
+    pthread_join(reader, NULL);
+    reader_running = false;
+}
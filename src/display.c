@@ -1,7 +1,22 @@
 #include "display.h"
 #include "config.h"
+#include "group.h"
+#include "cpu_stats.h"
+#include "alerts.h"
 
 
+// Prints "Label [■■■···] value  " with a ten-cell bar of part/whole
+static void print_small_bar(const char *label, unsigned long part, unsigned long whole,
+                            const char *value, const char *color) {
+    int filled = whole > 0 ? (int)((double)part / whole * 10.0 + 0.5) : 0;
+    if (filled > 10) filled = 10;
+    printf(COLOR_BOLD "%s" COLOR_RESET " [", label);
+    for (int i = 0; i < 10; i++) {
+        printf(i < filled ? "%s■" COLOR_RESET : "·", color);
+    }
+    printf("] %-9s  ", value);
+}
+
 void display_system_info(const sysinfo_t* sysinfo) {
     if (!sysinfo) return;
 
@@ -26,9 +41,23 @@ void display_system_info(const sysinfo_t* sysinfo) {
     printf("\n");
     
     // System info in a nice format with icons and colors
-    printf(COLOR_BOLD "%s  ⏱️  Uptime: " COLOR_RESET "%s" COLOR_BOLD "%s    |    📊 Processes: " COLOR_RESET COLOR_BOLD "%u\n" COLOR_RESET, 
+    printf(COLOR_BOLD "%s  ⏱️  Uptime: " COLOR_RESET "%s" COLOR_BOLD "%s    |    📊 Processes: " COLOR_RESET COLOR_BOLD "%u" COLOR_RESET, 
            config_get_header_color(), uptime_str, config_get_header_color(), sysinfo->total_processes);
-    printf("\n");
+    // Churn between the last two refreshes
+    if (sysinfo->churn_valid) {
+        printf("  (" COLOR_GREEN "+%.1f/s" COLOR_RESET " started, " COLOR_RED "-%.1f/s" COLOR_RESET " exited)",
+               sysinfo->start_rate, sysinfo->exit_rate);
+    }
+    printf("\n\n");
+    
+    // System-wide disk throughput (sampled only while the I/O columns are shown)
+    if (sysinfo->disk_valid) {
+        char read_str[16], write_str[16];
+        format_rate(sysinfo->disk_read_rate, read_str, sizeof(read_str));
+        format_rate(sysinfo->disk_write_rate, write_str, sizeof(write_str));
+        printf(COLOR_BOLD "%s  💿 Disk: " COLOR_RESET "read %s/s  |  write %s/s\n\n",
+               config_get_header_color(), read_str, write_str);
+    }
     
     // Memory bar with color-coded percentage
     printf(COLOR_BOLD "%s  💾 Memory Usage: " COLOR_RESET, config_get_header_color());
@@ -46,107 +75,316 @@ void display_system_info(const sysinfo_t* sysinfo) {
             printf("░");
         }
     }
-    printf("]\n\n");
+    printf("]\n");
+    
+    // Breakdown: what the "used" figure leaves out, and swap
+    char cached_str[16], shared_str[16], swap_str[16];
+    format_memory(sysinfo->cached_mem, cached_str, sizeof(cached_str));
+    format_memory(sysinfo->shared_mem, shared_str, sizeof(shared_str));
+    format_memory(sysinfo->swap_used, swap_str, sizeof(swap_str));
+    printf("  ");
+    print_small_bar("Cache", sysinfo->cached_mem, sysinfo->total_mem, cached_str, COLOR_BLUE);
+    print_small_bar("Shared", sysinfo->shared_mem, sysinfo->total_mem, shared_str, COLOR_MAGENTA);
+    if (sysinfo->swap_total > 0) {
+        print_small_bar("Swap", sysinfo->swap_used, sysinfo->swap_total, swap_str, COLOR_RED);
+    } else {
+        printf("Swap: none");
+    }
+    printf("\n\n");
 }
 
 
-void display_processes(const ProcessInfo processes[], int count, int scroll_offset, int visible_processes) {
-    if (!processes || count <= 0) return;
+// Draws a 'width'-cell bar split into user/system/iowait/steal segments
+static void print_share_bar(const CpuShare *share, int width) {
+    const float parts[4] = { share->user, share->system, share->iowait, share->steal };
+    const char *colors[4] = { COLOR_GREEN, COLOR_RED, COLOR_BLUE, COLOR_MAGENTA };
 
-    // Table header with better formatting and colors
-    printf(COLOR_BOLD "%s  %-6s %-10s %6s %6s %10s %10s %-5s  %-45s\n" COLOR_RESET,
-           config_get_header_color(), "PID", "USER", "CPU%", "MEM%", "VIRT", "RES", "STATE", "COMMAND");
-    printf("%s  ────── ────────── ────── ────── ────────── ────────── ─────  ─────────────────────────────────────────────\n" COLOR_RESET, config_get_border_color());
-    
-    // Show processes with scrolling support
-    int start_index = scroll_offset;
-    int end_index = (start_index + visible_processes > count) ? count : start_index + visible_processes;
-    int display_count = end_index - start_index;
-    
-    for (int i = 0; i < display_count; i++) {
-        int proc_index = start_index + i;
-        char vsize_str[16];
-        char rss_str[16];
-        char cmdline_short[48];
-        char user_short[11]; // 10 chars + null terminator
+    // Cell boundaries come from the running sum so rounding never overflows
+    int drawn = 0;
+    float sum = 0.0f;
+    for (int i = 0; i < 4; i++) {
+        sum += parts[i];
+        int end = (int)(sum / 100.0f * width + 0.5f);
+        if (end > width) end = width;
+        if (end > drawn) {
+            printf("%s", colors[i]);
+            for (; drawn < end; drawn++) printf("|");
+            printf(COLOR_RESET);
+        }
+    }
+    for (; drawn < width; drawn++) printf(" ");
+}
 
-        format_memory(processes[proc_index].vsize, vsize_str, sizeof(vsize_str));
-        format_memory(processes[proc_index].rss, rss_str, sizeof(rss_str));
-        
-        // Truncate username if too long
-        if (strlen(processes[proc_index].user) > 10) {
-            strncpy(user_short, processes[proc_index].user, 9);
-            user_short[9] = '+';
-            user_short[10] = '\0';
+void display_cpu_meters(const CpuStats *stats) {
+    if (!stats) return;
+
+    if (stats->valid) {
+        printf(COLOR_BOLD "%s  🖥️  CPU: " COLOR_RESET "%5.1f%% [", config_get_header_color(),
+               cpu_share_busy(&stats->total));
+        print_share_bar(&stats->total, 50);
+        printf("] " COLOR_GREEN "usr" COLOR_RESET " " COLOR_RED "sys" COLOR_RESET " "
+               COLOR_BLUE "wait" COLOR_RESET " " COLOR_MAGENTA "steal" COLOR_RESET "\n");
+
+        if (stats->cpu_count <= 32) {
+            // Small machines: four meters per line
+            for (int cpu = 0; cpu < stats->cpu_count; cpu++) {
+                printf("  %3d [", cpu);
+                if (stats->online[cpu]) {
+                    print_share_bar(&stats->cores[cpu], 10);
+                    printf("] %3.0f%%", cpu_share_busy(&stats->cores[cpu]));
+                } else {
+                    printf("  offline ]     ");
+                }
+                if (cpu % 4 == 3 || cpu == stats->cpu_count - 1) printf("\n");
+            }
         } else {
-            strncpy(user_short, processes[proc_index].user, sizeof(user_short));
-        }
-        
-        // Truncate cmdline if too long (account for tree indentation)
-        int tree_indent = processes[proc_index].tree_depth * 2;  // 2 chars per level
-        int max_cmd_len = 44 - tree_indent;
-        if (max_cmd_len < 10) max_cmd_len = 10;  // Minimum space for command
-        
-        // Build tree prefix
-        char tree_prefix[64] = "";
-        if (global_config.show_tree_view && processes[proc_index].tree_depth > 0) {
-            for (int d = 0; d < processes[proc_index].tree_depth && d < 20; d++) {
-                if (d == processes[proc_index].tree_depth - 1) {
-                    strcat(tree_prefix, "└─");
+            // Large machines: one heatmap cell per CPU, 64 per line
+            static const char *levels[] = { " ", "▁", "▂", "▃", "▄", "▅", "▆", "▇", "█" };
+            for (int cpu = 0; cpu < stats->cpu_count; cpu++) {
+                if (cpu % 64 == 0) {
+                    int last = (cpu + 63 < stats->cpu_count) ? cpu + 63 : stats->cpu_count - 1;
+                    printf("  %4d-%-4d ", cpu, last);
+                }
+                if (stats->online[cpu]) {
+                    float busy = cpu_share_busy(&stats->cores[cpu]);
+                    const char *color = (busy < 50.0f) ? COLOR_GREEN : (busy < 85.0f) ? COLOR_YELLOW : COLOR_RED;
+                    printf("%s%s" COLOR_RESET, color, levels[(int)(busy / 100.0f * 8.0f + 0.5f)]);
                 } else {
-                    strcat(tree_prefix, "  ");
+                    printf("·");
                 }
+                if (cpu % 64 == 63 || cpu == stats->cpu_count - 1) printf("\n");
             }
         }
-        
-        // Format command with tree prefix
-        char cmdline_with_tree[128];
-        snprintf(cmdline_with_tree, sizeof(cmdline_with_tree), "%s%s", 
-                 tree_prefix, processes[proc_index].cmdline);
-        
-        size_t cmdline_len = strlen(cmdline_with_tree);
-        if (cmdline_len > 44) {
-            strncpy(cmdline_short, cmdline_with_tree, 41);
-            cmdline_short[41] = '.';
-            cmdline_short[42] = '.';
-            cmdline_short[43] = '.';
-            cmdline_short[44] = '\0';
-        } else {
-            strncpy(cmdline_short, cmdline_with_tree, sizeof(cmdline_short) - 1);
-            cmdline_short[sizeof(cmdline_short) - 1] = '\0';
+    }
+
+    printf(COLOR_BOLD "%s  Load:" COLOR_RESET " %.2f %.2f %.2f", config_get_header_color(),
+           stats->load[0], stats->load[1], stats->load[2]);
+    if (stats->has_pressure) {
+        // some = at least one task stalled, full = all non-idle tasks stalled
+        printf("   " COLOR_BOLD "%sPSI avg10 some/full:" COLOR_RESET " cpu %.2f%%  mem %.2f/%.2f%%  io %.2f/%.2f%%",
+               config_get_header_color(), stats->cpu_some.avg10,
+               stats->memory_some.avg10, stats->memory_full.avg10,
+               stats->io_some.avg10, stats->io_full.avg10);
+    }
+    printf("\n\n");
+}
+
+// Compact decimal count for narrow columns: "0", "42", "1.2k", "3.4M"
+static void format_count(float value, char *buffer, size_t size) {
+    if (value < 0.5f) {
+        snprintf(buffer, size, "0");
+    } else if (value < 1000.0f) {
+        snprintf(buffer, size, "%.0f", value);
+    } else if (value < 1e6f) {
+        snprintf(buffer, size, "%.1fk", value / 1e3f);
+    } else {
+        snprintf(buffer, size, "%.1fM", value / 1e6f);
+    }
+}
+
+// Five-character colored state label
+static const char* state_label(char state) {
+    switch (state) {
+        case 'R': return COLOR_GREEN "RUN  " COLOR_RESET;
+        case 'S': return "SLEEP";
+        case 'D': return COLOR_YELLOW "DISK " COLOR_RESET;
+        case 'Z': return COLOR_RED "ZOMBI" COLOR_RESET;
+        case 'T': return COLOR_CYAN "STOP " COLOR_RESET;
+        case 'I': return COLOR_BLUE "IDLE " COLOR_RESET;
+        default:  return "?????";
+    }
+}
+
+// Prints one process row; 'as_child' indents it one level (group members),
+// 'selected' draws it in reverse video as the cursor row
+static void print_process_row(const ProcessInfo *p, bool as_child, bool selected) {
+    char vsize_str[16];
+    char rss_str[16];
+    char cmdline_short[48];
+    char user_short[11]; // 10 chars + null terminator
+
+    format_memory(p->vsize, vsize_str, sizeof(vsize_str));
+    format_memory(p->rss, rss_str, sizeof(rss_str));
+    
+    // Truncate username if too long
+    if (strlen(p->user) > 10) {
+        strncpy(user_short, p->user, 9);
+        user_short[9] = '+';
+        user_short[10] = '\0';
+    } else {
+        strncpy(user_short, p->user, sizeof(user_short));
+    }
+    
+    // Truncate cmdline if too long (account for tree indentation)
+    int tree_indent = (as_child ? 1 : p->tree_depth) * 2;  // 2 chars per level
+    int max_cmd_len = 44 - tree_indent;
+    if (max_cmd_len < 10) max_cmd_len = 10;  // Minimum space for command
+    
+    // Build tree prefix
+    char tree_prefix[64] = "";
+    // Threads of an expanded process and group members are always drawn as children
+    int depth = as_child ? 1 : p->tree_depth;
+    bool draw_tree = global_config.show_tree_view || p->is_thread || as_child;
+    if (draw_tree && depth > 0) {
+        for (int d = 0; d < depth && d < 20; d++) {
+            if (d == depth - 1) {
+                strcat(tree_prefix, "└─");
+            } else {
+                strcat(tree_prefix, "  ");
+            }
         }
+    }
+    
+    // Format command with tree prefix; a folded subtree shows how many it hides
+    char fold_mark[16] = "";
+    if (p->tree_folded > 0) {
+        snprintf(fold_mark, sizeof(fold_mark), "[+%d] ", p->tree_folded);
+    }
+    char cmdline_with_tree[128];
+    snprintf(cmdline_with_tree, sizeof(cmdline_with_tree), "%s%s%.100s", 
+             tree_prefix, fold_mark, p->cmdline);
+    
+    size_t cmdline_len = strlen(cmdline_with_tree);
+    if (cmdline_len > 44) {
+        strncpy(cmdline_short, cmdline_with_tree, 41);
+        cmdline_short[41] = '.';
+        cmdline_short[42] = '.';
+        cmdline_short[43] = '.';
+        cmdline_short[44] = '\0';
+    } else {
+        strncpy(cmdline_short, cmdline_with_tree, sizeof(cmdline_short) - 1);
+        cmdline_short[sizeof(cmdline_short) - 1] = '\0';
+    }
+
+    // Color code based on memory usage
+    const char* row_color = "";
+    if (p->mem_usage > 5.0f) {
+        row_color = COLOR_RED;
+    } else if (p->mem_usage > 2.0f) {
+        row_color = COLOR_YELLOW;
+    }
+    
+    // Processes started since the previous refresh are marked with '+'
+    char marker = p->is_new ? '+' : ' ';
+    if (p->is_new && row_color[0] == '\0') {
+        row_color = COLOR_GREEN;
+    }
+    
+    // Processes with a firing alert rule are marked and drawn in bold red
+    bool alerting = alerts_is_firing(p->pid);
+    if (alerting) {
+        row_color = COLOR_BOLD COLOR_RED;
+        marker = '!';
+    }
+    
+    // Get state description
+    const char* state_desc = state_label(p->state);
 
-        // Color code based on memory usage
-        const char* row_color = "";
-        if (processes[proc_index].mem_usage > 5.0f) {
-            row_color = COLOR_RED;
-        } else if (processes[proc_index].mem_usage > 2.0f) {
-            row_color = COLOR_YELLOW;
+    printf("%s%s%c %-6d %-10s %6.1f %6.2f %10s %10s",
+           row_color,
+           selected ? "\x1b[7m" : "",
+           marker,
+           p->pid,
+           user_short,
+           p->cpu_usage,
+           p->mem_usage,
+           vsize_str,
+           rss_str);
+    
+    if (global_config.show_pss_columns) {
+        char pss_str[16] = "-", uss_str[16] = "-", swap_str[16] = "-";
+        if (p->has_smaps) {
+            format_memory(p->pss, pss_str, sizeof(pss_str));
+            format_memory(p->uss, uss_str, sizeof(uss_str));
+            format_memory(p->swap, swap_str, sizeof(swap_str));
         }
-        
-        // Get state description
-        const char* state_desc;
-        switch (processes[proc_index].state) {
-            case 'R': state_desc = COLOR_GREEN "RUN  " COLOR_RESET; break;
-            case 'S': state_desc = "SLEEP"; break;
-            case 'D': state_desc = COLOR_YELLOW "DISK " COLOR_RESET; break;
-            case 'Z': state_desc = COLOR_RED "ZOMBI" COLOR_RESET; break;
-            case 'T': state_desc = COLOR_CYAN "STOP " COLOR_RESET; break;
-            case 'I': state_desc = COLOR_BLUE "IDLE " COLOR_RESET; break;
-            default:  state_desc = "?????"; break;
+        printf(" %10s %10s %10s", pss_str, uss_str, swap_str);
+    }
+    
+    if (global_config.show_socket_columns) {
+        if (p->has_sockets) {
+            printf(" %6d %6d %6d %6d", p->sockets, p->tcp_sockets, p->tcp_established, p->tcp_listen);
+        } else {
+            printf(" %6s %6s %6s %6s", "-", "-", "-", "-");
         }
+    }
+    
+    if (global_config.show_sched_columns) {
+        if (p->has_sched) {
+            char csw_str[16], icsw_str[16], minflt_str[16], majflt_str[16];
+            format_count(p->csw_rate, csw_str, sizeof(csw_str));
+            format_count(p->icsw_rate, icsw_str, sizeof(icsw_str));
+            format_count(p->minflt_rate, minflt_str, sizeof(minflt_str));
+            format_count(p->majflt_rate, majflt_str, sizeof(majflt_str));
+            printf(" %7.1f %6s %6s %6s %6s", p->wait_rate, csw_str, icsw_str, minflt_str, majflt_str);
+        } else {
+            printf(" %7s %6s %6s %6s %6s", "-", "-", "-", "-", "-");
+        }
+    }
+    
+    if (global_config.show_io_columns) {
+        char read_str[16], write_str[16], rchar_str[16], wchar_str[16];
+        format_rate(p->read_rate, read_str, sizeof(read_str));
+        format_rate(p->write_rate, write_str, sizeof(write_str));
+        format_rate(p->rchar_rate, rchar_str, sizeof(rchar_str));
+        format_rate(p->wchar_rate, wchar_str, sizeof(wchar_str));
+        printf(" %8s %8s %8s %8s", read_str, write_str, rchar_str, wchar_str);
+    }
+    
+    printf(" %-5s  %-45s%s\n", state_desc, cmdline_short, COLOR_RESET);
+}
 
-        printf("%s  %-6d %-10s %6.1f %6.2f %10s %10s %-5s  %-45s%s\n",
-               row_color,
-               processes[proc_index].pid,
-               user_short,
-               processes[proc_index].cpu_usage,
-               processes[proc_index].mem_usage,
-               vsize_str,
-               rss_str,
-               state_desc,
-               cmdline_short,
-               COLOR_RESET);
+// Prints the column header of the process table; 'group_label' replaces
+// the PID/USER/COMMAND labels with group ones when grouping
+static void print_table_header(const char *group_label, const char *virt_label) {
+    // Optional column groups sit between RES and STATE
+    printf(COLOR_BOLD "%s  %-6s %-10s %6s %6s %10s %10s", 
+           config_get_header_color(),
+           group_label ? "#" : "PID", group_label ? "PROCS" : "USER",
+           "CPU%", "MEM%", virt_label, "RES");
+    if (global_config.show_pss_columns) {
+        printf(" %10s %10s %10s", "PSS", "USS", "SWAP");
+    }
+    if (global_config.show_socket_columns) {
+        printf(" %6s %6s %6s %6s", "SOCK", "TCP", "ESTAB", "LISTEN");
+    }
+    if (global_config.show_sched_columns) {
+        printf(" %7s %6s %6s %6s %6s", "WAIT ms", "CSW/s", "ICSW/s", "MINF/s", "MAJF/s");
+    }
+    if (global_config.show_io_columns) {
+        printf(" %8s %8s %8s %8s", "DISK R/s", "DISK W/s", "IO R/s", "IO W/s");
+    }
+    printf(" %-5s  %-45s\n" COLOR_RESET, "STATE", group_label ? group_label : "COMMAND");
+    
+    printf("%s  ────── ────────── ────── ────── ────────── ──────────", config_get_border_color());
+    if (global_config.show_pss_columns) {
+        printf(" ────────── ────────── ──────────");
+    }
+    if (global_config.show_socket_columns) {
+        printf(" ────── ────── ────── ──────");
+    }
+    if (global_config.show_sched_columns) {
+        printf(" ─────── ────── ────── ────── ──────");
+    }
+    if (global_config.show_io_columns) {
+        printf(" ──────── ──────── ──────── ────────");
+    }
+    printf(" ─────  ─────────────────────────────────────────────\n" COLOR_RESET);
+}
+
+void display_processes(const ProcessInfo processes[], int count, int scroll_offset, int visible_processes,
+                       int selected_row) {
+    if (!processes || count <= 0) return;
+
+    // Table header with better formatting and colors
+    print_table_header(NULL, "VIRT");
+    
+    // Show processes with scrolling support
+    int start_index = scroll_offset;
+    int end_index = (start_index + visible_processes > count) ? count : start_index + visible_processes;
+    
+    for (int i = start_index; i < end_index; i++) {
+        print_process_row(&processes[i], false, i == selected_row);
     }
     
     // Show scroll position info
@@ -169,6 +407,305 @@ void display_processes(const ProcessInfo processes[], int count, int scroll_offs
     }
 }
 
+void display_groups(const ProcessGroup groups[], int group_count, GroupMode mode,
+                    int expanded_id, const ProcessInfo members[], int member_count,
+                    int scroll_offset, int visible_rows) {
+    if (!groups || group_count <= 0) return;
+
+    const char *label = (mode == GROUP_BY_USER) ? "USER" :
+                        (mode == GROUP_BY_COMMAND) ? "COMMAND" :
+                        (mode == GROUP_BY_CGROUP) ? "CGROUP" : "SUBTREE";
+    print_table_header(label, mode == GROUP_BY_CGROUP ? "MEM PSI" : "");
+
+    // Rows are the groups, with the expanded group's members right below it
+    int total_rows = group_count + member_count;
+    int end_row = (scroll_offset + visible_rows > total_rows) ? total_rows : scroll_offset + visible_rows;
+    int row = 0;
+
+    for (int g = 0; g < group_count && row < end_row; g++) {
+        const ProcessGroup *group = &groups[g];
+
+        if (row >= scroll_offset) {
+            char number[16], count_str[16], rss_str[16], pressure_str[16] = "";
+            snprintf(number, sizeof(number), "%d", g + 1);
+            snprintf(count_str, sizeof(count_str), "%d", group->count);
+            format_memory(group->rss, rss_str, sizeof(rss_str));
+            if (group->has_pressure) {
+                snprintf(pressure_str, sizeof(pressure_str), "%.2f%%", group->memory_pressure);
+            }
+
+            printf(COLOR_BOLD "  %-6s %-10s %6.1f %6.2f %10s %10s" COLOR_RESET,
+                   number, count_str, group->cpu_usage, group->mem_usage, pressure_str, rss_str);
+            if (global_config.show_pss_columns) {
+                printf(" %10s %10s %10s", "", "", "");
+            }
+            if (global_config.show_socket_columns) {
+                printf(" %6s %6s %6s %6s", "", "", "", "");
+            }
+            if (global_config.show_sched_columns) {
+                printf(" %7s %6s %6s %6s %6s", "", "", "", "", "");
+            }
+            if (global_config.show_io_columns) {
+                char read_str[16], write_str[16];
+                format_rate(group->read_rate, read_str, sizeof(read_str));
+                format_rate(group->write_rate, write_str, sizeof(write_str));
+                printf(" %8s %8s %8s %8s", read_str, write_str, "", "");
+            }
+            // cgroups are drawn as a tree of directory names
+            const char *name = group->key;
+            if (mode == GROUP_BY_CGROUP && group->depth > 0) {
+                const char *slash = strrchr(group->key, '/');
+                if (slash) name = slash + 1;
+            }
+            int indent = (mode == GROUP_BY_CGROUP) ? group->depth * 2 : 0;
+            if (indent > 20) indent = 20;
+            printf(" %-5s  %*s" COLOR_BOLD "%s%-.*s" COLOR_RESET "\n",
+                   state_label(group->state), indent, "", group->id == expanded_id ? "▼ " : "▶ ",
+                   42 - indent, name);
+        }
+        row++;
+
+        if (group->id == expanded_id) {
+            for (int m = 0; m < member_count && row < end_row; m++, row++) {
+                if (row >= scroll_offset) print_process_row(&members[m], true, false);
+            }
+        }
+    }
+
+    printf("\n");
+    printf(COLOR_BOLD "  Grouped by %s: %d groups" COLOR_RESET, group_mode_name(mode), group_count);
+    if (scroll_offset > 0) {
+        printf(COLOR_GREEN " ▲ More above" COLOR_RESET);
+    }
+    if (end_row < total_rows) {
+        printf(COLOR_GREEN " ▼ More below" COLOR_RESET);
+    }
+    printf("  |  " COLOR_BOLD "+" COLOR_RESET " Expand group  " COLOR_BOLD "G" COLOR_RESET " Next grouping\n");
+}
+
+// Text of a detail pane section: "…" while loading, "-" when unreadable
+static const char* detail_state(const ProcessDetail *detail, unsigned int section) {
+    if (!(detail->ready & section)) return "…";
+    if (detail->denied & section) return "-";
+    return NULL;
+}
+
+static void format_limit(unsigned long long value, char *buffer, size_t size) {
+    if (value == DETAIL_UNLIMITED) {
+        snprintf(buffer, size, "unlimited");
+    } else {
+        snprintf(buffer, size, "%llu", value);
+    }
+}
+
+void display_detail(const ProcessDetail *detail, const char *name) {
+    if (!detail || detail->pid <= 0) return;
+
+    printf("\n" COLOR_BOLD "%s  Details: PID %d %s" COLOR_RESET, config_get_header_color(),
+           detail->pid, name ? name : "");
+    if (detail->loading) {
+        printf(COLOR_YELLOW "  loading…" COLOR_RESET);
+    } else if (detail->updated > 0) {
+        char when[16];
+        strftime(when, sizeof(when), "%H:%M:%S", localtime(&detail->updated));
+        printf("  (read %s, every %ds)", when, DETAIL_REFRESH_SECONDS);
+    }
+    if (detail->ready == DETAIL_ALL && detail->denied == DETAIL_ALL) {
+        printf(COLOR_RED "  process exited" COLOR_RESET "\n");
+        return;
+    }
+    printf("\n");
+
+    const char *state = detail_state(detail, DETAIL_PATHS);
+    printf("  CWD     %.100s\n", state ? state : detail->cwd);
+    printf("  EXE     %.100s\n", state ? state : detail->exe);
+    state = detail_state(detail, DETAIL_CGROUP);
+    printf("  CGROUP  %.100s\n", state ? state : detail->cgroup);
+
+    // Open fds next to their limit, then environment size and other limits
+    char fds[32], nofile_soft[24], nofile_hard[24], as_limit[24], nproc[24];
+    state = detail_state(detail, DETAIL_FDS);
+    if (state) {
+        snprintf(fds, sizeof(fds), "%s", state);
+    } else {
+        snprintf(fds, sizeof(fds), "%d", detail->fd_count);
+    }
+    format_limit(detail->nofile_soft, nofile_soft, sizeof(nofile_soft));
+    format_limit(detail->nofile_hard, nofile_hard, sizeof(nofile_hard));
+    format_limit(detail->as_soft, as_limit, sizeof(as_limit));
+    format_limit(detail->nproc_soft, nproc, sizeof(nproc));
+    printf("  FDS     %s open", fds);
+    state = detail_state(detail, DETAIL_LIMITS);
+    if (state) {
+        printf("  (limits %s)", state);
+    } else {
+        printf(" (limit %s / %s)   Max address space %s   Max processes %s",
+               nofile_soft, nofile_hard, as_limit, nproc);
+    }
+    printf("\n");
+
+    state = detail_state(detail, DETAIL_ENVIRON);
+    if (state) {
+        printf("  ENV     %s\n", state);
+    } else {
+        char env_size[16];
+        format_memory(detail->env_bytes, env_size, sizeof(env_size));
+        printf("  ENV     %d variables, %s\n", detail->env_vars, env_size);
+    }
+
+    state = detail_state(detail, DETAIL_MAPS);
+    if (state) {
+        printf("  MAPS    %s", state);
+    } else {
+        char file_size[16], anon_size[16];
+        format_memory(detail->file_bytes, file_size, sizeof(file_size));
+        format_memory(detail->anon_bytes, anon_size, sizeof(anon_size));
+        printf("  MAPS    %d mappings: %d file-backed (%s), %d anonymous (%s)",
+               detail->map_count, detail->file_maps, file_size,
+               detail->map_count - detail->file_maps, anon_size);
+    }
+    state = detail_state(detail, DETAIL_SMAPS);
+    if (state) {
+        printf("   PSS %s\n", state);
+    } else {
+        char pss[16], uss[16], swap[16];
+        format_memory(detail->pss, pss, sizeof(pss));
+        format_memory(detail->uss, uss, sizeof(uss));
+        format_memory(detail->swap, swap, sizeof(swap));
+        printf("   PSS %s  USS %s  SWAP %s\n", pss, uss, swap);
+    }
+}
+
+// Threads listed under the watch pane
+#define WATCH_THREAD_ROWS 6
+
+// One block character per value, scaled to [low, high]; blank until the series starts
+static void print_sparkline(const float values[], int count, float low, float high,
+                            const WatchSample samples[]) {
+    static const char *levels[] = { "▁", "▂", "▃", "▄", "▅", "▆", "▇", "█" };
+    printf("%*s", WATCH_COLUMNS - count, "");
+    for (int i = 0; i < count; i++) {
+        int level = 0;
+        if (high > low) {
+            level = (int)((values[i] - low) / (high - low) * 7.0f + 0.5f);
+            if (level < 0) level = 0;
+            if (level > 7) level = 7;
+        }
+        // Samples with major faults stand out in the fault series
+        bool major = samples && samples[i].majflt_rate > 0.0f;
+        printf("%s%s%s", major ? COLOR_RED : "", levels[level], major ? COLOR_RESET : "");
+    }
+}
+
+void display_watch(const WatchView *view) {
+    if (!view || view->pid <= 0) return;
+
+    printf("\n" COLOR_BOLD "%s  Watch: PID %d %s" COLOR_RESET "  (every %d ms, %.1f s shown)",
+           config_get_header_color(), view->pid, view->name, view->interval_ms,
+           view->count * view->interval_ms / 1000.0);
+    if (view->exited) {
+        printf(COLOR_RED "  process exited" COLOR_RESET);
+    }
+    printf("\n");
+    if (view->count == 0) {
+        printf("  sampling…\n");
+        return;
+    }
+
+    float cpu[WATCH_COLUMNS], rss[WATCH_COLUMNS], faults[WATCH_COLUMNS];
+    float cpu_max = 100.0f, rss_min = 0.0f, rss_max = 0.0f, faults_max = 0.0f;
+    for (int i = 0; i < view->count; i++) {
+        const WatchSample *s = &view->samples[i];
+        cpu[i] = s->cpu;
+        rss[i] = (float)s->rss;
+        faults[i] = s->minflt_rate + s->majflt_rate;
+        if (cpu[i] > cpu_max) cpu_max = cpu[i];
+        if (i == 0 || rss[i] < rss_min) rss_min = rss[i];
+        if (rss[i] > rss_max) rss_max = rss[i];
+        if (faults[i] > faults_max) faults_max = faults[i];
+    }
+    const WatchSample *last = &view->samples[view->count - 1];
+
+    printf("  CPU    ");
+    print_sparkline(cpu, view->count, 0.0f, cpu_max, NULL);
+    printf("  %6.1f%%\n", last->cpu);
+
+    char rss_str[16], low_str[16], high_str[16];
+    format_memory(last->rss, rss_str, sizeof(rss_str));
+    format_memory((unsigned long)rss_min, low_str, sizeof(low_str));
+    format_memory((unsigned long)rss_max, high_str, sizeof(high_str));
+    printf("  RSS    ");
+    print_sparkline(rss, view->count, rss_min, rss_max, NULL);
+    printf("  %s (%s - %s)\n", rss_str, low_str, high_str);
+
+    char minflt_str[16], majflt_str[16];
+    format_count(last->minflt_rate, minflt_str, sizeof(minflt_str));
+    format_count(last->majflt_rate, majflt_str, sizeof(majflt_str));
+    printf("  FAULTS ");
+    print_sparkline(faults, view->count, 0.0f, faults_max, view->samples);
+    printf("  %s/s minor, %s/s major\n", minflt_str, majflt_str);
+
+    printf("  STATE  %*s", WATCH_COLUMNS - view->count, "");
+    for (int i = 0; i < view->count; i++) {
+        char state = view->samples[i].state;
+        const char *color = state == 'R' ? COLOR_GREEN : state == 'D' ? COLOR_YELLOW :
+                            (state == 'Z' || state == 'X') ? COLOR_RED : "";
+        printf("%s%c%s", color, state, color[0] ? COLOR_RESET : "");
+    }
+    printf("  %s\n", state_label(last->state));
+
+    // Busiest threads first (watch_get() sorts them)
+    int rows = view->thread_count < WATCH_THREAD_ROWS ? view->thread_count : WATCH_THREAD_ROWS;
+    for (int t = 0; t < rows; t++) {
+        const WatchThread *thread = &view->threads[t];
+        printf("  %-6d ", thread->tid);
+        print_sparkline(thread->cpu, view->count, 0.0f, cpu_max, NULL);
+        printf("  %6.1f%% %.15s\n", thread->cpu[view->count - 1], thread->name);
+    }
+    if (view->thread_count > rows) {
+        printf("  … %d more threads\n", view->thread_count - rows);
+    }
+}
+
+int display_watch_height(const WatchView *view) {
+    if (!view || view->pid <= 0) return 0;
+    if (view->count == 0) return 3;  // Blank line, title, "sampling…"
+
+    int rows = view->thread_count < WATCH_THREAD_ROWS ? view->thread_count : WATCH_THREAD_ROWS;
+    return 6 + rows + (view->thread_count > rows ? 1 : 0);
+}
+
+void display_recent_exits(const ExitedProcess exits[], int count) {
+    if (!exits || count <= 0) return;
+
+    printf("\n" COLOR_BOLD "%s  Recently exited:" COLOR_RESET "\n", config_get_header_color());
+    for (int i = 0; i < count && i < 5; i++) {
+        char rss_str[16];
+        char when[16];
+        format_memory(exits[i].rss, rss_str, sizeof(rss_str));
+        strftime(when, sizeof(when), "%H:%M:%S", localtime(&exits[i].exited_at));
+        printf("  %s  %-6d %-16.16s lived %7.2fs  CPU %5.1f%%  RES %10s\n",
+               when, exits[i].pid, exits[i].name, exits[i].lifetime,
+               exits[i].cpu_usage, rss_str);
+    }
+}
+
+void display_search_bar(const char *query, const char *mode_name, int matches,
+                        bool editing, bool invalid) {
+    printf("\n  " COLOR_CYAN "🔍 Search" COLOR_RESET " (%s): " COLOR_BOLD "%s" COLOR_RESET "%s",
+           mode_name, query, editing ? "▏" : "");
+    if (invalid) {
+        printf("   " COLOR_RED "invalid regex" COLOR_RESET);
+    } else {
+        printf("   %d match%s", matches, matches == 1 ? "" : "es");
+    }
+    if (editing) {
+        printf("   " COLOR_YELLOW "Tab" COLOR_RESET " mode  " COLOR_YELLOW "Enter" COLOR_RESET " keep  "
+               COLOR_YELLOW "Esc" COLOR_RESET " clear");
+    }
+    printf("\n");
+}
+
 void format_memory(unsigned long size, char* buffer, size_t buffer_size) {
     // Validate input parameters
     if (!buffer || buffer_size < 16) {
@@ -188,6 +725,32 @@ void format_memory(unsigned long size, char* buffer, size_t buffer_size) {
 }
 
 
+void format_rate(float bytes_per_sec, char* buffer, size_t buffer_size) {
+    if (!buffer || buffer_size < 8) {
+        return;
+    }
+    
+    // Compact form for narrow columns: "0", "512B", "12.3K", "4.0M", "1.2G"
+    const char* units[] = {"B", "K", "M", "G", "T"};
+    int unit_index = 0;
+    double rate = bytes_per_sec;
+    
+    if (rate < 0.5) {
+        snprintf(buffer, buffer_size, "0");
+        return;
+    }
+    while (rate >= 1024 && unit_index < 4) {
+        rate /= 1024;
+        unit_index++;
+    }
+    
+    if (unit_index == 0) {
+        snprintf(buffer, buffer_size, "%.0f%s", rate, units[unit_index]);
+    } else {
+        snprintf(buffer, buffer_size, "%.1f%s", rate, units[unit_index]);
+    }
+}
+
 void apply_color(float load, char* buffer, size_t buffer_size) {
     // Validate input parameters
     if (!buffer || buffer_size < 32) {
@@ -237,7 +800,7 @@ const char* get_state_color(char state) {
     }
 }
 
-void display_command_menu(SortMode current_sort, const char* filter_user, int scroll_offset, int total_processes) {
+void display_command_menu(SortMode current_sort, const char* filter_text, int scroll_offset, int total_processes) {
     (void)scroll_offset;  // For future use if needed
     
     printf("\n");
@@ -251,32 +814,45 @@ void display_command_menu(SortMode current_sort, const char* filter_user, int sc
     const char* sort_c = (current_sort == SORT_BY_CPU) ? COLOR_GREEN "C" COLOR_RESET : COLOR_BOLD "C" COLOR_RESET;
     const char* sort_m = (current_sort == SORT_BY_MEM) ? COLOR_GREEN "M" COLOR_RESET : COLOR_BOLD "M" COLOR_RESET;
     const char* sort_u = (current_sort == SORT_BY_USER) ? COLOR_GREEN "U" COLOR_RESET : COLOR_BOLD "U" COLOR_RESET;
+    const char* sort_o = (current_sort == SORT_BY_IO_READ || current_sort == SORT_BY_IO_WRITE) ?
+                         COLOR_GREEN "O" COLOR_RESET : COLOR_BOLD "O" COLOR_RESET;
+    const char* sort_b = (current_sort == SORT_BY_SCHED_WAIT || current_sort == SORT_BY_CTX_SWITCHES ||
+                          current_sort == SORT_BY_FAULTS) ? COLOR_GREEN "B" COLOR_RESET : COLOR_BOLD "B" COLOR_RESET;
     
     // Current sort indicator
-    const char* sort_indicator;
+    const char* sort_name;
     switch (current_sort) {
-        case SORT_BY_CPU: sort_indicator = COLOR_GREEN "CPU↓" COLOR_RESET; break;
-        case SORT_BY_MEM: sort_indicator = COLOR_GREEN "MEM↓" COLOR_RESET; break;
-        case SORT_BY_USER: sort_indicator = COLOR_GREEN "USER↓" COLOR_RESET; break;
+        case SORT_BY_CPU: sort_name = "CPU"; break;
+        case SORT_BY_MEM: sort_name = "MEM"; break;
+        case SORT_BY_USER: sort_name = "USER"; break;
+        case SORT_BY_IO_READ: sort_name = "READ"; break;
+        case SORT_BY_IO_WRITE: sort_name = "WRITE"; break;
+        case SORT_BY_SCHED_WAIT: sort_name = "WAIT"; break;
+        case SORT_BY_CTX_SWITCHES: sort_name = "CSW"; break;
+        case SORT_BY_FAULTS: sort_name = "FAULT"; break;
         case SORT_BY_PID: 
-        default: sort_indicator = COLOR_GREEN "PID↓" COLOR_RESET; break;
+        default: sort_name = "PID"; break;
     }
     
-    // Sort: PID  CPU  Memory  User     Current: MEM↓ (46 chars + 39 spaces = 85)
-    printf("%s  ║ " COLOR_RESET COLOR_YELLOW "Sort:" COLOR_RESET " %sID  %sPU  %semory  %sser     Current: %s                                       %s║\n" COLOR_RESET, 
-           config_get_border_color(), sort_p, sort_c, sort_m, sort_u, sort_indicator, config_get_border_color());
+    // Sort: PID  CPU  Memory  User  I/O  B Latency   Current: MEM↓ (60 chars + 25 spaces = 85;
+    // the indicator is 4-6 columns wide, so the padding follows its length)
+    int sort_pad = 85 - 56 - ((int)strlen(sort_name) + 1);
+    printf("%s  ║ " COLOR_RESET COLOR_YELLOW "Sort:" COLOR_RESET " %sID  %sPU  %semory  %sser  I/%s  %s Latency   Current: " COLOR_GREEN "%s↓" COLOR_RESET "%*s%s║\n" COLOR_RESET, 
+           config_get_border_color(), sort_p, sort_c, sort_m, sort_u, sort_o, sort_b, sort_name,
+           sort_pad, "", config_get_border_color());
     
-    // Filter: F User  R Reset (23 chars + 62 spaces = 85)
-    if (filter_user && strlen(filter_user) > 0) {
-        // Filter: Active: username
+    // Filter: F User  \ Expression  R Reset (37 chars + 48 spaces = 85)
+    if (filter_text && strlen(filter_text) > 0) {
+        // Filter: Active: expression (cut to fit the box)
         char filter_line[128];
-        int remaining = 85 - 16 - (int)strlen(filter_user);  // 85 total - "Filter: Active: " - username length
-        if (remaining < 0) remaining = 0;
+        int shown = (int)strlen(filter_text);
+        if (shown > 85 - 16) shown = 85 - 16;
+        int remaining = 85 - 16 - shown;  // 85 total - "Filter: Active: " - expression length
         snprintf(filter_line, sizeof(filter_line), "%*s", remaining, "");
-        printf("%s  ║ " COLOR_RESET COLOR_YELLOW "Filter:" COLOR_RESET " " COLOR_GREEN "Active: %s" COLOR_RESET "%s%s║\n" COLOR_RESET, 
-               config_get_border_color(), filter_user, filter_line, config_get_border_color());
+        printf("%s  ║ " COLOR_RESET COLOR_YELLOW "Filter:" COLOR_RESET " " COLOR_GREEN "Active: %.*s" COLOR_RESET "%s%s║\n" COLOR_RESET, 
+               config_get_border_color(), shown, filter_text, filter_line, config_get_border_color());
     } else {
-        printf("%s  ║ " COLOR_RESET COLOR_YELLOW "Filter:" COLOR_RESET " " COLOR_BOLD "F" COLOR_RESET " User  " COLOR_BOLD "R" COLOR_RESET " Reset                                                              %s║\n" COLOR_RESET, 
+        printf("%s  ║ " COLOR_RESET COLOR_YELLOW "Filter:" COLOR_RESET " " COLOR_BOLD "F" COLOR_RESET " User  " COLOR_BOLD "\\" COLOR_RESET " Expression  " COLOR_BOLD "R" COLOR_RESET " Reset                                                %s║\n" COLOR_RESET, 
                config_get_border_color(), config_get_border_color());
     }
     
@@ -286,9 +862,68 @@ void display_command_menu(SortMode current_sort, const char* filter_user, int sc
                config_get_border_color(), config_get_border_color());
     }
     
-    // Actions: K Kill  S Search  Q/Ctrl+C Quit (40 chars + 45 spaces = 85)
-    printf("%s  ║ " COLOR_RESET COLOR_YELLOW "Actions:" COLOR_RESET " " COLOR_RED "K" COLOR_RESET " Kill  " COLOR_CYAN "S" COLOR_RESET " Search  " COLOR_BOLD "Q" COLOR_RESET "/" COLOR_BOLD "Ctrl+C" COLOR_RESET " Quit                                             %s║\n" COLOR_RESET, 
+    // View: V Tree  + Fold (0: all)  I I/O  A PSS/USS  L Sockets  Z Latency  N Kthreads (81 chars + 4 spaces = 85)
+    printf("%s  ║ " COLOR_RESET COLOR_YELLOW "View:" COLOR_RESET " " COLOR_BOLD "V" COLOR_RESET " Tree  " COLOR_BOLD "+" COLOR_RESET " Fold (0: all)  " COLOR_BOLD "I" COLOR_RESET " I/O  " COLOR_BOLD "A" COLOR_RESET " PSS/USS  " COLOR_BOLD "L" COLOR_RESET " Sockets  " COLOR_BOLD "Z" COLOR_RESET " Latency  " COLOR_BOLD "N" COLOR_RESET " Kthreads    %s║\n" COLOR_RESET, 
+           config_get_border_color(), config_get_border_color());
+    
+    // Selected: D Detail  y Watch  Y Watch with threads (49 chars + 36 spaces = 85)
+    printf("%s  ║ " COLOR_RESET COLOR_YELLOW "Selected:" COLOR_RESET " " COLOR_BOLD "D" COLOR_RESET " Detail  " COLOR_BOLD "y" COLOR_RESET " Watch  " COLOR_BOLD "Y" COLOR_RESET " Watch with threads                                    %s║\n" COLOR_RESET, 
+           config_get_border_color(), config_get_border_color());
+    
+    // Actions: K Kill  S Search  H Threads  G Group  Q/Ctrl+C Quit (59 chars + 26 spaces = 85)
+    printf("%s  ║ " COLOR_RESET COLOR_YELLOW "Actions:" COLOR_RESET " " COLOR_RED "K" COLOR_RESET " Kill  " COLOR_CYAN "S" COLOR_RESET " Search  " COLOR_BOLD "H" COLOR_RESET " Threads  " COLOR_BOLD "G" COLOR_RESET " Group  " COLOR_BOLD "Q" COLOR_RESET "/" COLOR_BOLD "Ctrl+C" COLOR_RESET " Quit                         %s║\n" COLOR_RESET, 
            config_get_border_color(), config_get_border_color());
     printf("%s  ╚══════════════════════════════════════════════════════════════════════════════════════╝\n" COLOR_RESET, config_get_border_color());
-    printf(COLOR_BOLD "  Auto-refresh: 2s" COLOR_RESET "  |  Press any key above to execute\n");
-}
\ No newline at end of file
+}
+
+void display_refresh_status(int interval_ms, float self_cpu_percent, bool adaptive, bool degraded) {
+    printf(COLOR_BOLD "  Auto-refresh: %.1fs" COLOR_RESET, interval_ms / 1000.0f);
+    if (adaptive) {
+        printf("  |  Self CPU: %.2f%%", self_cpu_percent);
+        if (degraded) {
+            printf(COLOR_YELLOW "  (over budget: cmdline/user cached)" COLOR_RESET);
+        }
+    }
+    printf("  |  Press any key above to execute\n");
+}
+
+void display_remote_status(const char *path, bool connected) {
+    if (connected) {
+        printf(COLOR_BOLD "  Daemon:" COLOR_RESET " %s\n", path);
+    } else {
+        printf(COLOR_BOLD "  Daemon:" COLOR_RESET " %s  " COLOR_RED "disconnected, retrying" COLOR_RESET "\n", path);
+    }
+}
+
+void display_history_status(time_t when, int tier, int index, int count, float cpu_percent) {
+    static const char *resolutions[] = { "1s", "1m", "1h" };
+    char when_str[32];
+    strftime(when_str, sizeof(when_str), "%Y-%m-%d %H:%M:%S", localtime(&when));
+    printf(COLOR_BOLD "%s  🕘 History: " COLOR_RESET COLOR_BOLD "%s" COLOR_RESET
+           "  (%s resolution, frame %d/%d)  CPU %.1f%%   "
+           COLOR_YELLOW ",/." COLOR_RESET " frame  " COLOR_YELLOW "</>" COLOR_RESET " jump\n\n",
+           config_get_header_color(), when > 0 ? when_str : "frame overwritten",
+           resolutions[tier >= 0 && tier < 3 ? tier : 0], index + 1, count, cpu_percent);
+}
+
+void display_alerts(const AlertEvent events[], int count, const AlertStats *stats) {
+    if (!stats || stats->rules == 0) return;
+
+    printf(COLOR_BOLD "  Alerts:" COLOR_RESET " %s%d firing" COLOR_RESET
+           "  |  %d rules, %d evaluated in %.2f ms\n",
+           count > 0 ? COLOR_RED : COLOR_GREEN, count, stats->rules, stats->evaluated, stats->eval_ms);
+    for (int i = 0; i < count && i < 5; i++) {
+        char when[16];
+        strftime(when, sizeof(when), "%H:%M:%S", localtime(&events[i].since));
+        if (events[i].pid > 0) {
+            printf("  " COLOR_RED "● %-20s" COLOR_RESET " since %s  PID %-6d %.32s\n",
+                   events[i].name, when, events[i].pid, events[i].process);
+        } else {
+            printf("  " COLOR_RED "● %-20s" COLOR_RESET " since %s  value %.2f\n",
+                   events[i].name, when, events[i].value);
+        }
+    }
+    if (count > 5) {
+        printf("  ... and %d more\n", count - 5);
+    }
+}
@@ -0,0 +1,317 @@
+#define _POSIX_C_SOURCE 200809L
+#include <errno.h>
+#include <fcntl.h>
+#include <stdarg.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <time.h>
+#include "exporter.h"
+#include "process_monitor.h"
+
+// Rendered HTTP response: headers are written last, in front of the body
+#define HEADER_ROOM 256
+
+static char *response = NULL;
+static size_t response_cap = 0;
+static size_t body_len = 0;
+static size_t header_start = 0;  // Offset of the headers inside 'response'
+static int top_rows[MAX_PROCESS];
+static const ProcessInfo *rank_source;
+
+static void append(const char *format, ...) {
+    for (;;) {
+        size_t room = response_cap - HEADER_ROOM - body_len;
+        va_list args;
+        va_start(args, format);
+        int len = (response_cap > HEADER_ROOM + body_len)
+                ? vsnprintf(response + HEADER_ROOM + body_len, room, format, args)
+                : -1;
+        va_end(args);
+
+        if (len >= 0 && (size_t)len < room) {
+            body_len += (size_t)len;
+            return;
+        }
+
+        size_t cap = response_cap ? response_cap * 2 : 65536;
+        char *grown = realloc(response, cap);
+        if (!grown) return;  // Keep what fits
+        response = grown;
+        response_cap = cap;
+    }
+}
+
+// Label values: escape \ " and newline, cut to EXPORTER_MAX_LABEL
+static const char* label(const char *text, char *buffer) {
+    size_t out = 0;
+    for (; *text && out < EXPORTER_MAX_LABEL; text++) {
+        char c = *text;
+        if (c == '\\' || c == '"') buffer[out++] = '\\';
+        else if (c == '\n') { buffer[out++] = '\\'; c = 'n'; }
+        buffer[out++] = c;
+    }
+    buffer[out] = '\0';
+    return buffer;
+}
+
+static int compare_cpu(const void *a, const void *b) {
+    float ca = rank_source[*(const int *)a].cpu_usage;
+    float cb = rank_source[*(const int *)b].cpu_usage;
+    return (cb > ca) - (cb < ca);
+}
+
+static int compare_rss(const void *a, const void *b) {
+    unsigned long ra = rank_source[*(const int *)a].rss;
+    unsigned long rb = rank_source[*(const int *)b].rss;
+    return (rb > ra) - (rb < ra);
+}
+
+static void render_top(const ProcessInfo processes[], int count, int top_n,
+                       int (*compare)(const void *, const void *),
+                       const char *metric, const char *help, bool cpu) {
+    for (int i = 0; i < count; i++) top_rows[i] = i;
+    rank_source = processes;
+    qsort(top_rows, count, sizeof(int), compare);
+
+    append("# HELP %s %s\n# TYPE %s gauge\n", metric, help, metric);
+    for (int i = 0; i < count && i < top_n; i++) {
+        const ProcessInfo *p = &processes[top_rows[i]];
+        char name[2 * EXPORTER_MAX_LABEL + 1], user[2 * EXPORTER_MAX_LABEL + 1];
+        append("%s{pid=\"%d\",name=\"%s\",user=\"%s\"} ", metric, p->pid,
+               label(p->name, name), label(p->user, user));
+        if (cpu) append("%.2f\n", p->cpu_usage);
+        else     append("%lu\n", p->rss);
+    }
+}
+
+void exporter_render(const ProcessInfo processes[], int count, const sysinfo_t *sysinfo, int top_n) {
+    if (!processes || !sysinfo) return;
+    if (top_n > EXPORTER_MAX_TOP) top_n = EXPORTER_MAX_TOP;
+    if (count > MAX_PROCESS) count = MAX_PROCESS;
+    body_len = 0;
+
+    append("# HELP alttasker_memory_bytes System memory by kind.\n"
+           "# TYPE alttasker_memory_bytes gauge\n");
+    append("alttasker_memory_bytes{kind=\"total\"} %lu\n", sysinfo->total_mem);
+    append("alttasker_memory_bytes{kind=\"used\"} %lu\n", sysinfo->used_mem);
+    append("alttasker_memory_bytes{kind=\"available\"} %lu\n", sysinfo->available_mem);
+    append("alttasker_memory_bytes{kind=\"cached\"} %lu\n", sysinfo->cached_mem);
+    append("alttasker_memory_bytes{kind=\"shared\"} %lu\n", sysinfo->shared_mem);
+    append("alttasker_memory_bytes{kind=\"swap_total\"} %lu\n", sysinfo->swap_total);
+    append("alttasker_memory_bytes{kind=\"swap_used\"} %lu\n", sysinfo->swap_used);
+
+    append("# HELP alttasker_cpu_usage_percent Busy CPU time over the last interval.\n"
+           "# TYPE alttasker_cpu_usage_percent gauge\n"
+           "alttasker_cpu_usage_percent %.2f\n", sysinfo->cpu_usage_percent);
+    append("# HELP alttasker_uptime_seconds System uptime.\n"
+           "# TYPE alttasker_uptime_seconds gauge\n"
+           "alttasker_uptime_seconds %lu\n", sysinfo->uptime);
+    if (sysinfo->disk_valid) {
+        append("# HELP alttasker_disk_bytes_per_second Whole-disk throughput.\n"
+               "# TYPE alttasker_disk_bytes_per_second gauge\n"
+               "alttasker_disk_bytes_per_second{direction=\"read\"} %.0f\n"
+               "alttasker_disk_bytes_per_second{direction=\"write\"} %.0f\n",
+               sysinfo->disk_read_rate, sysinfo->disk_write_rate);
+    }
+
+    // Fixed state set keeps this series count constant
+    static const char states[] = "RSDZTI";
+    int state_count[sizeof(states)] = {0};
+    for (int i = 0; i < count; i++) {
+        const char *hit = strchr(states, processes[i].state);
+        state_count[(hit && processes[i].state) ? hit - states : (int)sizeof(states) - 1]++;
+    }
+    append("# HELP alttasker_processes Processes by state (other = t, X, ...).\n"
+           "# TYPE alttasker_processes gauge\n");
+    for (size_t s = 0; s < sizeof(states) - 1; s++) {
+        append("alttasker_processes{state=\"%c\"} %d\n", states[s], state_count[s]);
+    }
+    append("alttasker_processes{state=\"other\"} %d\n", state_count[sizeof(states) - 1]);
+
+    if (top_n > 0) {
+        render_top(processes, count, top_n, compare_cpu, "alttasker_process_cpu_percent",
+                   "CPU usage of the top processes by CPU.", true);
+        render_top(processes, count, top_n, compare_rss, "alttasker_process_resident_bytes",
+                   "Resident memory of the top processes by RSS.", false);
+    }
+
+    // Headers go right in front of the body so the response is one contiguous send
+    char header[HEADER_ROOM];
+    int len = snprintf(header, sizeof(header),
+                       "HTTP/1.1 200 OK\r\n"
+                       "Content-Type: text/plain; version=0.0.4; charset=utf-8\r\n"
+                       "Content-Length: %zu\r\n"
+                       "Connection: close\r\n\r\n", body_len);
+    if (!response || len <= 0 || len >= HEADER_ROOM) return;
+    header_start = HEADER_ROOM - (size_t)len;
+    memcpy(response + header_start, header, (size_t)len);
+}
+
+int exporter_open(int port) {
+    int fd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) return -1;
+
+    int one = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+
+    // Loopback only: the metrics include command names and users
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons((unsigned short)port);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+    if (bind(fd, (struct sockaddr *)&addr, sizeof(addr)) != 0 || listen(fd, 16) != 0) {
+        close(fd);
+        return -1;
+    }
+    fcntl(fd, F_SETFL, O_NONBLOCK);
+    return fd;
+}
+
+// One scrape connection; sockets are non-blocking and polled by the daemon
+typedef struct {
+    int fd;
+    double deadline;            // Dropped if still open by then
+    char request[2048];
+    size_t request_len;
+    char *unsent;               // Copy of the answer part the socket didn't take
+    size_t unsent_len;
+    size_t unsent_off;
+} Connection;
+
+static Connection connections[EXPORTER_MAX_CONNECTIONS];
+static int connection_count = 0;
+
+static void drop(int index) {
+    close(connections[index].fd);
+    free(connections[index].unsent);
+    connections[index] = connections[--connection_count];
+}
+
+// Sends without blocking; returns the bytes taken, or -1 on error
+static ssize_t send_some(int fd, const char *data, size_t len) {
+    size_t total = 0;
+    while (total < len) {
+        ssize_t sent = send(fd, data + total, len - total, MSG_NOSIGNAL);
+        if (sent < 0 && errno == EINTR) continue;
+        if (sent < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) break;
+        if (sent <= 0) return -1;
+        total += (size_t)sent;
+    }
+    return (ssize_t)total;
+}
+
+// Starts the answer; returns false once the connection is done with
+static bool answer(Connection *conn) {
+    static const char not_found[] =
+        "HTTP/1.1 404 Not Found\r\nContent-Type: text/plain\r\nContent-Length: 17\r\n"
+        "Connection: close\r\n\r\nTry GET /metrics\n";
+    const char *data = not_found;
+    size_t len = sizeof(not_found) - 1;
+
+    const char *request = conn->request;
+    if ((strncmp(request, "GET /metrics ", 13) == 0 || strncmp(request, "GET /metrics?", 13) == 0) &&
+        response && body_len > 0) {
+        data = response + header_start;
+        len = HEADER_ROOM - header_start + body_len;
+    }
+
+    ssize_t sent = send_some(conn->fd, data, len);
+    if (sent < 0 || (size_t)sent == len) return false;
+
+    // The buffer is re-rendered on the next scan: keep the rest of this one
+    conn->unsent_len = len - (size_t)sent;
+    conn->unsent = malloc(conn->unsent_len);
+    if (!conn->unsent) return false;
+    memcpy(conn->unsent, data + sent, conn->unsent_len);
+    conn->unsent_off = 0;
+    return true;
+}
+
+// Reads what arrived; returns false once the connection is done with
+static bool receive(Connection *conn) {
+    for (;;) {
+        size_t room = sizeof(conn->request) - 1 - conn->request_len;
+        ssize_t got = recv(conn->fd, conn->request + conn->request_len, room, 0);
+        if (got < 0 && errno == EINTR) continue;
+        if (got < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) return true;
+        if (got <= 0) return false;  // Closed before the request was complete
+        conn->request_len += (size_t)got;
+        conn->request[conn->request_len] = '\0';
+        if (strstr(conn->request, "\r\n\r\n") || strstr(conn->request, "\n\n") ||
+            conn->request_len == sizeof(conn->request) - 1) {
+            return answer(conn);
+        }
+    }
+}
+
+// Sends more of a pending answer; returns false once it is all out
+static bool resume(Connection *conn) {
+    ssize_t sent = send_some(conn->fd, conn->unsent + conn->unsent_off,
+                             conn->unsent_len - conn->unsent_off);
+    if (sent < 0) return false;
+    conn->unsent_off += (size_t)sent;
+    return conn->unsent_off < conn->unsent_len;
+}
+
+int exporter_poll_fds(int listen_fd, struct pollfd fds[]) {
+    // Scrapers send the request right away; a silent or stuck peer is dropped
+    double now = monotonic_seconds();
+    for (int i = connection_count - 1; i >= 0; i--) {
+        if (now >= connections[i].deadline) drop(i);
+    }
+
+    // With every slot taken, further scrapers wait in the listen backlog
+    fds[0].fd = connection_count < EXPORTER_MAX_CONNECTIONS ? listen_fd : -1;
+    fds[0].events = POLLIN;
+    for (int i = 0; i < connection_count; i++) {
+        fds[i + 1].fd = connections[i].fd;
+        fds[i + 1].events = connections[i].unsent ? POLLOUT : POLLIN;
+    }
+    return connection_count + 1;
+}
+
+void exporter_serve(int listen_fd, const struct pollfd fds[], int count) {
+    // Backwards, so that drop() only moves entries already handled
+    for (int i = count - 2; i >= 0; i--) {
+        short revents = fds[i + 1].revents;
+        if (revents == 0) continue;
+
+        Connection *conn = &connections[i];
+        bool keep;
+        if (conn->unsent) {
+            keep = (revents & POLLOUT) && resume(conn);
+        } else {
+            keep = (revents & POLLIN) && receive(conn);
+        }
+        if (!keep) drop(i);
+    }
+
+    if (!(fds[0].revents & POLLIN)) return;
+    while (connection_count < EXPORTER_MAX_CONNECTIONS) {
+        int fd = accept(listen_fd, NULL, NULL);
+        if (fd < 0) break;
+        // accept() inherits neither flag on Linux
+        fcntl(fd, F_SETFL, O_NONBLOCK);
+        fcntl(fd, F_SETFD, FD_CLOEXEC);
+        Connection *conn = &connections[connection_count++];
+        memset(conn, 0, sizeof(*conn));
+        conn->fd = fd;
+        conn->deadline = monotonic_seconds() + 1.0;
+        // The request usually arrives with the connection
+        if (!receive(conn)) drop(connection_count - 1);
+    }
+}
+
+void exporter_close(int listen_fd) {
+    while (connection_count > 0) {
+        drop(connection_count - 1);
+    }
+    if (listen_fd >= 0) close(listen_fd);
+    free(response);
+    response = NULL;
+    response_cap = 0;
+    body_len = 0;
+}
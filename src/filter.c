@@ -0,0 +1,286 @@
+#define _POSIX_C_SOURCE 200809L
+#include "filter.h"
+#include "process_monitor.h"
+
+// Field names as typed in expressions
+static const struct {
+    const char *name;
+    FilterField field;
+} field_names[] = {
+    { "pid", FILTER_PID },
+    { "ppid", FILTER_PPID },
+    { "uid", FILTER_UID },
+    { "cpu", FILTER_CPU },
+    { "mem", FILTER_MEM },
+    { "rss", FILTER_RSS },
+    { "virt", FILTER_VIRT },
+    { "read", FILTER_READ },
+    { "write", FILTER_WRITE },
+    { "wait", FILTER_WAIT },
+    { "csw", FILTER_CSW },
+    { "icsw", FILTER_ICSW },
+    { "minf", FILTER_MINF },
+    { "majf", FILTER_MAJF },
+    { "state", FILTER_STATE },
+    { "user", FILTER_USER },
+    { "name", FILTER_NAME },
+    { "cmd", FILTER_CMD },
+};
+
+static bool is_text_field(FilterField field) {
+    return field == FILTER_USER || field == FILTER_NAME || field == FILTER_CMD;
+}
+
+// Numeric fields and state are a load and a compare; text needs a string walk
+static int field_cost(FilterField field) {
+    switch (field) {
+        case FILTER_USER: return 1;
+        case FILTER_NAME: return 2;
+        case FILTER_CMD:  return 3;
+        default:          return 0;
+    }
+}
+
+static void set_error(char *error, size_t error_size, const char *message, const char *token) {
+    if (error && error_size > 0) {
+        snprintf(error, error_size, "%s: %s", message, token);
+    }
+}
+
+// Parses "500", "1.5G", "64k" etc. Size suffixes are powers of 1024.
+static int parse_number(const char *text, double *value) {
+    char *end;
+    double number = strtod(text, &end);
+    if (end == text) return -1;
+
+    switch (toupper((unsigned char)*end)) {
+        case 'K': number *= 1024.0; end++; break;
+        case 'M': number *= 1024.0 * 1024.0; end++; break;
+        case 'G': number *= 1024.0 * 1024.0 * 1024.0; end++; break;
+        default: break;
+    }
+    if (toupper((unsigned char)*end) == 'B') end++;
+    if (*end != '\0') return -1;
+
+    *value = number;
+    return 0;
+}
+
+// Compiles one "field op value" token
+static int compile_term(const char *token, FilterTerm *term, char *error, size_t error_size) {
+    size_t name_len = 0;
+    while (isalpha((unsigned char)token[name_len])) name_len++;
+
+    bool found = false;
+    for (size_t i = 0; i < sizeof(field_names) / sizeof(field_names[0]); i++) {
+        if (strlen(field_names[i].name) == name_len &&
+            strncmp(field_names[i].name, token, name_len) == 0) {
+            term->field = field_names[i].field;
+            found = true;
+            break;
+        }
+    }
+    if (!found) {
+        set_error(error, error_size, "Unknown field", token);
+        return -1;
+    }
+
+    const char *op = token + name_len;
+    const char *value;
+    if (strncmp(op, "!=", 2) == 0)      { term->op = FILTER_OP_NE; value = op + 2; }
+    else if (strncmp(op, "<=", 2) == 0) { term->op = FILTER_OP_LE; value = op + 2; }
+    else if (strncmp(op, ">=", 2) == 0) { term->op = FILTER_OP_GE; value = op + 2; }
+    else if (*op == '=')                { term->op = FILTER_OP_EQ; value = op + 1; }
+    else if (*op == '<')                { term->op = FILTER_OP_LT; value = op + 1; }
+    else if (*op == '>')                { term->op = FILTER_OP_GT; value = op + 1; }
+    else if (*op == '~')                { term->op = FILTER_OP_CONTAINS; value = op + 1; }
+    else {
+        set_error(error, error_size, "Expected = != < <= > >= or ~", token);
+        return -1;
+    }
+
+    if (*value == '\0') {
+        set_error(error, error_size, "Missing value", token);
+        return -1;
+    }
+
+    term->cost = field_cost(term->field);
+
+    if (is_text_field(term->field)) {
+        if (term->op != FILTER_OP_EQ && term->op != FILTER_OP_NE && term->op != FILTER_OP_CONTAINS) {
+            set_error(error, error_size, "Text fields support = != ~", token);
+            return -1;
+        }
+        snprintf(term->text, sizeof(term->text), "%s", value);
+        term->text_len = strlen(term->text);
+        if (term->op == FILTER_OP_CONTAINS) {
+            // Lower-case once here instead of per row
+            for (size_t i = 0; i < term->text_len; i++) {
+                term->text[i] = (char)tolower((unsigned char)term->text[i]);
+            }
+        }
+    } else if (term->field == FILTER_STATE) {
+        if ((term->op != FILTER_OP_EQ && term->op != FILTER_OP_NE) || value[1] != '\0') {
+            set_error(error, error_size, "Use state=X or state!=X", token);
+            return -1;
+        }
+        term->state = value[0];  // Case-sensitive: 'S' and 's' are different states
+    } else {
+        if (term->op == FILTER_OP_CONTAINS) {
+            set_error(error, error_size, "~ needs a text field", token);
+            return -1;
+        }
+        if (parse_number(value, &term->number) != 0) {
+            set_error(error, error_size, "Bad number", token);
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+int filter_compile(const char *expr, ProcessFilter *filter, char *error, size_t error_size) {
+    if (!filter) return -1;
+
+    filter->count = 0;
+    filter->source[0] = '\0';
+    if (error && error_size > 0) error[0] = '\0';
+    if (!expr) return 0;
+
+    char buffer[MAX_FILTER_LEN];
+    snprintf(buffer, sizeof(buffer), "%s", expr);
+
+    char *save = NULL;
+    for (char *token = strtok_r(buffer, " \t", &save); token; token = strtok_r(NULL, " \t", &save)) {
+        if (filter->count >= MAX_FILTER_TERMS) {
+            set_error(error, error_size, "Too many terms", token);
+            filter->count = 0;
+            return -1;
+        }
+        if (compile_term(token, &filter->terms[filter->count], error, error_size) != 0) {
+            filter->count = 0;
+            return -1;
+        }
+        filter->count++;
+    }
+
+    // Stable insertion sort by cost: cheap numeric tests reject most rows first
+    for (int i = 1; i < filter->count; i++) {
+        FilterTerm term = filter->terms[i];
+        int j = i - 1;
+        while (j >= 0 && filter->terms[j].cost > term.cost) {
+            filter->terms[j + 1] = filter->terms[j];
+            j--;
+        }
+        filter->terms[j + 1] = term;
+    }
+
+    snprintf(filter->source, sizeof(filter->source), "%s", expr);
+    return 0;
+}
+
+unsigned int filter_scan_flags(const ProcessFilter *filter) {
+    if (!filter) return 0;
+
+    unsigned int flags = 0;
+    for (int i = 0; i < filter->count; i++) {
+        switch (filter->terms[i].field) {
+            case FILTER_READ:
+            case FILTER_WRITE: flags |= SCAN_READ_IO; break;
+            case FILTER_WAIT:
+            case FILTER_CSW:
+            case FILTER_ICSW:
+            case FILTER_MINF:
+            case FILTER_MAJF:  flags |= SCAN_READ_SCHED; break;
+            default:           break;
+        }
+    }
+    return flags;
+}
+
+static double numeric_value(const ProcessInfo *p, FilterField field) {
+    switch (field) {
+        case FILTER_PID:   return p->pid;
+        case FILTER_PPID:  return p->ppid;
+        case FILTER_UID:   return p->uid;
+        case FILTER_CPU:   return p->cpu_usage;
+        case FILTER_MEM:   return p->mem_usage;
+        case FILTER_RSS:   return (double)p->rss;
+        case FILTER_VIRT:  return (double)p->vsize;
+        case FILTER_READ:  return p->read_rate;
+        case FILTER_WRITE: return p->write_rate;
+        case FILTER_WAIT:  return p->wait_rate;
+        case FILTER_CSW:   return p->csw_rate;
+        case FILTER_ICSW:  return p->icsw_rate;
+        case FILTER_MINF:  return p->minflt_rate;
+        case FILTER_MAJF:  return p->majflt_rate;
+        default:           return 0.0;
+    }
+}
+
+// Case-insensitive substring search; 'needle' is already lower-case
+static bool contains_nocase(const char *haystack, const char *needle, size_t needle_len) {
+    if (needle_len == 0) return true;
+
+    for (; *haystack; haystack++) {
+        if (tolower((unsigned char)*haystack) != needle[0]) continue;
+
+        size_t i = 1;
+        while (i < needle_len && haystack[i] &&
+               tolower((unsigned char)haystack[i]) == needle[i]) {
+            i++;
+        }
+        if (i == needle_len) return true;
+    }
+    return false;
+}
+
+static bool term_match(const FilterTerm *term, const ProcessInfo *p) {
+    if (is_text_field(term->field)) {
+        const char *text = (term->field == FILTER_USER) ? p->user :
+                           (term->field == FILTER_NAME) ? p->name : p->cmdline;
+        switch (term->op) {
+            case FILTER_OP_CONTAINS: return contains_nocase(text, term->text, term->text_len);
+            case FILTER_OP_NE:       return strcmp(text, term->text) != 0;
+            default:                 return strcmp(text, term->text) == 0;
+        }
+    }
+
+    if (term->field == FILTER_STATE) {
+        bool equal = p->state == term->state;
+        return term->op == FILTER_OP_NE ? !equal : equal;
+    }
+
+    double value = numeric_value(p, term->field);
+    switch (term->op) {
+        case FILTER_OP_EQ: return value == term->number;
+        case FILTER_OP_NE: return value != term->number;
+        case FILTER_OP_LT: return value < term->number;
+        case FILTER_OP_LE: return value <= term->number;
+        case FILTER_OP_GT: return value > term->number;
+        case FILTER_OP_GE: return value >= term->number;
+        default:           return false;
+    }
+}
+
+bool filter_match(const ProcessFilter *filter, const ProcessInfo *process) {
+    if (!filter) return true;
+
+    for (int i = 0; i < filter->count; i++) {
+        if (!term_match(&filter->terms[i], process)) return false;
+    }
+    return true;
+}
+
+int filter_apply(const ProcessFilter *filter, const ProcessInfo processes[], int count,
+                 ProcessInfo filtered[]) {
+    if (!processes || !filtered || count <= 0) return 0;
+
+    int filtered_count = 0;
+    for (int i = 0; i < count; i++) {
+        if (filter_match(filter, &processes[i])) {
+            filtered[filtered_count++] = processes[i];
+        }
+    }
+    return filtered_count;
+}
@@ -0,0 +1,210 @@
+#include "group.h"
+#include "proc_table.h"
+
+// Deepest parent chain followed when looking for a subtree root
+#define MAX_TREE_WALK 64
+
+// Higher rank wins when a group reports its "max" state
+static int state_rank(char state) {
+    switch (state) {
+        case 'D': return 6;   // Uninterruptible wait stands out first
+        case 'R': return 5;
+        case 'Z': return 4;
+        case 'T':
+        case 't': return 3;
+        case 'S': return 2;
+        case 'I': return 1;
+        default:  return 0;
+    }
+}
+
+static unsigned int hash_pid(pid_t pid) {
+    return (unsigned int)pid * 2654435761u;
+}
+
+// Index of 'pid' in 'processes' via a PID -> row table (-1 if absent)
+static int find_row(const int pid_slots[], const ProcessInfo processes[], pid_t pid) {
+    unsigned int slot = hash_pid(pid) & (GROUP_TABLE_SIZE - 1);
+    while (pid_slots[slot] >= 0) {
+        if (processes[pid_slots[slot]].pid == pid) return pid_slots[slot];
+        slot = (slot + 1) & (GROUP_TABLE_SIZE - 1);
+    }
+    return -1;
+}
+
+// Row of the ancestor that is a direct child of init; kernel threads all
+// belong to kthreadd (2)
+static int subtree_root(const int pid_slots[], const ProcessInfo processes[], int row) {
+    for (int depth = 0; depth < MAX_TREE_WALK; depth++) {
+        pid_t ppid = processes[row].ppid;
+        if (processes[row].pid <= 2 || ppid <= 1) return row;
+
+        int parent = find_row(pid_slots, processes, ppid);
+        if (parent < 0) return row;  // Parent not in the table (filtered out)
+        row = parent;
+    }
+    return row;
+}
+
+int group_processes(const ProcessInfo processes[], int count, GroupMode mode,
+                    ProcessGroup groups[], int max_groups, int group_of[]) {
+    if (!processes || !groups || count <= 0 || mode == GROUP_NONE || mode == GROUP_BY_CGROUP) return 0;
+    if (count > MAX_PROCESS) count = MAX_PROCESS;
+
+    // Subtree grouping first needs PID -> row lookups to walk parent links
+    static int pid_slots[GROUP_TABLE_SIZE];
+    if (mode == GROUP_BY_PARENT) {
+        memset(pid_slots, -1, sizeof(pid_slots));
+        for (int i = 0; i < count; i++) {
+            unsigned int slot = hash_pid(processes[i].pid) & (GROUP_TABLE_SIZE - 1);
+            while (pid_slots[slot] >= 0) slot = (slot + 1) & (GROUP_TABLE_SIZE - 1);
+            pid_slots[slot] = i;
+        }
+    }
+
+    // Group key -> group id
+    int group_slots[GROUP_TABLE_SIZE];
+    memset(group_slots, -1, sizeof(group_slots));
+    int group_count = 0;
+
+    for (int i = 0; i < count; i++) {
+        const ProcessInfo *p = &processes[i];
+        const ProcessInfo *root = NULL;
+        const char *key;
+        unsigned int hash;
+
+        switch (mode) {
+            case GROUP_BY_USER:
+                key = p->user;
+                hash = hash_string(key);
+                break;
+            case GROUP_BY_COMMAND:
+                key = p->name;
+                hash = hash_string(key);
+                break;
+            default:
+                root = &processes[subtree_root(pid_slots, processes, i)];
+                key = NULL;
+                hash = hash_pid(root->pid);
+                break;
+        }
+
+        unsigned int slot = hash & (GROUP_TABLE_SIZE - 1);
+        int id = -1;
+        while (group_slots[slot] >= 0) {
+            const ProcessGroup *g = &groups[group_slots[slot]];
+            if (root ? g->root_pid == root->pid : strcmp(g->key, key) == 0) {
+                id = group_slots[slot];
+                break;
+            }
+            slot = (slot + 1) & (GROUP_TABLE_SIZE - 1);
+        }
+
+        if (id < 0) {
+            if (group_count >= max_groups) {
+                if (group_of) group_of[i] = -1;
+                continue;
+            }
+            id = group_count++;
+            group_slots[slot] = id;
+
+            ProcessGroup *g = &groups[id];
+            memset(g, 0, sizeof(ProcessGroup));
+            g->id = id;
+            if (root) {
+                g->root_pid = root->pid;
+                snprintf(g->key, sizeof(g->key), "%.200s (%d)", root->name, root->pid);
+            } else {
+                snprintf(g->key, sizeof(g->key), "%s", key);
+            }
+        }
+
+        ProcessGroup *g = &groups[id];
+        g->count++;
+        g->cpu_usage += p->cpu_usage;
+        g->mem_usage += p->mem_usage;
+        g->rss += p->rss;
+        g->read_rate += p->read_rate;
+        g->write_rate += p->write_rate;
+        g->state = group_max_state(g->state, p->state);
+
+        if (group_of) group_of[i] = id;
+    }
+
+    return group_count;
+}
+
+static int compare_by_count(const void *a, const void *b) {
+    const ProcessGroup *ga = (const ProcessGroup *)a;
+    const ProcessGroup *gb = (const ProcessGroup *)b;
+    return gb->count - ga->count;
+}
+
+static int compare_by_cpu(const void *a, const void *b) {
+    const ProcessGroup *ga = (const ProcessGroup *)a;
+    const ProcessGroup *gb = (const ProcessGroup *)b;
+    if (gb->cpu_usage > ga->cpu_usage) return 1;
+    if (gb->cpu_usage < ga->cpu_usage) return -1;
+    return 0;
+}
+
+static int compare_by_rss(const void *a, const void *b) {
+    const ProcessGroup *ga = (const ProcessGroup *)a;
+    const ProcessGroup *gb = (const ProcessGroup *)b;
+    if (gb->rss > ga->rss) return 1;
+    if (gb->rss < ga->rss) return -1;
+    return 0;
+}
+
+static int compare_by_key(const void *a, const void *b) {
+    const ProcessGroup *ga = (const ProcessGroup *)a;
+    const ProcessGroup *gb = (const ProcessGroup *)b;
+    return strcmp(ga->key, gb->key);
+}
+
+static int compare_by_read(const void *a, const void *b) {
+    const ProcessGroup *ga = (const ProcessGroup *)a;
+    const ProcessGroup *gb = (const ProcessGroup *)b;
+    if (gb->read_rate > ga->read_rate) return 1;
+    if (gb->read_rate < ga->read_rate) return -1;
+    return 0;
+}
+
+static int compare_by_write(const void *a, const void *b) {
+    const ProcessGroup *ga = (const ProcessGroup *)a;
+    const ProcessGroup *gb = (const ProcessGroup *)b;
+    if (gb->write_rate > ga->write_rate) return 1;
+    if (gb->write_rate < ga->write_rate) return -1;
+    return 0;
+}
+
+void sort_groups(ProcessGroup groups[], int count, SortMode mode) {
+    if (!groups || count <= 1) return;
+
+    switch (mode) {
+        case SORT_BY_PID:      qsort(groups, count, sizeof(ProcessGroup), compare_by_count); break;
+        case SORT_BY_CPU:      qsort(groups, count, sizeof(ProcessGroup), compare_by_cpu); break;
+        case SORT_BY_MEM:      qsort(groups, count, sizeof(ProcessGroup), compare_by_rss); break;
+        case SORT_BY_USER:     qsort(groups, count, sizeof(ProcessGroup), compare_by_key); break;
+        case SORT_BY_IO_READ:  qsort(groups, count, sizeof(ProcessGroup), compare_by_read); break;
+        case SORT_BY_IO_WRITE: qsort(groups, count, sizeof(ProcessGroup), compare_by_write); break;
+        // Groups have no latency totals: busiest first
+        case SORT_BY_SCHED_WAIT:
+        case SORT_BY_CTX_SWITCHES:
+        case SORT_BY_FAULTS:   qsort(groups, count, sizeof(ProcessGroup), compare_by_cpu); break;
+    }
+}
+
+char group_max_state(char a, char b) {
+    return state_rank(b) > state_rank(a) ? b : a;
+}
+
+const char* group_mode_name(GroupMode mode) {
+    switch (mode) {
+        case GROUP_BY_CGROUP:  return "cgroup";
+        case GROUP_BY_USER:    return "user";
+        case GROUP_BY_COMMAND: return "command";
+        case GROUP_BY_PARENT:  return "parent subtree";
+        default:               return "none";
+    }
+}
@@ -0,0 +1,603 @@
+#define _POSIX_C_SOURCE 200809L
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "history.h"
+#include "process_monitor.h"
+#include "proc_table.h"
+#include "config.h"
+
+#define HISTORY_PAGE 4096u
+
+// Seconds per frame of each tier
+static const uint32_t tier_resolution[HISTORY_TIERS] = { 1, 60, 3600 };
+// Share of history_max_mb given to each tier, in eighths
+static const uint32_t tier_share[HISTORY_TIERS] = { 4, 3, 1 };
+
+// A mapped tier file
+typedef struct {
+    HistoryHeader *header;
+    int64_t *times;
+    HistoryFrame *frames;
+    size_t map_size;
+    int fd;
+} TierFile;
+
+// A process while frames are built or rolled up
+typedef struct {
+    pid_t pid;
+    pid_t ppid;
+    uid_t uid;
+    unsigned long long start_ticks;
+    char state;
+    char name[HISTORY_NAME_LEN];
+    double cpu;                 // CPU %; the weighted sum while a rollup bucket fills
+    float mem;                  // Peak memory %
+    unsigned long rss;          // Peak RSS
+    unsigned long vsize;        // Peak virtual size
+} HistoryRow;
+
+// One bucket of the next tier being filled from frames of the tier below
+typedef struct {
+    int64_t bucket;             // Start of the bucket
+    uint32_t samples;           // Refreshes added (0 = empty)
+    double cpu_sum;             // System CPU % times samples
+    HistoryFrame peak;          // System totals of the frame with the most memory used
+    int count;
+    HistoryRow rows[HISTORY_AGG_ROWS];
+} Rollup;
+
+static TierFile tiers[HISTORY_TIERS];
+static bool recording = false;
+static Rollup rollups[HISTORY_TIERS - 1];   // rollups[k] fills tier k + 1
+static HistoryRow scan_rows[MAX_PROCESS];
+static const HistoryRow *ranked;            // Rows being ordered by qsort()
+
+void history_get_dir(char *buffer, size_t size) {
+    const char *home = getenv("HOME");
+    if (global_config.history_dir[0] != '\0') {
+        snprintf(buffer, size, "%s", global_config.history_dir);
+    } else if (home && home[0] != '\0') {
+        snprintf(buffer, size, "%s/.alttasker-history", home);
+    } else {
+        snprintf(buffer, size, "/tmp/alttasker-history-%u", (unsigned int)getuid());
+    }
+}
+
+static void tier_path(char *buffer, size_t size, const char *dir, int tier) {
+    snprintf(buffer, size, "%s/tier%d.dat", dir, tier);
+}
+
+// Header page, time column rounded up to whole pages, then the frames
+static uint64_t tier_frame_offset(uint32_t capacity) {
+    uint64_t column = (uint64_t)capacity * sizeof(int64_t);
+    return HISTORY_PAGE + (column + HISTORY_PAGE - 1) / HISTORY_PAGE * HISTORY_PAGE;
+}
+
+static bool header_valid(const HistoryHeader *h, size_t file_size) {
+    return h->magic == HISTORY_MAGIC && h->version == HISTORY_VERSION &&
+           h->frame_size == sizeof(HistoryFrame) && h->capacity > 0 &&
+           h->time_offset == HISTORY_PAGE && h->frame_offset == tier_frame_offset(h->capacity) &&
+           h->frame_offset + (uint64_t)h->capacity * sizeof(HistoryFrame) <= file_size;
+}
+
+static void tier_map(TierFile *tier, void *map, size_t size, int fd) {
+    tier->header = (HistoryHeader *)map;
+    tier->times = (int64_t *)((char *)map + tier->header->time_offset);
+    tier->frames = (HistoryFrame *)((char *)map + tier->header->frame_offset);
+    tier->map_size = size;
+    tier->fd = fd;
+}
+
+static int tier_open(TierFile *tier, const char *path, uint32_t capacity, uint32_t resolution) {
+    int fd = open(path, O_RDWR | O_CREAT | O_CLOEXEC, 0600);
+    if (fd < 0) return -1;
+
+    // The lock lives as long as the descriptor: one writer per directory
+    if (flock(fd, LOCK_EX | LOCK_NB) != 0) {
+        close(fd);
+        return -1;
+    }
+
+    // Keep the frames of a previous run if the layout is the same
+    uint64_t size = tier_frame_offset(capacity) + (uint64_t)capacity * sizeof(HistoryFrame);
+    HistoryHeader existing;
+    struct stat st;
+    bool reuse = fstat(fd, &st) == 0 && (uint64_t)st.st_size == size &&
+                 pread(fd, &existing, sizeof(existing), 0) == (ssize_t)sizeof(existing) &&
+                 header_valid(&existing, size) && existing.capacity == capacity &&
+                 existing.resolution == resolution;
+    if (!reuse && (ftruncate(fd, 0) != 0 || ftruncate(fd, (off_t)size) != 0)) {
+        close(fd);
+        return -1;
+    }
+
+    void *map = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (map == MAP_FAILED) {
+        close(fd);
+        return -1;
+    }
+    if (!reuse) {
+        // Truncation zeroed the file: no frames, every time 0
+        HistoryHeader *h = (HistoryHeader *)map;
+        h->magic = HISTORY_MAGIC;
+        h->version = HISTORY_VERSION;
+        h->frame_size = sizeof(HistoryFrame);
+        h->capacity = capacity;
+        h->resolution = resolution;
+        h->time_offset = HISTORY_PAGE;
+        h->frame_offset = tier_frame_offset(capacity);
+        atomic_store_explicit(&h->written, 0, memory_order_release);
+    }
+    tier_map(tier, map, size, fd);
+    return 0;
+}
+
+static int64_t tier_last_time(const TierFile *tier) {
+    uint64_t written = atomic_load_explicit(&tier->header->written, memory_order_relaxed);
+    return written > 0 ? tier->times[(written - 1) % tier->header->capacity] : 0;
+}
+
+static void tier_append(TierFile *tier, const HistoryFrame *frame) {
+    HistoryHeader *h = tier->header;
+    uint64_t written = atomic_load_explicit(&h->written, memory_order_relaxed);
+    uint32_t slot = (uint32_t)(written % h->capacity);
+
+    // A reader copying this slot sees its time change and drops the copy
+    tier->times[slot] = 0;
+    atomic_thread_fence(memory_order_release);
+    tier->frames[slot] = *frame;
+    atomic_thread_fence(memory_order_release);
+    tier->times[slot] = frame->time;
+    atomic_store_explicit(&h->written, written + 1, memory_order_release);
+}
+
+static int compare_ranked_cpu(const void *a, const void *b) {
+    double ca = ranked[*(const int *)a].cpu;
+    double cb = ranked[*(const int *)b].cpu;
+    return (ca < cb) - (ca > cb);
+}
+
+static int compare_ranked_rss(const void *a, const void *b) {
+    unsigned long ra = ranked[*(const int *)a].rss;
+    unsigned long rb = ranked[*(const int *)b].rss;
+    return (ra < rb) - (ra > rb);
+}
+
+// Copies the top HISTORY_ROWS / 2 rows by CPU, then the largest by RSS, into the columns
+static void frame_set_rows(HistoryFrame *frame, const HistoryRow rows[], int count) {
+    static int order[HISTORY_AGG_ROWS > MAX_PROCESS ? HISTORY_AGG_ROWS : MAX_PROCESS];
+    static bool taken[HISTORY_AGG_ROWS > MAX_PROCESS ? HISTORY_AGG_ROWS : MAX_PROCESS];
+
+    int selected = 0;
+    int picks[HISTORY_ROWS];
+    if (count <= HISTORY_ROWS) {
+        for (int i = 0; i < count; i++) picks[selected++] = i;
+    } else {
+        ranked = rows;
+        for (int i = 0; i < count; i++) {
+            order[i] = i;
+            taken[i] = false;
+        }
+        qsort(order, count, sizeof(int), compare_ranked_cpu);
+        for (int i = 0; i < HISTORY_ROWS / 2; i++) {
+            taken[order[i]] = true;
+            picks[selected++] = order[i];
+        }
+        qsort(order, count, sizeof(int), compare_ranked_rss);
+        for (int i = 0; i < count && selected < HISTORY_ROWS; i++) {
+            if (!taken[order[i]]) picks[selected++] = order[i];
+        }
+    }
+
+    for (int i = 0; i < selected; i++) {
+        const HistoryRow *row = &rows[picks[i]];
+        frame->pid[i] = row->pid;
+        frame->ppid[i] = row->ppid;
+        frame->uid[i] = row->uid;
+        frame->cpu_usage[i] = (float)row->cpu;
+        frame->mem_usage[i] = row->mem;
+        frame->rss[i] = row->rss;
+        frame->vsize[i] = row->vsize;
+        frame->start_ticks[i] = row->start_ticks;
+        frame->state[i] = row->state;
+        memcpy(frame->name[i], row->name, HISTORY_NAME_LEN);
+    }
+    frame->count = (uint32_t)selected;
+}
+
+static void rollup_add(int level, const HistoryFrame *frame);
+
+// Writes the filled bucket of rollups[level] to the next tier and empties it
+static void rollup_flush(int level) {
+    Rollup *r = &rollups[level];
+    if (r->samples == 0) return;
+
+    static HistoryFrame out;
+    out = r->peak;
+    out.time = r->bucket;
+    out.samples = r->samples;
+    out.cpu_usage_percent = (float)(r->cpu_sum / r->samples);
+    for (int i = 0; i < r->count; i++) {
+        r->rows[i].cpu /= r->samples;  // Absent samples count as idle
+    }
+    frame_set_rows(&out, r->rows, r->count);
+    r->samples = 0;
+    r->count = 0;
+
+    // Same-bucket frames after a restart are kept; only a clock step back is dropped
+    TierFile *tier = &tiers[level + 1];
+    if (out.time >= tier_last_time(tier)) {
+        tier_append(tier, &out);
+        if (level + 1 < HISTORY_TIERS - 1) {
+            rollup_add(level + 1, &out);
+        }
+    }
+}
+
+static void rollup_add(int level, const HistoryFrame *frame) {
+    Rollup *r = &rollups[level];
+    uint32_t resolution = tier_resolution[level + 1];
+    int64_t bucket = frame->time - frame->time % resolution;
+    if (r->samples > 0 && bucket != r->bucket) {
+        rollup_flush(level);
+    }
+    if (r->samples == 0) {
+        r->bucket = bucket;
+        r->cpu_sum = 0.0;
+        memset(&r->peak, 0, sizeof(r->peak));
+    }
+
+    uint32_t weight = frame->samples > 0 ? frame->samples : 1;
+    r->samples += weight;
+    r->cpu_sum += (double)frame->cpu_usage_percent * weight;
+    if (frame->used_mem >= r->peak.used_mem) {
+        r->peak.total_mem = frame->total_mem;
+        r->peak.used_mem = frame->used_mem;
+        r->peak.available_mem = frame->available_mem;
+        r->peak.cached_mem = frame->cached_mem;
+        r->peak.shared_mem = frame->shared_mem;
+        r->peak.swap_total = frame->swap_total;
+        r->peak.swap_used = frame->swap_used;
+        r->peak.mem_usage_percent = frame->mem_usage_percent;
+    }
+    if (frame->total_processes > r->peak.total_processes) {
+        r->peak.total_processes = frame->total_processes;
+    }
+    r->peak.uptime = frame->uptime;
+
+    for (uint32_t i = 0; i < frame->count; i++) {
+        HistoryRow *row = NULL;
+        for (int j = 0; j < r->count; j++) {
+            if (r->rows[j].pid == frame->pid[i] && r->rows[j].start_ticks == frame->start_ticks[i]) {
+                row = &r->rows[j];
+                break;
+            }
+        }
+        if (!row) {
+            if (r->count >= HISTORY_AGG_ROWS) continue;  // Bucket full: late arrivals are dropped
+            row = &r->rows[r->count++];
+            memset(row, 0, sizeof(*row));
+            row->pid = frame->pid[i];
+            row->start_ticks = frame->start_ticks[i];
+            memcpy(row->name, frame->name[i], HISTORY_NAME_LEN);
+        }
+        row->ppid = frame->ppid[i];
+        row->uid = frame->uid[i];
+        row->state = frame->state[i];
+        row->cpu += (double)frame->cpu_usage[i] * weight;
+        if (frame->mem_usage[i] > row->mem) row->mem = frame->mem_usage[i];
+        if (frame->rss[i] > row->rss) row->rss = frame->rss[i];
+        if (frame->vsize[i] > row->vsize) row->vsize = frame->vsize[i];
+    }
+}
+
+int history_open(const char *dir, int max_mb) {
+    if (recording) return 0;
+    if (!dir || dir[0] == '\0') return -1;
+    if (mkdir(dir, 0700) != 0 && errno != EEXIST) return -1;
+    if (max_mb < 1) max_mb = 1;
+
+    for (int t = 0; t < HISTORY_TIERS; t++) {
+        uint64_t bytes = (uint64_t)max_mb * 1024 * 1024 * tier_share[t] / 8;
+        uint64_t capacity = bytes / (sizeof(HistoryFrame) + sizeof(int64_t));
+        if (capacity < 16) capacity = 16;
+        if (capacity > UINT32_MAX / 2) capacity = UINT32_MAX / 2;
+
+        char path[PATH_MAX];
+        tier_path(path, sizeof(path), dir, t);
+        if (tier_open(&tiers[t], path, (uint32_t)capacity, tier_resolution[t]) != 0) {
+            for (int u = 0; u < t; u++) {
+                munmap(tiers[u].header, tiers[u].map_size);
+                close(tiers[u].fd);
+            }
+            return -1;
+        }
+    }
+    memset(rollups, 0, sizeof(rollups));
+    recording = true;
+    return 0;
+}
+
+void history_record(const ProcessInfo processes[], int count, const sysinfo_t *sysinfo) {
+    if (!recording || !processes || !sysinfo) return;
+
+    // At most one frame per second on the first tier
+    int64_t now = (int64_t)time(NULL);
+    if (now <= tier_last_time(&tiers[0])) return;
+
+    static HistoryFrame frame;
+    memset(&frame, 0, sizeof(frame));
+    frame.time = now;
+    frame.samples = 1;
+    frame.total_mem = sysinfo->total_mem;
+    frame.used_mem = sysinfo->used_mem;
+    frame.available_mem = sysinfo->available_mem;
+    frame.cached_mem = sysinfo->cached_mem;
+    frame.shared_mem = sysinfo->shared_mem;
+    frame.swap_total = sysinfo->swap_total;
+    frame.swap_used = sysinfo->swap_used;
+    frame.uptime = sysinfo->uptime;
+    frame.mem_usage_percent = sysinfo->mem_usage_percent;
+    frame.cpu_usage_percent = sysinfo->cpu_usage_percent;
+    frame.total_processes = sysinfo->total_processes;
+
+    if (count > MAX_PROCESS) count = MAX_PROCESS;
+    for (int i = 0; i < count; i++) {
+        const ProcessInfo *p = &processes[i];
+        HistoryRow *row = &scan_rows[i];
+        row->pid = p->pid;
+        row->ppid = p->ppid;
+        row->uid = p->uid;
+        row->start_ticks = p->start_ticks;
+        row->state = p->state;
+        snprintf(row->name, sizeof(row->name), "%s", p->name);
+        row->cpu = p->cpu_usage;
+        row->mem = p->mem_usage;
+        row->rss = p->rss;
+        row->vsize = p->vsize;
+    }
+    frame_set_rows(&frame, scan_rows, count);
+
+    tier_append(&tiers[0], &frame);
+    rollup_add(0, &frame);
+}
+
+void history_close(void) {
+    if (!recording) return;
+
+    // The current minute and hour would be lost otherwise
+    for (int level = 0; level < HISTORY_TIERS - 1; level++) {
+        rollup_flush(level);
+    }
+    for (int t = 0; t < HISTORY_TIERS; t++) {
+        munmap(tiers[t].header, tiers[t].map_size);
+        close(tiers[t].fd);  // Releases the lock
+    }
+    recording = false;
+}
+
+// Parses "HH:MM[:SS]"; returns the characters used or -1
+static int parse_clock(const char *text, struct tm *tm) {
+    int hour, minute, second = 0, used = 0, more = 0;
+    if (sscanf(text, "%d:%d%n", &hour, &minute, &used) != 2) return -1;
+    if (text[used] == ':' && sscanf(text + used + 1, "%d%n", &second, &more) == 1) {
+        used += 1 + more;
+    }
+    if (hour < 0 || hour > 23 || minute < 0 || minute > 59 || second < 0 || second > 60) return -1;
+    tm->tm_hour = hour;
+    tm->tm_min = minute;
+    tm->tm_sec = second;
+    return used;
+}
+
+// One end of a range: relative, time of day or date (local time)
+static int parse_time(const char *text, time_t now, time_t *result) {
+    while (*text == ' ') text++;
+
+    if (text[0] == '-') {
+        char *end;
+        long amount = strtol(text + 1, &end, 10);
+        long unit = 0;
+        switch (*end) {
+            case 's': unit = 1; break;
+            case 'm': unit = 60; break;
+            case 'h': unit = 3600; break;
+            case 'd': unit = 86400; break;
+        }
+        if (end == text + 1 || unit == 0 || end[1] != '\0' || amount < 0) return -1;
+        *result = now - amount * unit;
+        return 0;
+    }
+
+    struct tm tm;
+    localtime_r(&now, &tm);
+    tm.tm_isdst = -1;
+    int year, month, day, used = 0;
+    if (sscanf(text, "%d-%d-%d%n", &year, &month, &day, &used) == 3) {
+        tm.tm_year = year - 1900;
+        tm.tm_mon = month - 1;
+        tm.tm_mday = day;
+        tm.tm_hour = tm.tm_min = tm.tm_sec = 0;
+        text += used;
+        if (*text == ' ' || *text == 'T') {
+            int clock = parse_clock(text + 1, &tm);
+            if (clock < 0) return -1;
+            text += 1 + clock;
+        }
+        if (*text != '\0') return -1;
+        *result = mktime(&tm);
+        return 0;
+    }
+
+    // A time of day is the last one before now: "02:14" in the morning means last night
+    used = parse_clock(text, &tm);
+    if (used < 0 || text[used] != '\0') return -1;
+    *result = mktime(&tm);
+    if (*result > now) {
+        tm.tm_mday--;
+        tm.tm_isdst = -1;
+        *result = mktime(&tm);
+    }
+    return 0;
+}
+
+int history_parse_range(const char *spec, time_t *from, time_t *to) {
+    if (!spec || !from || !to) return -1;
+
+    char start[64];
+    const char *comma = strchr(spec, ',');
+    size_t len = comma ? (size_t)(comma - spec) : strlen(spec);
+    if (len == 0 || len >= sizeof(start)) return -1;
+    memcpy(start, spec, len);
+    start[len] = '\0';
+
+    time_t now = time(NULL);
+    if (parse_time(start, now, from) != 0) return -1;
+    *to = now;
+    if (comma && parse_time(comma + 1, now, to) != 0) return -1;
+    return *from <= *to ? 0 : -1;
+}
+
+// Time of frame number 'number' of a mapped tier
+static int64_t frame_time(const HistoryHeader *h, uint64_t number) {
+    const int64_t *times = (const int64_t *)((const char *)h + h->time_offset);
+    return times[number % h->capacity];
+}
+
+// First frame number in [lo, hi) whose time is >= t (or > t when 'after')
+static uint64_t search_time(const HistoryHeader *h, uint64_t lo, uint64_t hi, int64_t t, bool after) {
+    while (lo < hi) {
+        uint64_t mid = lo + (hi - lo) / 2;
+        int64_t value = frame_time(h, mid);
+        if (value < t || (after && value == t)) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+int history_query(const char *dir, time_t from, time_t to, HistoryRange *range) {
+    if (!dir || !range) return -1;
+    memset(range, 0, sizeof(*range));
+
+    bool any = false;
+    for (int t = 0; t < HISTORY_TIERS; t++) {
+        char path[PATH_MAX];
+        tier_path(path, sizeof(path), dir, t);
+        int fd = open(path, O_RDONLY | O_CLOEXEC);
+        if (fd < 0) continue;
+        struct stat st;
+        if (fstat(fd, &st) != 0 || (size_t)st.st_size < HISTORY_PAGE) {
+            close(fd);
+            continue;
+        }
+
+        // Mapping reads nothing: only the pages the search touches are loaded
+        size_t size = (size_t)st.st_size;
+        void *map = mmap(NULL, size, PROT_READ, MAP_SHARED, fd, 0);
+        close(fd);
+        if (map == MAP_FAILED) continue;
+        const HistoryHeader *h = (const HistoryHeader *)map;
+        if (!header_valid(h, size)) {
+            munmap(map, size);
+            continue;
+        }
+        any = true;
+
+        uint64_t written = atomic_load_explicit(&((HistoryHeader *)map)->written, memory_order_acquire);
+        uint64_t held = written < h->capacity ? written : h->capacity;
+        uint64_t oldest = written - held;
+        uint64_t first = search_time(h, oldest, written, (int64_t)from, false);
+        uint64_t end = search_time(h, first, written, (int64_t)to, true);
+        if (end == first) {
+            munmap(map, size);
+            continue;
+        }
+
+        // A coarser tier with frames of the window replaces a finer one
+        if (range->header) {
+            munmap((void *)range->header, range->map_size);
+        }
+        range->tier = t;
+        range->header = h;
+        range->map_size = size;
+        range->written = written;
+        range->first = first;
+        range->count = (int)(end - first < INT_MAX ? end - first : INT_MAX);
+        // Coarser tiers are only tried if this one lost frames of the window to the ring
+        if (written <= h->capacity || frame_time(h, oldest) <= (int64_t)from) break;
+    }
+    if (!any) return -1;
+    return range->count;
+}
+
+int history_load(const HistoryRange *range, int index, ProcessInfo processes[], int max_processes,
+                 sysinfo_t *sysinfo, time_t *when) {
+    if (!range || !range->header || index < 0 || index >= range->count ||
+        !processes || !sysinfo) return -1;
+
+    const HistoryHeader *h = range->header;
+    uint64_t number = range->first + (uint64_t)index;
+    uint64_t written = atomic_load_explicit(&((HistoryHeader *)h)->written, memory_order_acquire);
+    if (written - number > h->capacity) return -1;  // The ring went past it
+
+    // Copy, then check the writer did not start reusing the slot meanwhile
+    static HistoryFrame frame;
+    const HistoryFrame *frames = (const HistoryFrame *)((const char *)h + h->frame_offset);
+    int64_t t = frame_time(h, number);
+    atomic_thread_fence(memory_order_acquire);
+    frame = frames[number % h->capacity];
+    atomic_thread_fence(memory_order_acquire);
+    if (t == 0 || frame_time(h, number) != t || frame.time != t) return -1;
+
+    memset(sysinfo, 0, sizeof(*sysinfo));
+    sysinfo->total_mem = frame.total_mem;
+    sysinfo->used_mem = frame.used_mem;
+    sysinfo->available_mem = frame.available_mem;
+    sysinfo->free_mem = frame.available_mem;
+    sysinfo->cached_mem = frame.cached_mem;
+    sysinfo->shared_mem = frame.shared_mem;
+    sysinfo->swap_total = frame.swap_total;
+    sysinfo->swap_used = frame.swap_used;
+    sysinfo->uptime = frame.uptime;
+    sysinfo->mem_usage_percent = frame.mem_usage_percent;
+    sysinfo->cpu_usage_percent = frame.cpu_usage_percent;
+    sysinfo->total_processes = frame.total_processes;
+
+    // Register the rows so per-PID caches (search, cgroups) work as after a scan
+    int count = (int)frame.count < max_processes ? (int)frame.count : max_processes;
+    proc_table_begin_scan();
+    for (int i = 0; i < count; i++) {
+        ProcessInfo *p = &processes[i];
+        memset(p, 0, sizeof(*p));
+        p->pid = frame.pid[i];
+        p->ppid = frame.ppid[i];
+        p->uid = frame.uid[i];
+        get_username(p->uid, p->user, MAX_NAME_LEN);
+        snprintf(p->name, MAX_NAME_LEN, "%.*s", HISTORY_NAME_LEN, frame.name[i]);
+        snprintf(p->cmdline, MAX_CMDLINE_LEN, "%s", p->name);  // Command lines are not recorded
+        p->state = frame.state[i];
+        p->cpu_usage = frame.cpu_usage[i];
+        p->mem_usage = frame.mem_usage[i];
+        p->rss = frame.rss[i];
+        p->vsize = frame.vsize[i];
+        p->start_ticks = frame.start_ticks[i];
+        proc_table_upsert(p->pid, p->start_ticks);
+    }
+    proc_table_end_scan();
+
+    if (when) *when = (time_t)t;
+    return count;
+}
+
+void history_query_close(HistoryRange *range) {
+    if (!range || !range->header) return;
+    munmap((void *)range->header, range->map_size);
+    memset(range, 0, sizeof(*range));
+}
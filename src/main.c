@@ -8,11 +8,36 @@
 #include <sys/select.h>
 #include <string.h>
 #include <sys/types.h>
+#include <stdbool.h>
+#include <limits.h>
 #include "../include/common.h"
 #include "../include/process_monitor.h"
 #include "../include/display.h"
 #include "../include/signal_handler.h"
 #include "../include/config.h"
+#include "../include/refresh_budget.h"
+#include "../include/proc_events.h"
+#include "../include/data_source.h"
+#include "../include/benchmark.h"
+#include "../include/threads.h"
+#include "../include/filter.h"
+#include "../include/batch.h"
+#include "../include/search.h"
+#include "../include/group.h"
+#include "../include/cgroup.h"
+#include "../include/cpu_stats.h"
+#include "../include/remote.h"
+#include "../include/shm_snapshot.h"
+#include "../include/alerts.h"
+#include "../include/tree.h"
+#include "../include/cursor.h"
+#include "../include/detail.h"
+#include "../include/sockets.h"
+#include "../include/watch.h"
+#include "../include/churn.h"
+#include "../include/history.h"
+
+#define TICK_MS 100  // Main loop tick (key polling + sleep)
 
 extern volatile sig_atomic_t keep_running;
 
@@ -85,88 +110,444 @@ char get_keypress() {
     return c;
 }
 
-int main() {
-    setup_signal_handler();
-    setup_terminal();
+// Prompts for a line of input on a cleared screen, then returns to raw mode.
+// Returns 1 if a line was read (trailing newline stripped), 0 otherwise.
+int prompt_line(const char *prompt, char *buffer, size_t size) {
+    printf("\x1b[2J\x1b[H");
+    printf("%s", prompt);
+    printf("\x1b[?25h");
+    fflush(stdout);
+    
+    tcsetattr(STDIN_FILENO, TCSANOW, &orig_termios);
     
+    int ok = fgets(buffer, (int)size, stdin) != NULL;
+    if (ok) {
+        buffer[strcspn(buffer, "\n")] = '\0';
+    }
+    
+    struct termios new_termios = orig_termios;
+    new_termios.c_lflag &= ~(ICANON | ECHO);
+    new_termios.c_cc[VMIN] = 0;
+    new_termios.c_cc[VTIME] = 0;
+    tcsetattr(STDIN_FILENO, TCSANOW, &new_termios);
+    printf("\x1b[?25l");
+    
+    return ok;
+}
+
+// PID typed at a prompt; an empty line means the selected process
+pid_t pid_or_selected(const char *input, pid_t selected) {
+    return (input[strspn(input, " \t")] == '\0') ? selected : (pid_t)atoi(input);
+}
+
+// Compiles the on-screen filter: the F user filter AND the typed expression
+void compile_view_filter(ProcessFilter *filter, const char *expr, const char *user) {
+    char combined[MAX_FILTER_LEN];
+    if (user[0] != '\0' && expr[0] != '\0') {
+        snprintf(combined, sizeof(combined), "user=%.*s %s", MAX_FILTER_LEN / 2, user, expr);
+    } else if (user[0] != '\0') {
+        snprintf(combined, sizeof(combined), "user=%.*s", MAX_FILTER_LEN / 2, user);
+    } else {
+        snprintf(combined, sizeof(combined), "%s", expr);
+    }
+    
+    if (filter_compile(combined, filter, NULL, 0) != 0) {
+        filter_compile(NULL, filter, NULL, 0);  // e.g. a username with spaces
+    }
+}
+
+// Maps the default_sort config letter to a sort mode
+SortMode sort_mode_from_key(char key) {
+    switch (toupper((unsigned char)key)) {
+        case 'P': return SORT_BY_PID;
+        case 'C': return SORT_BY_CPU;
+        case 'U': return SORT_BY_USER;
+        default:  return SORT_BY_MEM;
+    }
+}
+
+void print_usage(const char *prog) {
+    printf("Usage: %s [options]\n\n", prog);
+    printf("Options:\n");
+    printf("  --filter EXPR     Only show processes matching EXPR (e.g. \"user=root cpu>5\")\n");
+    printf("  --batch           Print one snapshot (rates over 1s) as plain text and exit\n");
+    printf("  --benchmark [N]   Time N full scans with every data source, then exit\n");
+    printf("  --daemon [SOCKET] Scan once per interval and serve snapshots on a Unix socket\n");
+    printf("  --connect [SOCKET] Show the processes of a running --daemon instead of scanning\n");
+    printf("  --exporter [PORT] Run the daemon with Prometheus /metrics on 127.0.0.1 (default 9273)\n");
+    printf("  --history-range R Browse the recorded history of R (e.g. \"-8h\", \"02:10,02:20\")\n");
+    printf("  -h, --help        Show this help and exit\n");
+}
+
+int main(int argc, char *argv[]) {
     // Load configuration
     const char* config_path = config_get_path();
     config_load(config_path);
     config_apply_theme(global_config.theme);
     
+    // Non-interactive modes
+    char filter_expr[MAX_FILTER_LEN] = "";
+    bool batch_mode = false;
+    bool daemon_mode = false;
+    bool remote_mode = false;
+    const char *history_spec = NULL;
+    char socket_path[108] = "";  // sizeof(sockaddr_un.sun_path)
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--filter") == 0 && i + 1 < argc) {
+            snprintf(filter_expr, sizeof(filter_expr), "%s", argv[++i]);
+        } else if (strcmp(argv[i], "--batch") == 0) {
+            batch_mode = true;
+        } else if (strcmp(argv[i], "--daemon") == 0 || strcmp(argv[i], "--connect") == 0) {
+            daemon_mode = (argv[i][2] == 'd');
+            remote_mode = !daemon_mode;
+            if (i + 1 < argc && argv[i + 1][0] != '-') {
+                snprintf(socket_path, sizeof(socket_path), "%s", argv[++i]);
+            }
+        } else if (strcmp(argv[i], "--history-range") == 0 && i + 1 < argc) {
+            history_spec = argv[++i];
+        } else if (strcmp(argv[i], "--exporter") == 0) {
+            // Metrics are served by the daemon loop
+            daemon_mode = true;
+            if (i + 1 < argc && is_pid(argv[i + 1])) {
+                global_config.exporter_port = atoi(argv[++i]);
+            }
+            if (global_config.exporter_port <= 0) {
+                global_config.exporter_port = 9273;
+            }
+        } else if (strcmp(argv[i], "--benchmark") == 0) {
+            int iterations = 20;
+            if (i + 1 < argc && is_pid(argv[i + 1])) {
+                iterations = atoi(argv[++i]);
+            }
+            return run_benchmark(iterations);
+        } else if (strcmp(argv[i], "-h") == 0 || strcmp(argv[i], "--help") == 0) {
+            print_usage(argv[0]);
+            return 0;
+        } else {
+            fprintf(stderr, "Unknown option: %s\n", argv[i]);
+            print_usage(argv[0]);
+            return 1;
+        }
+    }
+    
+    // Validate the filter before touching the terminal so errors stay readable
+    ProcessFilter view_filter;
+    char filter_error[128];
+    if (filter_compile(filter_expr, &view_filter, filter_error, sizeof(filter_error)) != 0) {
+        fprintf(stderr, "Invalid filter: %s\n", filter_error);
+        return 1;
+    }
+    
+    if (batch_mode) {
+        return run_batch(&view_filter, sort_mode_from_key(global_config.default_sort));
+    }
+    
+    if (socket_path[0] == '\0') {
+        remote_default_path(socket_path, sizeof(socket_path));
+    }
+    if (daemon_mode) {
+        return run_daemon(socket_path);
+    }
+    char alert_error[512];
+    if (alerts_compile((const char (*)[ALERT_RULE_LEN])global_config.alert_rules,
+                       global_config.alert_rule_count, alert_error, sizeof(alert_error)) != 0) {
+        fprintf(stderr, "Invalid %s\n", alert_error);
+        return 1;
+    }
+    if (remote_mode && remote_connect(socket_path) != 0) {
+        fprintf(stderr, "No AltTasker daemon on %s (start one with --daemon)\n", socket_path);
+        return 1;
+    }
+    
+    // History mode: the rows come from recorded frames instead of scans
+    bool history_mode = history_spec != NULL && !remote_mode;
+    static HistoryRange history_range;
+    char history_dir[PATH_MAX];
+    history_get_dir(history_dir, sizeof(history_dir));
+    if (history_mode) {
+        time_t from, to;
+        if (history_parse_range(history_spec, &from, &to) != 0) {
+            fprintf(stderr, "Invalid history range: %s\n", history_spec);
+            return 1;
+        }
+        int frames = history_query(history_dir, from, to, &history_range);
+        if (frames < 0) {
+            fprintf(stderr, "No history in %s (record with history=true)\n", history_dir);
+            return 1;
+        }
+        if (frames == 0) {
+            char from_str[32], to_str[32];
+            strftime(from_str, sizeof(from_str), "%Y-%m-%d %H:%M:%S", localtime(&from));
+            strftime(to_str, sizeof(to_str), "%Y-%m-%d %H:%M:%S", localtime(&to));
+            fprintf(stderr, "No history between %s and %s in %s\n", from_str, to_str, history_dir);
+            history_query_close(&history_range);
+            return 1;
+        }
+    }
+    int history_index = 0;      // Frame of the window on screen
+    time_t history_time = 0;    // Its time
+    bool live = !remote_mode && !history_mode;
+    
+    setup_signal_handler();
+    setup_terminal();
+    
+    // Pick the scanner backend (auto = fastest available, procfs as fallback)
+    data_source_select(global_config.data_source);
+    
     ProcessInfo processes[MAX_PROCESS];
     ProcessInfo filtered_processes[MAX_PROCESS];
     sysinfo_t sysinfo;
+    static CpuStats cpu_stats;  // Per-CPU arrays are too large for the stack
+    memset(&sysinfo, 0, sizeof(sysinfo));
+    cpu_stats_sample(&cpu_stats);  // Baseline, so the first frame already has CPU shares
     
     SortMode current_sort = SORT_BY_MEM;
     char filter_user[MAX_NAME_LEN] = "";
     int refresh_counter = 0;
-    const int REFRESH_INTERVAL = global_config.refresh_interval * 10;  // Convert seconds to 100ms ticks
+    
+    // Adaptive refresh: stretches/shrinks the interval to stay under the CPU budget
+    RefreshBudget budget;
+    refresh_budget_init(&budget, global_config.cpu_budget,
+                        global_config.refresh_interval * 1000,
+                        global_config.min_refresh_interval * 1000,
+                        global_config.max_refresh_interval * 1000);
+    int refresh_ticks = budget.interval_ms / TICK_MS;  // Effective interval in 100ms ticks
     int process_count = 0;  // Store for search feature
     int scroll_offset = 0;  // Current scroll position
     int display_count = 0;  // Number of processes after filtering
     const int VISIBLE_PROCESSES = global_config.visible_processes;  // How many to show per page
     
+    // Event-driven mode: fork/exec/exit between scans, full rescans far less often.
+    // Without CAP_NET_ADMIN the subscription fails and we keep polling /proc.
+    time_t next_full_scan = 0;
+    
+    // Thread view: threads of one expanded process, read on demand
+    static ProcessInfo thread_rows[MAX_THREADS];
+    static ProcessInfo expanded_rows[MAX_PROCESS + MAX_THREADS];
+    static ProcessInfo tree_rows[MAX_PROCESS];  // Tree view order, folded subtrees merged
+    
+    // Selected row: follows its process (pid, start time) across re-sorts
+    Cursor cursor = {0, 0, 0, false};
+    int cursor_step = 0;  // Pending move, applied once the new row order is known
+    char selected_name[MAX_NAME_LEN] = "";
+    
+    // Detail pane of the selected process, read by a background thread
+    bool show_detail = false;
+    ProcessDetail detail;
+    memset(&detail, 0, sizeof(detail));
+    
+    // Watch pane: one process sampled every few ms by its own thread
+    static WatchView watch_view;
+    int watch_lines = 0;  // Height of the pane at the last full redraw
+    pid_t expanded_pid = 0;
+    int thread_count = 0;
+    bool remote_connected = true;
+    if (global_config.proc_events && live) {
+        proc_events_open();
+    }
+    if (global_config.shm_snapshot && live) {
+        shm_snapshot_open();  // Another instance may already be the publisher
+    }
+    if (global_config.history && live) {
+        history_open(history_dir, global_config.history_max_mb);  // Or a daemon already records
+    }
+    
+    // Grouping: one aggregated row per user/command/subtree, one group expandable
+    static ProcessGroup groups[MAX_PROCESS];
+    static int group_of[MAX_PROCESS];
+    static ProcessInfo group_members[MAX_PROCESS];
+    GroupMode group_mode = GROUP_NONE;
+    int group_count = 0;
+    char expanded_group[MAX_NAME_LEN] = "";
+    
+    // Live search over "name\ncmdline", narrowed on every key typed
+    search_init();
+    char search_query[MAX_NAME_LEN] = "";
+    SearchMode search_mode = SEARCH_IGNORE_CASE;
+    bool search_editing = false;
+    bool search_invalid = false;
+    
     while (keep_running) {
         char key = get_keypress();
+        bool redraw = false;  // Redraw from the current data, without rescanning
         
-        if (key != 0) {
+        if (key != 0 && search_editing) {
+            size_t len = strlen(search_query);
+            if (key == 27) {  // Esc: drop the search
+                search_query[0] = '\0';
+                search_editing = false;
+            } else if (key == '\n' || key == '\r') {  // Enter: keep the results
+                search_editing = false;
+            } else if (key == 127 || key == '\b') {
+                if (len > 0) search_query[len - 1] = '\0';
+            } else if (key == '\t') {
+                search_mode = (search_mode + 1) % 3;
+            } else if (isprint((unsigned char)key) && len + 1 < sizeof(search_query)) {
+                search_query[len] = key;
+                search_query[len + 1] = '\0';
+            }
+            search_invalid = search_set_query(search_query, search_mode) != 0;
+            scroll_offset = 0;
+            redraw = true;
+        } else if (key != 0) {
             switch (key) {
                 case 'w':  // Up arrow
-                    if (scroll_offset > 0) {
+                    if (group_mode == GROUP_NONE) {
+                        cursor_step = -1;  // Moving the cursor only needs a redraw
+                        redraw = true;
+                    } else if (scroll_offset > 0) {
                         scroll_offset--;
-                        refresh_counter = REFRESH_INTERVAL;
+                        refresh_counter = refresh_ticks;
                     }
                     break;
                 case 'x':  // Down arrow
-                    if (scroll_offset < display_count - VISIBLE_PROCESSES && display_count > VISIBLE_PROCESSES) {
+                    if (group_mode == GROUP_NONE) {
+                        cursor_step = 1;
+                        redraw = true;
+                    } else if (scroll_offset < display_count - VISIBLE_PROCESSES && display_count > VISIBLE_PROCESSES) {
                         scroll_offset++;
-                        refresh_counter = REFRESH_INTERVAL;
+                        refresh_counter = refresh_ticks;
                     }
                     break;
                 case 'W':  // Page Up
+                    cursor_step = -VISIBLE_PROCESSES;
                     scroll_offset -= VISIBLE_PROCESSES;
                     if (scroll_offset < 0) scroll_offset = 0;
-                    refresh_counter = REFRESH_INTERVAL;
+                    redraw = true;
                     break;
                 case 'X':  // Page Down
+                    cursor_step = VISIBLE_PROCESSES;
                     scroll_offset += VISIBLE_PROCESSES;
                     if (scroll_offset > display_count - VISIBLE_PROCESSES) {
                         scroll_offset = (display_count > VISIBLE_PROCESSES) ? display_count - VISIBLE_PROCESSES : 0;
                     }
-                    refresh_counter = REFRESH_INTERVAL;
+                    redraw = true;
                     break;
                 case 'h':  // Home
+                    cursor_step = INT_MIN;
                     scroll_offset = 0;
-                    refresh_counter = REFRESH_INTERVAL;
+                    redraw = true;
                     break;
                 case 'e':  // End
+                    cursor_step = INT_MAX;
                     scroll_offset = (display_count > VISIBLE_PROCESSES) ? display_count - VISIBLE_PROCESSES : 0;
-                    refresh_counter = REFRESH_INTERVAL;
+                    redraw = true;
                     break;
                 case 'p':
                 case 'P':
                     current_sort = SORT_BY_PID;
                     scroll_offset = 0;  // Reset scroll on sort change
-                    refresh_counter = REFRESH_INTERVAL;
+                    refresh_counter = refresh_ticks;
                     break;
                 case 'c':
                 case 'C':
                     current_sort = SORT_BY_CPU;
                     scroll_offset = 0;  // Reset scroll on sort change
-                    refresh_counter = REFRESH_INTERVAL;
+                    refresh_counter = refresh_ticks;
                     break;
                 case 'm':
                 case 'M':
                     current_sort = SORT_BY_MEM;
                     scroll_offset = 0;  // Reset scroll on sort change
-                    refresh_counter = REFRESH_INTERVAL;
+                    refresh_counter = refresh_ticks;
                     break;
                 case 'u':
                 case 'U':
                     current_sort = SORT_BY_USER;
                     scroll_offset = 0;  // Reset scroll on sort change
-                    refresh_counter = REFRESH_INTERVAL;
+                    refresh_counter = refresh_ticks;
+                    break;
+                case 'o':
+                case 'O':
+                    // Sort by disk reads; pressing again switches to writes
+                    current_sort = (current_sort == SORT_BY_IO_READ) ? SORT_BY_IO_WRITE : SORT_BY_IO_READ;
+                    if (!global_config.show_io_columns) {
+                        global_config.show_io_columns = true;  // Rates are needed to sort
+                        config_save(config_path);
+                    }
+                    scroll_offset = 0;  // Reset scroll on sort change
+                    refresh_counter = refresh_ticks;
+                    break;
+                case 'i':
+                case 'I':
+                    // Toggle I/O columns (and the /proc/[pid]/io + diskstats reads)
+                    global_config.show_io_columns = !global_config.show_io_columns;
+                    if (!global_config.show_io_columns &&
+                        (current_sort == SORT_BY_IO_READ || current_sort == SORT_BY_IO_WRITE)) {
+                        current_sort = SORT_BY_MEM;
+                    }
+                    config_save(config_path);
+                    refresh_counter = refresh_ticks;
+                    break;
+                case 'y':
+                case 'Y':
+                    // Watch the selected process at a high rate ('Y' adds its threads)
+                    if (watch_active()) {
+                        watch_stop();
+                    } else if (group_mode == GROUP_NONE && live && cursor.pid > 0) {
+                        watch_start(cursor.pid, cursor.start_ticks, global_config.watch_interval_ms,
+                                    key == 'Y');
+                    }
+                    redraw = true;
+                    break;
+                case 'b':
+                case 'B':
+                    // Sort by run-queue wait, then context switches, then faults
+                    if (current_sort == SORT_BY_SCHED_WAIT) {
+                        current_sort = SORT_BY_CTX_SWITCHES;
+                    } else if (current_sort == SORT_BY_CTX_SWITCHES) {
+                        current_sort = SORT_BY_FAULTS;
+                    } else {
+                        current_sort = SORT_BY_SCHED_WAIT;
+                    }
+                    if (!global_config.show_sched_columns) {
+                        global_config.show_sched_columns = true;  // Rates are needed to sort
+                        config_save(config_path);
+                    }
+                    scroll_offset = 0;  // Reset scroll on sort change
+                    refresh_counter = refresh_ticks;
+                    break;
+                case 'z':
+                case 'Z':
+                    // Toggle latency columns (schedstat + full status reads)
+                    global_config.show_sched_columns = !global_config.show_sched_columns;
+                    if (!global_config.show_sched_columns &&
+                        (current_sort == SORT_BY_SCHED_WAIT || current_sort == SORT_BY_CTX_SWITCHES ||
+                         current_sort == SORT_BY_FAULTS)) {
+                        current_sort = SORT_BY_MEM;
+                    }
+                    config_save(config_path);
+                    refresh_counter = refresh_ticks;
+                    break;
+                case 'a':
+                case 'A':
+                    // Toggle PSS/USS/swap columns (smaps_rollup of the visible rows)
+                    global_config.show_pss_columns = !global_config.show_pss_columns;
+                    config_save(config_path);
+                    refresh_counter = refresh_ticks;
+                    break;
+                case 'd':
+                case 'D':
+                    // Toggle the detail pane of the selected process
+                    show_detail = !show_detail && detail_open() == 0;
+                    if (!show_detail) detail_select(0, 0);
+                    redraw = true;
+                    break;
+                case 'n':
+                case 'N':
+                    // Toggle kernel threads; rescan so they come back or go at once
+                    global_config.hide_kernel_threads = !global_config.hide_kernel_threads;
+                    config_save(config_path);
+                    churn_reset();  // Kernel threads coming or going are not churn
+                    next_full_scan = 0;
+                    refresh_counter = refresh_ticks;
+                    break;
+                case 'l':
+                case 'L':
+                    // Toggle socket/TCP connection columns (visible rows only)
+                    global_config.show_socket_columns = !global_config.show_socket_columns;
+                    config_save(config_path);
+                    refresh_counter = refresh_ticks;
                     break;
                 case 't':
                 case 'T':
@@ -174,14 +555,14 @@ int main() {
                     global_config.theme = (global_config.theme + 1) % 5;  // 5 themes total
                     config_apply_theme(global_config.theme);
                     config_save(config_path);
-                    refresh_counter = REFRESH_INTERVAL;
+                    refresh_counter = refresh_ticks;
                     break;
                 case 'v':
                 case 'V':
                     // Toggle tree view
                     global_config.show_tree_view = !global_config.show_tree_view;
                     config_save(config_path);
-                    refresh_counter = REFRESH_INTERVAL;
+                    refresh_counter = refresh_ticks;
                     break;
                 case 'f':
                 case 'F':
@@ -206,21 +587,126 @@ int main() {
                     tcsetattr(STDIN_FILENO, TCSANOW, &new_termios);
                     printf("\x1b[?25l");
                     
+                    compile_view_filter(&view_filter, filter_expr, filter_user);
+                    scroll_offset = 0;  // Reset scroll on filter change
+                    refresh_counter = refresh_ticks;
+                    break;
+                case '\\': {
+                    // Filter expression, compiled once here and applied every refresh
+                    char input[MAX_FILTER_LEN];
+                    char prompt[2 * MAX_FILTER_LEN];
+                    snprintf(prompt, sizeof(prompt),
+                             COLOR_CYAN "🔎 Filter Processes\n" COLOR_RESET
+                             "Fields: pid ppid uid cpu mem rss virt read write wait csw icsw minf majf state user name cmd\n"
+                             "Operators: = != < <= > >= ~   Example: user=postgres cpu>20 rss>500M name~java\n"
+                             "Current: %s\n"
+                             COLOR_YELLOW "Filter (Enter to clear): " COLOR_RESET,
+                             filter_expr[0] != '\0' ? filter_expr : "(none)");
+                    if (prompt_line(prompt, input, sizeof(input))) {
+                        ProcessFilter test;
+                        if (filter_compile(input, &test, filter_error, sizeof(filter_error)) == 0) {
+                            snprintf(filter_expr, sizeof(filter_expr), "%s", input);
+                        } else {
+                            printf(COLOR_RED "\n❌ %s\n" COLOR_RESET, filter_error);
+                            printf(COLOR_CYAN "Press Enter to continue..." COLOR_RESET);
+                            fflush(stdout);
+                            tcsetattr(STDIN_FILENO, TCSANOW, &orig_termios);
+                            getchar();
+                            struct termios raw = orig_termios;
+                            raw.c_lflag &= ~(ICANON | ECHO);
+                            raw.c_cc[VMIN] = 0;
+                            raw.c_cc[VTIME] = 0;
+                            tcsetattr(STDIN_FILENO, TCSANOW, &raw);
+                        }
+                    }
+                    compile_view_filter(&view_filter, filter_expr, filter_user);
                     scroll_offset = 0;  // Reset scroll on filter change
-                    refresh_counter = REFRESH_INTERVAL;
+                    refresh_counter = refresh_ticks;
                     break;
+                }
                 case 'r':
                 case 'R':
                     filter_user[0] = '\0';
+                    filter_expr[0] = '\0';
+                    compile_view_filter(&view_filter, filter_expr, filter_user);
+                    search_query[0] = '\0';
+                    search_set_query(search_query, search_mode);
                     scroll_offset = 0;  // Reset scroll on filter reset
-                    refresh_counter = REFRESH_INTERVAL;
+                    refresh_counter = refresh_ticks;
+                    break;
+                case 'g':
+                case 'G':
+                    // Cycle grouping: none -> user -> command -> parent subtree -> cgroup
+                    group_mode = (group_mode + 1) % 5;
+                    if (group_mode == GROUP_BY_CGROUP &&
+                        cgroup_refresh(processes, process_count) < 0) {
+                        group_mode = GROUP_NONE;  // No cgroup v2 hierarchy mounted
+                    }
+                    expanded_group[0] = '\0';
+                    scroll_offset = 0;
+                    redraw = true;
                     break;
+                case '+': {
+                    if (group_mode == GROUP_NONE && global_config.show_tree_view) {
+                        // Fold/unfold the subtree of one process
+                        char pid_input[32];
+                        char prompt[256];
+                        snprintf(prompt, sizeof(prompt),
+                                 COLOR_CYAN "🌳 Fold Subtree\n" COLOR_RESET
+                                 COLOR_YELLOW "Enter PID to fold/unfold (Enter = selected %d, 0 to unfold all): "
+                                 COLOR_RESET, cursor.pid);
+                        if (prompt_line(prompt, pid_input, sizeof(pid_input))) {
+                            pid_t pid = pid_or_selected(pid_input, cursor.pid);
+                            if (pid > 0) {
+                                tree_toggle(pid);
+                            } else {
+                                tree_expand_all();
+                            }
+                        }
+                        redraw = true;
+                        break;
+                    }
+                    // Expand/collapse the members of one group
+                    if (group_mode == GROUP_NONE || group_count == 0) break;
+                    char number_input[32];
+                    if (prompt_line(COLOR_CYAN "📂 Expand Group\n" COLOR_RESET
+                                    COLOR_YELLOW "Enter group # to expand (0 to collapse): " COLOR_RESET,
+                                    number_input, sizeof(number_input))) {
+                        int number = atoi(number_input);
+                        if (number >= 1 && number <= group_count &&
+                            strcmp(expanded_group, groups[number - 1].key) != 0) {
+                            memcpy(expanded_group, groups[number - 1].key, MAX_NAME_LEN);
+                        } else {
+                            expanded_group[0] = '\0';
+                        }
+                    }
+                    redraw = true;
+                    break;
+                }
+                case 'H': {
+                    // Expand/collapse the threads of a process
+                    char pid_input[32];
+                    char prompt[256];
+                    snprintf(prompt, sizeof(prompt),
+                             COLOR_CYAN "🧵 Show Threads\n" COLOR_RESET
+                             COLOR_YELLOW "Enter PID to expand (Enter = selected %d, 0 to collapse): " COLOR_RESET,
+                             cursor.pid);
+                    if (prompt_line(prompt, pid_input, sizeof(pid_input))) {
+                        pid_t pid = pid_or_selected(pid_input, cursor.pid);
+                        expanded_pid = (pid == expanded_pid) ? 0 : pid;
+                        thread_count = 0;
+                    }
+                    refresh_counter = refresh_ticks;
+                    break;
+                }
                 case 'k':
                 case 'K':
+                    if (history_mode) break;  // A recorded PID may belong to another process by now
                     // Kill process - prompt for PID
                     printf("\x1b[2J\x1b[H");
                     printf(COLOR_RED "⚠️  Kill Process\n" COLOR_RESET);
-                    printf(COLOR_YELLOW "Enter PID to kill (or 0 to cancel): " COLOR_RESET);
+                    printf(COLOR_YELLOW "Enter PID to kill (Enter = selected %d %s, 0 to cancel): " COLOR_RESET,
+                           cursor.pid, selected_name);
                     printf("\x1b[?25h");
                     fflush(stdout);
                     
@@ -228,7 +714,8 @@ int main() {
                     
                     char pid_input[32];
                     if (fgets(pid_input, sizeof(pid_input), stdin)) {
-                        int pid_to_kill = atoi(pid_input);
+                        pid_input[strcspn(pid_input, "\n")] = '\0';
+                        int pid_to_kill = pid_or_selected(pid_input, cursor.pid);
                         if (pid_to_kill > 0) {
                             if (kill(pid_to_kill, SIGTERM) == 0) {
                                 printf(COLOR_GREEN "\n✅ Signal sent to process %d\n" COLOR_RESET, pid_to_kill);
@@ -247,63 +734,30 @@ int main() {
                     tcsetattr(STDIN_FILENO, TCSANOW, &new_termios_k);
                     printf("\x1b[?25l");
                     
-                    refresh_counter = REFRESH_INTERVAL;
+                    refresh_counter = refresh_ticks;
                     break;
                 case 's':
                 case 'S':
-                    // Search for process
-                    printf("\x1b[2J\x1b[H");
-                    printf(COLOR_CYAN "🔍 Search Process\n" COLOR_RESET);
-                    printf(COLOR_YELLOW "Enter process name to search: " COLOR_RESET);
-                    printf("\x1b[?25h");
-                    fflush(stdout);
-                    
-                    tcsetattr(STDIN_FILENO, TCSANOW, &orig_termios);
-                    
-                    char search_term[MAX_NAME_LEN];
-                    if (fgets(search_term, sizeof(search_term), stdin)) {
-                        size_t slen = strlen(search_term);
-                        if (slen > 0 && search_term[slen-1] == '\n') {
-                            search_term[slen-1] = '\0';
-                        }
-                        
-                        if (strlen(search_term) > 0) {
-                            // Search in current processes
-                            printf(COLOR_CYAN "\nSearching for: '%s'\n" COLOR_RESET, search_term);
-                            printf(COLOR_CYAN "═══════════════════════════════════════\n" COLOR_RESET);
-                            
-                            int found = 0;
-                            for (int i = 0; i < process_count && i < MAX_PROCESS; i++) {
-                                if (strstr(processes[i].name, search_term) != NULL || 
-                                    strstr(processes[i].cmdline, search_term) != NULL) {
-                                    printf(COLOR_GREEN "PID: %-6d" COLOR_RESET " User: %-10s Mem: %5.2f%% Cmd: %s\n",
-                                           processes[i].pid, processes[i].user, 
-                                           processes[i].mem_usage, processes[i].cmdline);
-                                    found++;
-                                }
-                            }
-                            
-                            if (found == 0) {
-                                printf(COLOR_YELLOW "No processes found matching '%s'\n" COLOR_RESET, search_term);
-                            } else {
-                                printf(COLOR_CYAN "═══════════════════════════════════════\n" COLOR_RESET);
-                                printf(COLOR_GREEN "Found %d process(es)\n" COLOR_RESET, found);
-                            }
-                            
-                            printf(COLOR_CYAN "\nPress Enter to continue..." COLOR_RESET);
-                            getchar();
-                        }
-                    }
-                    
-                    struct termios new_termios_s = orig_termios;
-                    new_termios_s.c_lflag &= ~(ICANON | ECHO);
-                    new_termios_s.c_cc[VMIN] = 0;
-                    new_termios_s.c_cc[VTIME] = 0;
-                    tcsetattr(STDIN_FILENO, TCSANOW, &new_termios_s);
-                    printf("\x1b[?25l");
-                    
-                    refresh_counter = REFRESH_INTERVAL;
+                    // Live search: following keys edit the query
+                    search_editing = true;
+                    redraw = true;
                     break;
+                case ',':
+                case '.':
+                case '<':
+                case '>': {
+                    // History mode: previous/next frame, or a tenth of the window
+                    if (!history_mode) break;
+                    int step = (history_range.count + 9) / 10;
+                    if (key == ',') history_index--;
+                    if (key == '.') history_index++;
+                    if (key == '<') history_index -= step;
+                    if (key == '>') history_index += step;
+                    if (history_index < 0) history_index = 0;
+                    if (history_index >= history_range.count) history_index = history_range.count - 1;
+                    refresh_counter = refresh_ticks;
+                    break;
+                }
                 case 'q':
                 case 'Q':
                     keep_running = 0;
@@ -311,49 +765,311 @@ int main() {
             }
         }
         
-        if (++refresh_counter >= REFRESH_INTERVAL) {
-            refresh_counter = 0;
+        // Apply process arrival/exit events that happened since the last tick
+        bool events_changed = false;
+        if (proc_events_active()) {
+            int changes = proc_events_apply(processes, &process_count, MAX_PROCESS,
+                                            sysinfo.total_mem);
+            if (changes < 0) {
+                // Events were dropped - fall back to a full /proc walk right away
+                next_full_scan = 0;
+                refresh_counter = refresh_ticks;
+            } else if (changes > 0) {
+                events_changed = true;
+            }
+        }
+        
+        // Detail sections arrive one by one from the reader thread
+        if (show_detail && detail_get(&detail)) {
+            redraw = true;
+        }
+        // Watch samples arrive faster than a tick: between table redraws only the
+        // pane (the last lines of the screen) is drawn again, while its height holds
+        bool watch_tick = watch_active() && watch_get(&watch_view);
+        
+        bool do_refresh = (++refresh_counter >= refresh_ticks);
+        if (watch_tick && !do_refresh && !events_changed && !redraw) {
+            if (watch_lines > 0 && display_watch_height(&watch_view) == watch_lines) {
+                printf("\x1b[%dF\x1b[J", watch_lines);  // Up to the top of the pane, clear below
+                display_watch(&watch_view);
+                fflush(stdout);
+            } else {
+                redraw = true;
+            }
+        }
+        if (do_refresh || events_changed || redraw) {
+            if (do_refresh) {
+                refresh_counter = 0;
+                refresh_budget_begin(&budget);
+                
+                if (history_mode) {
+                    // Replay: only the pages of the frame on screen are read
+                    int loaded = history_load(&history_range, history_index, processes, MAX_PROCESS,
+                                              &sysinfo, &history_time);
+                    process_count = (loaded >= 0) ? loaded : 0;
+                    if (loaded < 0) history_time = 0;  // Overwritten by the recorder meanwhile
+                } else if (remote_mode) {
+                    // Thin client: the daemon scans; a lost daemon leaves the last rows up
+                    int received = remote_receive(processes, MAX_PROCESS, &sysinfo);
+                    remote_connected = received >= 0;
+                    if (received >= 0) process_count = received;
+                    if (received > 0 && global_config.hide_kernel_threads) {
+                        int kept = 0;
+                        for (int i = 0; i < process_count; i++) {
+                            if (!processes[i].is_kernel_thread) processes[kept++] = processes[i];
+                        }
+                        process_count = kept;
+                    }
+                } else {
+                    get_system_info(&sysinfo);
+                    
+                    unsigned int scan_flags = refresh_budget_scan_flags(&budget);
+                    if (global_config.show_io_columns) {
+                        get_disk_stats(&sysinfo);
+                        scan_flags |= SCAN_READ_IO;
+                    }
+                    if (global_config.show_sched_columns) {
+                        scan_flags |= SCAN_READ_SCHED;
+                    }
+                    // Filters and alert rules on rates need them measured while the columns are hidden
+                    scan_flags |= filter_scan_flags(&view_filter) | alerts_scan_flags();
+                    if (global_config.hide_kernel_threads) {
+                        scan_flags |= SCAN_HIDE_KTHREADS;
+                    }
+                    if (proc_events_active() && time(NULL) < next_full_scan) {
+                        // Arrivals and exits come from events: only re-read known rows' stat
+                        process_count = refresh_processes(processes, process_count, sysinfo.total_mem,
+                                                          scan_flags | SCAN_SKIP_STATUS | SCAN_SKIP_CMDLINE);
+                    } else {
+                        process_count = scan_processes(processes, MAX_PROCESS, sysinfo.total_mem,
+                                                       scan_flags);
+                        next_full_scan = time(NULL) + global_config.event_rescan_interval;
+                    }
+                }
+                // Recorded frames keep their own totals; live state is not mixed in
+                if (!history_mode) {
+                    // Diff against the previous snapshot (a truncated one only up to its last PID)
+                    churn_update(processes, process_count, read_uptime());
+                    ChurnStats churn = churn_stats();
+                    sysinfo.churn_valid = churn.valid;
+                    sysinfo.start_rate = churn.start_rate;
+                    sysinfo.exit_rate = churn.exit_rate;
+                    
+                    cpu_stats_sample(&cpu_stats);
+                    sysinfo.cpu_usage_percent = cpu_share_busy(&cpu_stats.total);
+                    if (live) {
+                        shm_snapshot_publish(processes, process_count, &sysinfo);
+                        history_record(processes, process_count, &sysinfo);
+                    }
+                    alerts_evaluate(processes, process_count, &sysinfo, cpu_stats.load[0],
+                                    global_config.alert_budget_ms);
+                }
+            }
             
             printf("\x1b[2J\x1b[H");
             
-            get_system_info(&sysinfo);
-            
-            process_count = scan_processes(processes, MAX_PROCESS, sysinfo.total_mem);
-            
-            // Build process tree if enabled
-            if (global_config.show_tree_view) {
-                build_process_tree(processes, process_count);
-            }
-            
             ProcessInfo* display_processes_ptr;
-            if (strlen(filter_user) > 0) {
-                display_count = filter_processes_by_user(processes, process_count, 
-                                                         filtered_processes, filter_user);
+            if (view_filter.count > 0) {
+                display_count = filter_apply(&view_filter, processes, process_count,
+                                             filtered_processes);
                 display_processes_ptr = filtered_processes;
             } else {
                 display_count = process_count;
                 display_processes_ptr = processes;
             }
             
+            if (search_query[0] != '\0') {
+                // Only new or exec'd processes are (re)indexed
+                search_index_update(processes, process_count);
+                display_count = search_apply(display_processes_ptr, display_count, filtered_processes);
+                display_processes_ptr = filtered_processes;
+            }
+            
             sort_processes(display_processes_ptr, display_count, current_sort);
             
+            // Tree order (siblings keep the sort); folded subtrees become one row
+            if (global_config.show_tree_view && group_mode == GROUP_NONE) {
+                display_count = tree_build(display_processes_ptr, display_count,
+                                           tree_rows, MAX_PROCESS);
+                display_processes_ptr = tree_rows;
+            }
+            
+            // Aggregate into groups; members of the expanded group keep the row order
+            int member_count = 0;
+            int expanded_id = -1;
+            if (group_mode != GROUP_NONE) {
+                if (group_mode == GROUP_BY_CGROUP) {
+                    // cgroup files are read once per refresh, not on every redraw
+                    if (do_refresh) cgroup_refresh(processes, process_count);
+                    group_count = cgroup_build_groups(display_processes_ptr, display_count,
+                                                      current_sort, sysinfo.total_mem,
+                                                      groups, MAX_PROCESS, group_of);
+                } else {
+                    group_count = group_processes(display_processes_ptr, display_count, group_mode,
+                                                  groups, MAX_PROCESS, group_of);
+                }
+                for (int g = 0; g < group_count; g++) {
+                    if (strcmp(groups[g].key, expanded_group) == 0) {
+                        expanded_id = groups[g].id;
+                        break;
+                    }
+                }
+                if (expanded_id >= 0) {
+                    for (int i = 0; i < display_count; i++) {
+                        if (group_of[i] == expanded_id) {
+                            group_members[member_count++] = display_processes_ptr[i];
+                        }
+                    }
+                }
+                if (group_mode != GROUP_BY_CGROUP) {
+                    sort_groups(groups, group_count, current_sort);  // The cgroup tree sorts siblings itself
+                }
+                display_count = group_count + member_count;  // Rows, for scrolling
+            }
+            
+            // Insert the expanded process's threads as its children (live processes only)
+            if (expanded_pid > 0 && group_mode == GROUP_NONE && !history_mode) {
+                if (do_refresh) {
+                    const ProcessInfo *parent = NULL;
+                    for (int i = 0; i < display_count; i++) {
+                        if (display_processes_ptr[i].pid == expanded_pid) {
+                            parent = &display_processes_ptr[i];
+                            break;
+                        }
+                    }
+                    thread_count = scan_threads(expanded_pid, parent, thread_rows, MAX_THREADS);
+                    if (thread_count < 0) {
+                        expanded_pid = 0;  // Process exited
+                        thread_count = 0;
+                    }
+                }
+                if (thread_count > 0) {
+                    display_count = insert_thread_rows(display_processes_ptr, display_count,
+                                                       thread_rows, thread_count,
+                                                       expanded_rows, MAX_PROCESS + MAX_THREADS);
+                    display_processes_ptr = expanded_rows;
+                }
+            }
+            
+            // Find the selected process in the new order and keep it on screen
+            int selected_row = -1;
+            if (group_mode == GROUP_NONE) {
+                selected_row = cursor_locate(&cursor, display_processes_ptr, display_count);
+                if (cursor_step != 0 && selected_row >= 0) {
+                    cursor_move(&cursor, display_processes_ptr, display_count, cursor_step);
+                    selected_row = cursor.row;
+                }
+                cursor_follow(&cursor, &scroll_offset, VISIBLE_PROCESSES, display_count);
+                if (selected_row >= 0) {
+                    memcpy(selected_name, display_processes_ptr[selected_row].name, MAX_NAME_LEN);
+                }
+                if (show_detail) {
+                    detail_select(selected_row >= 0 ? cursor.pid : 0, cursor.start_ticks);
+                    detail_get(&detail);
+                }
+            }
+            cursor_step = 0;
+            
             // Adjust scroll offset if out of bounds after refresh
             if (scroll_offset > display_count - VISIBLE_PROCESSES && display_count > VISIBLE_PROCESSES) {
                 scroll_offset = display_count - VISIBLE_PROCESSES;
             }
             if (scroll_offset < 0) scroll_offset = 0;
             
+            // smaps_rollup walks every mapping, so only the rows on screen are read.
+            // Recorded PIDs may belong to other processes by now: their columns stay empty.
+            if (global_config.show_pss_columns && !history_mode) {
+                if (group_mode != GROUP_NONE) {
+                    update_smaps(group_members, member_count);
+                } else {
+                    int visible = display_count - scroll_offset;
+                    if (visible > VISIBLE_PROCESSES) visible = VISIBLE_PROCESSES;
+                    update_smaps(display_processes_ptr + scroll_offset, visible);
+                }
+            }
+            
+            // Socket fds are joined against /proc/net, parsed once per refresh
+            if (global_config.show_socket_columns && !history_mode) {
+                if (do_refresh) sockets_refresh();
+                if (group_mode != GROUP_NONE) {
+                    update_sockets(group_members, member_count);
+                } else {
+                    int visible = display_count - scroll_offset;
+                    if (visible > VISIBLE_PROCESSES) visible = VISIBLE_PROCESSES;
+                    update_sockets(display_processes_ptr + scroll_offset, visible);
+                }
+            }
+            
             display_system_info(&sysinfo);
-            display_processes(display_processes_ptr, display_count, scroll_offset, VISIBLE_PROCESSES);
-            display_command_menu(current_sort, strlen(filter_user) > 0 ? filter_user : NULL, 
+            if (history_mode) {
+                display_history_status(history_time, history_range.tier, history_index,
+                                       history_range.count, sysinfo.cpu_usage_percent);
+            } else {
+                display_cpu_meters(&cpu_stats);
+            }
+            AlertEvent alert_events[16];
+            AlertStats alert_stats = alerts_stats();
+            display_alerts(alert_events, alerts_firing(alert_events, 16), &alert_stats);
+            if (group_mode != GROUP_NONE) {
+                display_groups(groups, group_count, group_mode, expanded_id,
+                               group_members, member_count, scroll_offset, VISIBLE_PROCESSES);
+            } else {
+                display_processes(display_processes_ptr, display_count, scroll_offset, VISIBLE_PROCESSES,
+                                  selected_row);
+            }
+            if (show_detail && group_mode == GROUP_NONE) {
+                display_detail(&detail, selected_name);
+            }
+            if (proc_events_active()) {
+                ExitedProcess exits[MAX_RECENT_EXITS];
+                display_recent_exits(exits, proc_events_recent_exits(exits));
+            } else {
+                // Without events, exits are found by comparing snapshots
+                ExitedProcess exits[CHURN_RECENT_EXITS];
+                display_recent_exits(exits, churn_recent_exits(exits));
+            }
+            if (search_editing || search_query[0] != '\0') {
+                display_search_bar(search_query, search_mode_name(search_mode), display_count,
+                                   search_editing, search_invalid);
+            }
+            display_command_menu(current_sort, view_filter.count > 0 ? view_filter.source : NULL, 
                                scroll_offset, display_count);
+            display_refresh_status(budget.interval_ms, budget.self_cpu_percent,
+                                   budget.budget_percent > 0.0f, budget.current_degraded);
+            if (remote_mode) {
+                display_remote_status(socket_path, remote_connected);
+            }
+            // Drawn last, so that watch ticks can redraw it alone
+            watch_lines = 0;
+            if (watch_active()) {
+                watch_lines = display_watch_height(&watch_view);
+                display_watch(&watch_view);
+            }
             
             fflush(stdout);
+            
+            if (do_refresh) {
+                // Measure this refresh and pick the next interval
+                refresh_budget_end(&budget);
+                refresh_ticks = budget.interval_ms / TICK_MS;
+                if (refresh_ticks < 1) refresh_ticks = 1;
+            }
         }
         
         usleep(100000);
     }
     
+    detail_close();
+    watch_stop();
+    sockets_close();
+    search_shutdown();
+    remote_close();
+    shm_snapshot_close();
+    history_close();
+    history_query_close(&history_range);
+    cpu_stats_close();
+    proc_events_close();
+    data_source_shutdown();
     cleanup();
     
     return 0;
@@ -0,0 +1,258 @@
+#define _DEFAULT_SOURCE
+#include <errno.h>
+#include <sys/socket.h>
+#include <linux/netlink.h>
+#include <linux/connector.h>
+#include <linux/cn_proc.h>
+#include "proc_events.h"
+#include "process_monitor.h"
+#include "proc_table.h"
+#include "config.h"
+
+static int event_fd = -1;
+
+// Ring buffer of recently exited processes
+static ExitedProcess recent_exits[MAX_RECENT_EXITS];
+static int exits_head = 0;   // Next slot to write
+static int exits_count = 0;
+
+// Processes announced by an event but gone before /proc could be read, so
+// that their exit can still be listed
+#define MAX_PENDING 64
+typedef struct {
+    pid_t pid;                          // 0 = free slot
+    unsigned long long fork_ns;         // Event time (since boot), 0 if unknown
+    char name[MAX_NAME_LEN];            // Parent's name on fork, kept across exec
+    char user[MAX_NAME_LEN];
+} PendingProcess;
+static PendingProcess pending[MAX_PENDING];
+static int pending_next = 0;            // Slot reused when all are taken
+
+// Sends a PROC_CN_MCAST_LISTEN/IGNORE control message to the connector
+static int send_control(enum proc_cn_mcast_op op) {
+    char buffer[NLMSG_SPACE(sizeof(struct cn_msg) + sizeof(enum proc_cn_mcast_op))];
+    memset(buffer, 0, sizeof(buffer));
+
+    struct nlmsghdr *nlh = (struct nlmsghdr *)buffer;
+    nlh->nlmsg_len = NLMSG_LENGTH(sizeof(struct cn_msg) + sizeof(op));
+    nlh->nlmsg_type = NLMSG_DONE;
+    nlh->nlmsg_pid = getpid();
+
+    struct cn_msg *msg = (struct cn_msg *)NLMSG_DATA(nlh);
+    msg->id.idx = CN_IDX_PROC;
+    msg->id.val = CN_VAL_PROC;
+    msg->len = sizeof(op);
+    memcpy(msg->data, &op, sizeof(op));
+
+    return send(event_fd, nlh, nlh->nlmsg_len, 0) < 0 ? -1 : 0;
+}
+
+int proc_events_open(void) {
+    if (event_fd >= 0) return 0;
+
+    event_fd = socket(PF_NETLINK, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, NETLINK_CONNECTOR);
+    if (event_fd < 0) {
+        return -1;
+    }
+
+    struct sockaddr_nl addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.nl_family = AF_NETLINK;
+    addr.nl_groups = CN_IDX_PROC;
+    addr.nl_pid = getpid();
+
+    // Binding to the proc group needs CAP_NET_ADMIN - fall back to polling otherwise
+    if (bind(event_fd, (struct sockaddr *)&addr, sizeof(addr)) < 0 ||
+        send_control(PROC_CN_MCAST_LISTEN) < 0) {
+        close(event_fd);
+        event_fd = -1;
+        return -1;
+    }
+
+    return 0;
+}
+
+void proc_events_close(void) {
+    if (event_fd < 0) return;
+
+    send_control(PROC_CN_MCAST_IGNORE);
+    close(event_fd);
+    event_fd = -1;
+}
+
+bool proc_events_active(void) {
+    return event_fd >= 0;
+}
+
+static int find_row(const ProcessInfo processes[], int count, pid_t pid) {
+    for (int i = 0; i < count; i++) {
+        if (processes[i].pid == pid) return i;
+    }
+    return -1;
+}
+
+// Adds an entry to the "recently exited" ring; 'start_sec' and 'exit_ns' are relative to boot
+static ExitedProcess *record_exit(pid_t pid, const char *name, const char *user,
+                                  double start_sec, unsigned long long exit_ns) {
+    ExitedProcess *rec = &recent_exits[exits_head];
+
+    memset(rec, 0, sizeof(ExitedProcess));
+    rec->pid = pid;
+    snprintf(rec->name, MAX_NAME_LEN, "%s", name);
+    snprintf(rec->user, MAX_NAME_LEN, "%s", user);
+    rec->exited_at = time(NULL);
+
+    double exit_sec = (double)exit_ns / 1e9;
+    rec->lifetime = (start_sec > 0.0 && exit_sec > start_sec) ? (float)(exit_sec - start_sec) : 0.0f;
+
+    exits_head = (exits_head + 1) % MAX_RECENT_EXITS;
+    if (exits_count < MAX_RECENT_EXITS) exits_count++;
+    return rec;
+}
+
+static PendingProcess *find_pending(pid_t pid) {
+    for (int i = 0; i < MAX_PENDING; i++) {
+        if (pending[i].pid == pid) return &pending[i];
+    }
+    return NULL;
+}
+
+// Remembers a process whose /proc entry could not be read when its event arrived
+static void add_pending(const ProcessInfo processes[], int count, pid_t pid, pid_t parent,
+                        unsigned long long event_ns) {
+    PendingProcess *entry = find_pending(pid);
+    if (entry) return;  // Exec after fork: keep the fork time and name
+
+    entry = find_pending(0);
+    if (!entry) {
+        entry = &pending[pending_next];
+        pending_next = (pending_next + 1) % MAX_PENDING;
+    }
+    memset(entry, 0, sizeof(*entry));
+    entry->pid = pid;
+    entry->fork_ns = event_ns;
+    int row = parent > 0 ? find_row(processes, count, parent) : -1;
+    snprintf(entry->name, MAX_NAME_LEN, "%s", row >= 0 ? processes[row].name : "?");
+    snprintf(entry->user, MAX_NAME_LEN, "%s", row >= 0 ? processes[row].user : "?");
+}
+
+// Reads a (new or exec'd) process and inserts or updates its row
+static int upsert_row(ProcessInfo processes[], int *count, int max_processes,
+                      unsigned long total_mem, pid_t pid, pid_t parent,
+                      unsigned long long event_ns) {
+    int row = find_row(processes, *count, pid);
+    ProcessInfo pinfo;
+
+    // Always a full read: exec changes name and cmdline
+    if (get_process_info(pid, &pinfo, total_mem, 0) != 0) {
+        // Exited already (or is a zombie): its exit is listed from what the events tell
+        if (row < 0) add_pending(processes, *count, pid, parent, event_ns);
+        return 0;
+    }
+    if (global_config.hide_kernel_threads && pinfo.is_kernel_thread) {
+        return 0;
+    }
+
+    if (row >= 0) {
+        processes[row] = pinfo;
+    } else if (*count < max_processes) {
+        processes[(*count)++] = pinfo;
+    } else {
+        return 0;
+    }
+    return 1;
+}
+
+static int remove_row(ProcessInfo processes[], int *count, pid_t pid,
+                      unsigned long long exit_ns) {
+    PendingProcess *entry = find_pending(pid);
+    int row = find_row(processes, *count, pid);
+    if (row < 0) {
+        // Forked and exited between two drains: never had a row
+        if (entry) {
+            record_exit(pid, entry->name, entry->user, (double)entry->fork_ns / 1e9, exit_ns);
+            entry->pid = 0;
+        }
+        return 0;
+    }
+    if (entry) entry->pid = 0;
+
+    const ProcessInfo *pinfo = &processes[row];
+    ExitedProcess *rec = record_exit(pid, pinfo->name, pinfo->user,
+                                     (double)pinfo->start_ticks / sysconf(_SC_CLK_TCK), exit_ns);
+    rec->cpu_usage = pinfo->cpu_usage;
+    rec->rss = pinfo->rss;
+    proc_table_remove(pid);
+
+    // Order doesn't matter - the table is re-sorted before display
+    processes[row] = processes[--(*count)];
+    return 1;
+}
+
+int proc_events_apply(ProcessInfo processes[], int *count, int max_processes,
+                      unsigned long total_mem) {
+    if (event_fd < 0 || !processes || !count) return 0;
+
+    char buffer[8192] __attribute__((aligned(NLMSG_ALIGNTO)));
+    int changes = 0;
+
+    for (;;) {
+        ssize_t len = recv(event_fd, buffer, sizeof(buffer), 0);
+        if (len < 0) {
+            if (errno == EINTR) continue;
+            if (errno == ENOBUFS) return -1;  // Socket overflowed, events were dropped
+            break;                            // EAGAIN: drained
+        }
+        if (len == 0) break;
+
+        for (struct nlmsghdr *nlh = (struct nlmsghdr *)buffer;
+             NLMSG_OK(nlh, (size_t)len);
+             nlh = NLMSG_NEXT(nlh, len)) {
+            if (nlh->nlmsg_type == NLMSG_ERROR || nlh->nlmsg_type == NLMSG_NOOP) {
+                continue;
+            }
+
+            struct cn_msg *msg = (struct cn_msg *)NLMSG_DATA(nlh);
+            if (msg->id.idx != CN_IDX_PROC || msg->id.val != CN_VAL_PROC) {
+                continue;
+            }
+
+            struct proc_event *ev = (struct proc_event *)msg->data;
+            switch (ev->what) {
+                case PROC_EVENT_FORK:
+                    // Only new processes, not new threads
+                    if (ev->event_data.fork.child_pid == ev->event_data.fork.child_tgid) {
+                        changes += upsert_row(processes, count, max_processes, total_mem,
+                                              ev->event_data.fork.child_pid,
+                                              ev->event_data.fork.parent_tgid, ev->timestamp_ns);
+                    }
+                    break;
+                case PROC_EVENT_EXEC:
+                    changes += upsert_row(processes, count, max_processes, total_mem,
+                                          ev->event_data.exec.process_tgid, 0, ev->timestamp_ns);
+                    break;
+                case PROC_EVENT_EXIT:
+                    if (ev->event_data.exit.process_pid == ev->event_data.exit.process_tgid) {
+                        changes += remove_row(processes, count,
+                                              ev->event_data.exit.process_tgid,
+                                              ev->timestamp_ns);
+                    }
+                    break;
+                default:
+                    break;
+            }
+        }
+    }
+
+    return changes;
+}
+
+int proc_events_recent_exits(ExitedProcess list[]) {
+    if (!list) return 0;
+
+    for (int i = 0; i < exits_count; i++) {
+        int slot = (exits_head - 1 - i + MAX_RECENT_EXITS) % MAX_RECENT_EXITS;
+        list[i] = recent_exits[slot];
+    }
+    return exits_count;
+}
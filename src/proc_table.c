@@ -0,0 +1,138 @@
+#include "proc_table.h"
+
+// Open-addressing hash table with linear probing, indexed by PID
+static ProcEntry table[PROC_TABLE_SIZE];
+static unsigned int generation = 1;
+static void (*evict_hook)(ProcEntry *entry) = NULL;
+
+static unsigned int slot_for(pid_t pid) {
+    return ((unsigned int)pid * 2654435761u) & (PROC_TABLE_SIZE - 1);
+}
+
+// An entry at 'next' can fill 'hole' if its home slot is not within (hole, next]
+static bool movable(unsigned int hole, unsigned int next, unsigned int home) {
+    return (hole <= next) ? (home <= hole || home > next)
+                          : (home <= hole && home > next);
+}
+
+// Deletes the entry at 'slot' and shifts later entries of the same probe
+// chain back so that lookups never hit a hole (no tombstones needed)
+static void delete_slot(unsigned int slot) {
+    if (evict_hook) evict_hook(&table[slot]);
+
+    unsigned int hole = slot;
+    unsigned int next = (slot + 1) & (PROC_TABLE_SIZE - 1);
+
+    while (table[next].pid != 0) {
+        if (movable(hole, next, slot_for(table[next].pid))) {
+            table[hole] = table[next];
+            hole = next;
+        }
+        next = (next + 1) & (PROC_TABLE_SIZE - 1);
+    }
+
+    table[hole].pid = 0;
+    table[hole].has_static = false;
+}
+
+ProcEntry* proc_table_lookup(pid_t pid) {
+    if (pid <= 0) return NULL;
+
+    unsigned int slot = slot_for(pid);
+    for (unsigned int probes = 0; probes < PROC_TABLE_SIZE; probes++) {
+        if (table[slot].pid == pid) return &table[slot];
+        if (table[slot].pid == 0) return NULL;
+        slot = (slot + 1) & (PROC_TABLE_SIZE - 1);
+    }
+    return NULL;
+}
+
+ProcEntry* proc_table_upsert(pid_t pid, unsigned long long start_ticks) {
+    if (pid <= 0) return NULL;
+
+    unsigned int slot = slot_for(pid);
+    for (unsigned int probes = 0; probes < PROC_TABLE_SIZE; probes++) {
+        ProcEntry *entry = &table[slot];
+
+        if (entry->pid == pid) {
+            if (entry->start_ticks != start_ticks) {
+                // PID was recycled - forget everything about the old process
+                if (evict_hook) evict_hook(entry);
+                memset(entry, 0, sizeof(ProcEntry));
+                entry->pid = pid;
+                entry->start_ticks = start_ticks;
+            }
+            entry->seen = generation;
+            return entry;
+        }
+
+        if (entry->pid == 0) {
+            memset(entry, 0, sizeof(ProcEntry));
+            entry->pid = pid;
+            entry->start_ticks = start_ticks;
+            entry->seen = generation;
+            return entry;
+        }
+
+        slot = (slot + 1) & (PROC_TABLE_SIZE - 1);
+    }
+
+    return NULL;  // Table full
+}
+
+void proc_table_begin_scan(void) {
+    generation++;
+    if (generation == 0) generation = 1;  // 0 would match freshly zeroed entries
+}
+
+void proc_table_mark_seen(ProcEntry *entry) {
+    if (entry) entry->seen = generation;
+}
+
+void proc_table_end_scan(void) {
+    unsigned int slot = 0;
+    while (slot < PROC_TABLE_SIZE) {
+        if (table[slot].pid != 0 && table[slot].seen != generation) {
+            // Re-check the same slot: delete_slot() may shift an entry into it
+            delete_slot(slot);
+            continue;
+        }
+        slot++;
+    }
+}
+
+void proc_table_remove(pid_t pid) {
+    ProcEntry *entry = proc_table_lookup(pid);
+    if (entry) {
+        delete_slot((unsigned int)(entry - table));
+    }
+}
+
+void proc_table_set_evict_hook(void (*hook)(ProcEntry *entry)) {
+    evict_hook = hook;
+}
+
+// FNV-1a
+unsigned int hash_string(const char *text) {
+    unsigned int hash = 2166136261u;
+    for (; *text; text++) {
+        hash = (hash ^ (unsigned char)*text) * 16777619u;
+    }
+    return hash;
+}
+
+void hash_slots_delete(int slots[], unsigned int size, unsigned int slot,
+                       unsigned int (*hash_of)(int value)) {
+    unsigned int hole = slot;
+    unsigned int next = (slot + 1) & (size - 1);
+
+    while (slots[next] != 0) {
+        if (movable(hole, next, hash_of(slots[next]) & (size - 1))) {
+            slots[hole] = slots[next];
+            hole = next;
+        }
+        next = (next + 1) & (size - 1);
+    }
+
+    slots[hole] = 0;
+}
@@ -1,8 +1,48 @@
+#define _POSIX_C_SOURCE 200809L
 #include "process_monitor.h"
+#include "proc_table.h"
+#include "data_source.h"
+#include "filter.h"
 #include <stdbool.h>
 
 
-int scan_processes(ProcessInfo processes[], int max_processes, unsigned long total_mem) {
+// Records the /proc/[pid] inode of freshly read rows (matched in order
+// against the PIDs asked for) and drops kernel threads when they are hidden
+static int finish_rows(ProcessInfo rows[], int count, const pid_t pids[], const ino_t inos[],
+                       int pid_count, unsigned int flags) {
+    int kept = 0;
+    int p = 0;
+    for (int i = 0; i < count; i++) {
+        while (p < pid_count && pids[p] != rows[i].pid) p++;
+        if (p < pid_count) {
+            ProcEntry *entry = proc_table_lookup(rows[i].pid);
+            if (entry) entry->dir_ino = inos[p];
+        }
+        if ((flags & SCAN_HIDE_KTHREADS) && rows[i].is_kernel_thread) continue;
+        if (kept != i) rows[kept] = rows[i];
+        kept++;
+    }
+    return kept;
+}
+
+// Turns the counters of freshly read rows into rates for the optional columns
+static void update_rates(ProcessInfo rows[], int count, unsigned int flags) {
+    for (int i = 0; i < count; i++) {
+        if (flags & SCAN_READ_IO) update_io_rates(&rows[i]);
+        if (flags & SCAN_READ_SCHED) update_sched_rates(&rows[i]);
+    }
+}
+
+// Reads a batch of PIDs with the backend's batch reader
+static int read_batch(const DataSource *source, const pid_t pids[], const ino_t inos[], int count,
+                      ProcessInfo processes[], unsigned long total_mem, unsigned int flags) {
+    int filled = source->read_batch(pids, count, processes, total_mem, flags);
+    update_rates(processes, filled, flags);
+    return finish_rows(processes, filled, pids, inos, count, flags);
+}
+
+int scan_processes(ProcessInfo processes[], int max_processes, unsigned long total_mem,
+                   unsigned int flags) {
     // Validate input parameters
     if (!processes || max_processes <= 0) {
         return -1;
@@ -17,68 +57,162 @@ int scan_processes(ProcessInfo processes[], int max_processes, unsigned long tot
     
     struct dirent *entry; 
     int count = 0;
+    const DataSource *source = data_source_current();
+    pid_t batch[SCAN_BATCH_SIZE];
+    ino_t batch_inos[SCAN_BATCH_SIZE];
+    int pending = 0;  // PIDs collected for a batching backend
     
-    while ((entry = readdir(proc_dir)) != NULL && count < max_processes) {
+    // New generation: PIDs not seen during this walk are dropped from the cache
+    proc_table_begin_scan();
+    
+    while ((entry = readdir(proc_dir)) != NULL && count + pending < max_processes) {
         if (is_pid(entry->d_name)) {
             pid_t pid = (pid_t)atoi(entry->d_name);
-            // Pass total_mem to get_process_info for efficient memory % calculation
-            if (get_process_info(pid, &processes[count], total_mem) == 0) {
-                count++;
+            ino_t ino = entry->d_ino;
+            
+            if (flags & SCAN_HIDE_KTHREADS) {
+                // Known kernel threads are skipped without reading stat; a
+                // reused PID gets a new /proc/[pid] inode and is read again
+                ProcEntry *known = proc_table_lookup(pid);
+                if (known && known->is_kthread && known->dir_ino == ino) {
+                    proc_table_mark_seen(known);
+                    continue;
+                }
+            }
+            
+            if (source->read_batch) {
+                batch[pending] = pid;
+                batch_inos[pending++] = ino;
+                if (pending == SCAN_BATCH_SIZE) {
+                    count += read_batch(source, batch, batch_inos, pending, &processes[count],
+                                        total_mem, flags);
+                    pending = 0;
+                }
+            // Pass total_mem to the backend for efficient memory % calculation
+            } else if (source->read(pid, &processes[count], total_mem, flags) == 0) {
+                update_rates(&processes[count], 1, flags);
+                count += finish_rows(&processes[count], 1, &pid, &ino, 1, flags);
             }
         }
     }
+    if (pending > 0) {
+        count += read_batch(source, batch, batch_inos, pending, &processes[count], total_mem, flags);
+    }
     
     closedir(proc_dir);
+    
+    // Only evict when the walk was complete, otherwise live PIDs would lose their cache
+    if (count < max_processes) {
+        proc_table_end_scan();
+    }
     return count;  // Return number of processes scanned
 }
 
+int refresh_processes(ProcessInfo processes[], int count, unsigned long total_mem,
+                      unsigned int flags) {
+    if (!processes || count <= 0) return 0;
+    
+    const DataSource *source = data_source_current();
+    int kept = 0;
+    if (source->read_batch) {
+        pid_t batch[SCAN_BATCH_SIZE];
+        ino_t batch_inos[SCAN_BATCH_SIZE];
+        for (int start = 0; start < count; start += SCAN_BATCH_SIZE) {
+            int n = count - start < SCAN_BATCH_SIZE ? count - start : SCAN_BATCH_SIZE;
+            for (int i = 0; i < n; i++) {
+                batch[i] = processes[start + i].pid;
+                ProcEntry *entry = proc_table_lookup(batch[i]);
+                batch_inos[i] = entry ? entry->dir_ino : 0;  // Not re-read from a readdir here
+            }
+            // kept <= start, so the rows written were already copied out
+            kept += read_batch(source, batch, batch_inos, n, &processes[kept], total_mem, flags);
+        }
+        return kept;
+    }
+    
+    for (int i = 0; i < count; i++) {
+        // Compact in place: rows of vanished processes are overwritten
+        pid_t pid = processes[i].pid;
+        if (source->read(pid, &processes[kept], total_mem, flags) == 0) {
+            update_rates(&processes[kept], 1, flags);
+            ProcEntry *entry = proc_table_lookup(pid);
+            ino_t ino = entry ? entry->dir_ino : 0;
+            kept += finish_rows(&processes[kept], 1, &pid, &ino, 1, flags);
+        }
+    }
+    return kept;
+}
 
+double clock_seconds(clockid_t clock) {
+    struct timespec ts;
+    if (clock_gettime(clock, &ts) != 0) {
+        return 0.0;
+    }
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
 
+double monotonic_seconds(void) {
+    return clock_seconds(CLOCK_MONOTONIC);
+}
 
-int get_process_info(pid_t pid, ProcessInfo *pinfo, unsigned long total_mem) {
-    if (!pinfo) return -1;
-    
-    char path[BUFFER_SIZE];
-    char buffer[BUFFER_SIZE];
-    FILE *fp;
-    
-    // Initialize the structure
-    memset(pinfo, 0, sizeof(ProcessInfo));
-    pinfo->pid = pid;
-    
-    // ========================================================================
-    // 1. Read from /proc/[pid]/stat - contains most process information
-    // ========================================================================
-    snprintf(path, sizeof(path), "/proc/%d/stat", pid);
-    fp = fopen(path, "r");
+bool proc_static_is_fresh(const ProcEntry *entry) {
+    if (!entry || !entry->has_static) return false;
+    // Nothing in status or cmdline of a kernel thread ever changes
+    return entry->is_kthread || monotonic_seconds() - entry->static_time < STATIC_REFRESH_SECONDS;
+}
+
+// Reads up to size - 1 bytes of a /proc file from offset 0; returns the length or -1
+static int read_proc_text(const char *path, char *buffer, size_t size) {
+    FILE *fp = fopen(path, "r");
     if (!fp) {
         return -1;  // Process might have terminated
     }
-    
-    // Parse /proc/[pid]/stat
+    size_t len = fread(buffer, 1, size - 1, fp);
+    fclose(fp);
+    buffer[len] = '\0';
+    return (int)len;
+}
+
+float read_uptime(void) {
+    FILE *uptime_fp = fopen("/proc/uptime", "r");
+    float system_uptime = 0;
+    if (uptime_fp) {
+        if (fscanf(uptime_fp, "%f", &system_uptime) != 1) {
+            system_uptime = 0;
+        }
+        fclose(uptime_fp);
+    }
+    return system_uptime;
+}
+
+// Parses the /proc/[pid]/stat line into name, state, ppid, times and memory
+static int parse_stat(const char *text, ProcessInfo *pinfo, float system_uptime) {
     // Format: pid (comm) state ppid pgrp session tty_nr tpgid flags minflt cminflt majflt cmajflt utime stime cutime cstime ...
     unsigned long utime, stime;
     unsigned long long starttime;
     long rss_pages;
     int ppid;
+    unsigned int task_flags;
     
-    if (fscanf(fp, "%*d (%255[^)]) %c %d %*d %*d %*d %*d %*u %*lu %*lu %*lu %*lu %lu %lu %*ld %*ld %*d %*d %*d %*d %llu %lu %ld",
+    if (sscanf(text, "%*d (%255[^)]) %c %d %*d %*d %*d %*d %u %lu %*lu %lu %*lu %lu %lu %*ld %*ld %*d %*d %*d %*d %llu %lu %ld",
                pinfo->name,      // Process name (between parentheses)
                &pinfo->state,    // Process state (R, S, D, Z, T, etc.)
                &ppid,            // Parent process ID
+               &task_flags,      // PF_* flags of the task
+               &pinfo->minflt,   // Minor faults
+               &pinfo->majflt,   // Major faults
                &utime,           // CPU time in user mode (jiffies)
                &stime,           // CPU time in kernel mode (jiffies)
                &starttime,       // Start time since boot (jiffies)
                &pinfo->vsize,    // Virtual memory size (bytes)
                &rss_pages        // Resident Set Size (pages)
-    ) < 8) {
-        fclose(fp);
+    ) < 11) {
         return -1;
     }
-    fclose(fp);
     
     // Store parent PID
     pinfo->ppid = ppid;
+    pinfo->is_kernel_thread = (task_flags & PF_KTHREAD) != 0;
     pinfo->tree_depth = 0;  // Will be calculated later if needed
     
     // Convert RSS from pages to bytes (typically 4096 bytes per page)
@@ -90,19 +224,9 @@ int get_process_info(pid_t pid, ProcessInfo *pinfo, unsigned long total_mem) {
     
     // Store start time (in seconds since boot)
     pinfo->starttime = starttime / sysconf(_SC_CLK_TCK);
+    pinfo->start_ticks = starttime;
     
     // Calculate CPU % based on process lifetime
-    // Get system uptime
-    FILE *uptime_fp = fopen("/proc/uptime", "r");
-    float system_uptime = 0;
-    if (uptime_fp) {
-        if (fscanf(uptime_fp, "%f", &system_uptime) != 1) {
-            system_uptime = 0;
-        }
-        fclose(uptime_fp);
-    }
-    
-    // Calculate process uptime
     float process_uptime = system_uptime - pinfo->starttime;
     if (process_uptime > 0) {
         // CPU usage = (total CPU time / process uptime) * 100
@@ -113,46 +237,263 @@ int get_process_info(pid_t pid, ProcessInfo *pinfo, unsigned long total_mem) {
     } else {
         pinfo->cpu_usage = 0.0f;
     }
+    return 0;
+}
+
+// Finds "Uid: <real> <effective> <saved> <filesystem>" in /proc/[pid]/status
+static void parse_status(const char *text, ProcessInfo *pinfo) {
+    const char *line = strstr(text, "\nUid:\t");
+    if (line) {
+        sscanf(line + 1, "Uid:\t%u", &pinfo->uid);
+    }
+    
+    // Convert UID to username
+    get_username(pinfo->uid, pinfo->user, MAX_NAME_LEN);
+}
+
+// "voluntary_ctxt_switches:" and "nonvoluntary_ctxt_switches:" end /proc/[pid]/status
+static bool parse_ctxt_switches(const char *text, unsigned long long *nvcsw, unsigned long long *nivcsw) {
+    const char *line = strstr(text, "\nvoluntary_ctxt_switches:");
+    if (!line || sscanf(line + 1, "voluntary_ctxt_switches: %llu", nvcsw) != 1) {
+        return false;  // Truncated read
+    }
+    line = strstr(line, "\nnonvoluntary_ctxt_switches:");
+    return line && sscanf(line + 1, "nonvoluntary_ctxt_switches: %llu", nivcsw) == 1;
+}
+
+// Format: "<on-CPU ns> <run-queue wait ns> <timeslices>"
+static bool parse_schedstat(const char *text, unsigned long long *wait_ns) {
+    return sscanf(text, "%*s %llu", wait_ns) == 1;
+}
+
+// The status and schedstat of a PID only count its leader thread; this sums
+// every thread of /proc/[pid]/task instead (exited threads are not counted)
+static bool sum_task_sched(pid_t pid, ProcessInfo *pinfo) {
+    char path[64];
+    snprintf(path, sizeof(path), "/proc/%d/task", pid);
+    DIR *dir = opendir(path);
+    if (!dir) return false;
+
+    unsigned long long wait_ns = 0, nvcsw = 0, nivcsw = 0;
+    bool have_switches = false, have_wait = false;
+    struct dirent *entry;
+    while ((entry = readdir(dir)) != NULL) {
+        if (!isdigit((unsigned char)entry->d_name[0])) continue;
+
+        char text[PROC_STATUS_FULL_SIZE];
+        unsigned long long value, involuntary;
+        snprintf(path, sizeof(path), "/proc/%d/task/%.16s/status", pid, entry->d_name);
+        if (read_proc_text(path, text, sizeof(text)) > 0 && parse_ctxt_switches(text, &value, &involuntary)) {
+            nvcsw += value;
+            nivcsw += involuntary;
+            have_switches = true;
+        }
+        snprintf(path, sizeof(path), "/proc/%d/task/%.16s/schedstat", pid, entry->d_name);
+        if (read_proc_text(path, text, PROC_SCHEDSTAT_TEXT_SIZE) > 0 && parse_schedstat(text, &value)) {
+            wait_ns += value;
+            have_wait = true;
+        }
+    }
+    closedir(dir);
+
+    if (have_switches) {
+        pinfo->nvcsw = nvcsw;
+        pinfo->nivcsw = nivcsw;
+    }
+    if (have_wait) pinfo->sched_wait_ns = wait_ns;
+    return have_switches || have_wait;
+}
+
+// Turns raw /proc/[pid]/cmdline bytes into one line in place; returns the length
+static int format_cmdline(char *buffer, size_t bytes_read) {
+    // Handle empty cmdline (kernel threads)
+    if (bytes_read == 0) {
+        buffer[0] = '\0';
+        return 0;
+    }
     
     // ========================================================================
-    // 2. Read from /proc/[pid]/status - contains UID and other details
+    // Process the cmdline: replace null bytes with spaces
     // ========================================================================
-    snprintf(path, sizeof(path), "/proc/%d/status", pid);
-    fp = fopen(path, "r");
-    if (!fp) {
+    // The cmdline file contains arguments separated by null bytes:
+    // Example: "/usr/bin/vim\0project.c\0" -> "/usr/bin/vim project.c"
+    
+    for (size_t i = 0; i < bytes_read - 1; i++) {
+        if (buffer[i] == '\0') {
+            buffer[i] = ' ';  // Replace null with space
+        }
+    }
+    
+    // Ensure the string is null-terminated
+    buffer[bytes_read] = '\0';
+    
+    // Remove trailing spaces (if any)
+    while (bytes_read > 0 && buffer[bytes_read - 1] == ' ') {
+        buffer[--bytes_read] = '\0';
+    }
+    
+    return (int)bytes_read;  // Return number of bytes written
+}
+
+// Format: "rchar: N", "wchar: N", "syscr: N", ..., "read_bytes: N", "write_bytes: N"
+static void parse_io(const char *text, ProcessInfo *pinfo) {
+    for (const char *line = text; line && *line; line = strchr(line, '\n')) {
+        if (*line == '\n') line++;
+        if (sscanf(line, "rchar: %llu", &pinfo->rchar) == 1) continue;
+        if (sscanf(line, "wchar: %llu", &pinfo->wchar) == 1) continue;
+        if (sscanf(line, "read_bytes: %llu", &pinfo->read_bytes) == 1) continue;
+        if (sscanf(line, "write_bytes: %llu", &pinfo->write_bytes) == 1) break;
+    }
+}
+
+int get_process_info(pid_t pid, ProcessInfo *pinfo, unsigned long total_mem,
+                     unsigned int flags) {
+    if (!pinfo) return -1;
+    
+    char path[BUFFER_SIZE];
+    char stat[PROC_STAT_TEXT_SIZE];
+    
+    // /proc/[pid]/stat contains most process information; the other files
+    // are read by process_info_from_text() only when needed
+    snprintf(path, sizeof(path), "/proc/%d/stat", pid);
+    if (read_proc_text(path, stat, sizeof(stat)) <= 0) {
         return -1;  // Process might have terminated
     }
     
-    // Parse status file line by line
-    while (fgets(buffer, sizeof(buffer), fp)) {
-        // Look for Uid line: "Uid: <real> <effective> <saved> <filesystem>"
-        if (sscanf(buffer, "Uid:\t%u", &pinfo->uid) == 1) {
-            break;
+    ProcText text = { .stat = stat };
+    return process_info_from_text(pid, &text, read_uptime(), pinfo, total_mem, flags);
+}
+
+int process_info_from_text(pid_t pid, const ProcText *text, float system_uptime,
+                           ProcessInfo *pinfo, unsigned long total_mem, unsigned int flags) {
+    if (!text || !text->stat || !pinfo) return -1;
+    
+    char path[BUFFER_SIZE];
+    
+    // Initialize the structure
+    memset(pinfo, 0, sizeof(ProcessInfo));
+    pinfo->pid = pid;
+    
+    // ========================================================================
+    // 1. /proc/[pid]/stat - contains most process information
+    // ========================================================================
+    if (parse_stat(text->stat, pinfo, system_uptime) != 0) {
+        return -1;
+    }
+    
+    // Cached attributes from the last full read of this (pid, starttime)
+    ProcEntry *cached = proc_table_upsert(pid, pinfo->start_ticks);
+    // exec() keeps (pid, starttime) but changes comm, which makes the cache stale;
+    // kernel threads never exec, but kworkers rename themselves all the time
+    bool have_cache = cached && cached->has_static &&
+                      (cached->is_kthread || strcmp(cached->comm, pinfo->name) == 0);
+    bool fresh = have_cache && proc_static_is_fresh(cached);
+    bool reuse_status = have_cache && (fresh || (flags & SCAN_SKIP_STATUS));
+    bool reuse_cmdline = have_cache && (fresh || (flags & SCAN_SKIP_CMDLINE));
+    
+    // The latency columns need the context switches at the end of status on
+    // every refresh, so the file is read in full even when uid is cached
+    const char *status_text = text->status;
+    char status_full[PROC_STATUS_FULL_SIZE];
+    if (!status_text && (flags & SCAN_READ_SCHED)) {
+        snprintf(path, sizeof(path), "/proc/%d/status", pid);
+        if (read_proc_text(path, status_full, sizeof(status_full)) >= 0) {
+            status_text = status_full;
         }
     }
-    fclose(fp);
     
-    // Convert UID to username
-    struct passwd *pw = getpwuid(pinfo->uid);
-    if (pw) {
-        strncpy(pinfo->user, pw->pw_name, MAX_NAME_LEN - 1);
-        pinfo->user[MAX_NAME_LEN - 1] = '\0';
+    // ========================================================================
+    // 2. /proc/[pid]/status - contains UID and other details
+    // ========================================================================
+    if (reuse_status) {
+        pinfo->uid = cached->uid;
+        memcpy(pinfo->user, cached->user, MAX_NAME_LEN);
+    } else if (pinfo->is_kernel_thread) {
+        // Kernel threads always run as root
+        pinfo->uid = 0;
+        get_username(0, pinfo->user, MAX_NAME_LEN);
+    } else if (status_text) {
+        parse_status(status_text, pinfo);
     } else {
-        // If username not found, use UID as string
-        snprintf(pinfo->user, MAX_NAME_LEN, "%u", pinfo->uid);
+        char status[PROC_STATUS_TEXT_SIZE];
+        snprintf(path, sizeof(path), "/proc/%d/status", pid);
+        if (read_proc_text(path, status, sizeof(status)) < 0) {
+            return -1;  // Process might have terminated
+        }
+        parse_status(status, pinfo);
     }
     
     // ========================================================================
-    // 3. Read from /proc/[pid]/cmdline - contains full command line
+    // 3. /proc/[pid]/cmdline - contains full command line
     // ========================================================================
-    get_cmdline(pid, pinfo->cmdline, MAX_CMDLINE_LEN);
-    if (pinfo->cmdline[0] == '\0') {
-        // If cmdline is empty, use the process name in brackets (kernel threads)
+    if (pinfo->is_kernel_thread) {
+        // Always empty: show the (current) name in brackets
         snprintf(pinfo->cmdline, MAX_CMDLINE_LEN, "[%s]", pinfo->name);
+    } else if (reuse_cmdline) {
+        memcpy(pinfo->cmdline, cached->cmdline, MAX_CMDLINE_LEN);
+    } else {
+        if (text->cmdline) {
+            size_t len = text->cmdline_len < MAX_CMDLINE_LEN - 1 ? text->cmdline_len : MAX_CMDLINE_LEN - 1;
+            memcpy(pinfo->cmdline, text->cmdline, len);
+            format_cmdline(pinfo->cmdline, len);
+        } else {
+            get_cmdline(pid, pinfo->cmdline, MAX_CMDLINE_LEN);
+        }
+        if (pinfo->cmdline[0] == '\0') {
+            // If cmdline is empty, use the process name in brackets (kernel threads)
+            snprintf(pinfo->cmdline, MAX_CMDLINE_LEN, "[%s]", pinfo->name);
+        }
+    }
+    
+    // Remember the attributes so later scans can reuse them
+    if (cached && !reuse_status && !reuse_cmdline) {
+        cached->uid = pinfo->uid;
+        memcpy(cached->user, pinfo->user, MAX_NAME_LEN);
+        memcpy(cached->cmdline, pinfo->cmdline, MAX_CMDLINE_LEN);
+        snprintf(cached->comm, sizeof(cached->comm), "%.*s", (int)sizeof(cached->comm) - 1, pinfo->name);
+        cached->is_kthread = pinfo->is_kernel_thread;
+        cached->static_time = monotonic_seconds();
+        cached->has_static = true;
     }
     
     // ========================================================================
-    // 4. Calculate memory usage percentage
+    // 4. /proc/[pid]/io - only when the I/O columns are shown
+    // ========================================================================
+    if (flags & SCAN_READ_IO) {
+        if (text->io) {
+            parse_io(text->io, pinfo);
+        } else {
+            get_process_io(pid, pinfo);
+        }
+    }
+    
+    // ========================================================================
+    // 5. schedstat and context switches - only when the latency columns are shown
+    // ========================================================================
+    if (flags & SCAN_READ_SCHED) {
+        // A multi-threaded process is summed over its threads, like taskstats does
+        const char *threads_line = status_text ? strstr(status_text, "\nThreads:") : NULL;
+        int threads = 1;
+        if (threads_line) sscanf(threads_line + 1, "Threads: %d", &threads);
+        if (threads > 1 && sum_task_sched(pid, pinfo)) {
+            pinfo->has_sched = true;
+        } else {
+            bool have_switches = status_text && parse_ctxt_switches(status_text, &pinfo->nvcsw, &pinfo->nivcsw);
+            bool have_wait;
+            if (text->schedstat) {
+                have_wait = parse_schedstat(text->schedstat, &pinfo->sched_wait_ns);
+            } else {
+                char schedstat[PROC_SCHEDSTAT_TEXT_SIZE];
+                snprintf(path, sizeof(path), "/proc/%d/schedstat", pid);
+                have_wait = read_proc_text(path, schedstat, sizeof(schedstat)) > 0 &&
+                            parse_schedstat(schedstat, &pinfo->sched_wait_ns);
+            }
+            pinfo->has_sched = have_switches || have_wait;
+        }
+    }
+    
+    // ========================================================================
+    // 6. Calculate memory usage percentage
     // ========================================================================
     if (total_mem > 0) {
         pinfo->mem_usage = (float)pinfo->rss / (float)total_mem * 100.0f;
@@ -163,6 +504,181 @@ int get_process_info(pid_t pid, ProcessInfo *pinfo, unsigned long total_mem) {
     return 0;
 }
 
+int get_process_io(pid_t pid, ProcessInfo *pinfo) {
+    if (!pinfo) return -1;
+    
+    char path[BUFFER_SIZE];
+    char buffer[BUFFER_SIZE];
+    snprintf(path, sizeof(path), "/proc/%d/io", pid);
+    
+    if (read_proc_text(path, buffer, sizeof(buffer)) < 0) {
+        return -1;  // Not our process (needs ptrace access) or already gone
+    }
+    parse_io(buffer, pinfo);
+    return 0;
+}
+
+// Per-second rate of a monotonically increasing counter (0 if it went backwards)
+static float counter_rate(unsigned long long now, unsigned long long prev, double seconds) {
+    if (now < prev || seconds <= 0.0) return 0.0f;
+    return (float)((double)(now - prev) / seconds);
+}
+
+int get_process_smaps(pid_t pid, ProcessInfo *pinfo) {
+    if (!pinfo) return -1;
+    
+    char path[BUFFER_SIZE];
+    char buffer[BUFFER_SIZE];
+    snprintf(path, sizeof(path), "/proc/%d/smaps_rollup", pid);
+    
+    FILE *fp = fopen(path, "r");
+    if (!fp) {
+        return -1;  // Kernel without smaps_rollup, no ptrace access, or gone
+    }
+    
+    // Values are in kB; the first line is the "[rollup]" pseudo mapping
+    unsigned long value, pss = 0, private_clean = 0, private_dirty = 0, swap = 0;
+    int found = 0;
+    while (fgets(buffer, sizeof(buffer), fp)) {
+        if (sscanf(buffer, "Pss: %lu kB", &value) == 1) { pss = value; found++; }
+        else if (sscanf(buffer, "Private_Clean: %lu kB", &value) == 1) { private_clean = value; found++; }
+        else if (sscanf(buffer, "Private_Dirty: %lu kB", &value) == 1) { private_dirty = value; found++; }
+        else if (sscanf(buffer, "Swap: %lu kB", &value) == 1) { swap = value; found++; break; }
+    }
+    fclose(fp);
+    
+    if (found == 0) return -1;  // Kernel thread: no user mappings
+    
+    pinfo->pss = pss * 1024;
+    pinfo->uss = (private_clean + private_dirty) * 1024;
+    pinfo->swap = swap * 1024;
+    pinfo->has_smaps = true;
+    return 0;
+}
+
+void update_smaps(ProcessInfo rows[], int count) {
+    if (!rows) return;
+    
+    double now = monotonic_seconds();
+    for (int i = 0; i < count; i++) {
+        ProcessInfo *pinfo = &rows[i];
+        if (pinfo->is_thread) continue;
+        
+        ProcEntry *entry = proc_table_lookup(pinfo->pid);
+        if (!entry || entry->start_ticks != pinfo->start_ticks) continue;
+        
+        if (!entry->has_smaps || now - entry->smaps_time >= SMAPS_REFRESH_SECONDS) {
+            entry->smaps_time = now;
+            entry->has_smaps = get_process_smaps(pinfo->pid, pinfo) == 0;
+            entry->pss = pinfo->pss;
+            entry->uss = pinfo->uss;
+            entry->swap = pinfo->swap;
+        } else {
+            pinfo->pss = entry->pss;
+            pinfo->uss = entry->uss;
+            pinfo->swap = entry->swap;
+        }
+        pinfo->has_smaps = entry->has_smaps;
+    }
+}
+
+void update_io_rates(ProcessInfo *pinfo) {
+    if (!pinfo) return;
+    
+    ProcEntry *entry = proc_table_lookup(pinfo->pid);
+    if (!entry || entry->start_ticks != pinfo->start_ticks) return;
+    
+    double now = monotonic_seconds();
+    if (entry->has_io) {
+        double elapsed = now - entry->io_time;
+        pinfo->read_rate = counter_rate(pinfo->read_bytes, entry->read_bytes, elapsed);
+        pinfo->write_rate = counter_rate(pinfo->write_bytes, entry->write_bytes, elapsed);
+        pinfo->rchar_rate = counter_rate(pinfo->rchar, entry->rchar, elapsed);
+        pinfo->wchar_rate = counter_rate(pinfo->wchar, entry->wchar, elapsed);
+    }
+    
+    entry->has_io = true;
+    entry->io_time = now;
+    entry->read_bytes = pinfo->read_bytes;
+    entry->write_bytes = pinfo->write_bytes;
+    entry->rchar = pinfo->rchar;
+    entry->wchar = pinfo->wchar;
+}
+
+void update_sched_rates(ProcessInfo *pinfo) {
+    if (!pinfo || !pinfo->has_sched) return;
+    
+    ProcEntry *entry = proc_table_lookup(pinfo->pid);
+    if (!entry || entry->start_ticks != pinfo->start_ticks) return;
+    
+    double now = monotonic_seconds();
+    if (entry->has_sched) {
+        double elapsed = now - entry->sched_time;
+        pinfo->wait_rate = counter_rate(pinfo->sched_wait_ns, entry->sched_wait_ns, elapsed) / 1e6f;
+        pinfo->csw_rate = counter_rate(pinfo->nvcsw, entry->nvcsw, elapsed);
+        pinfo->icsw_rate = counter_rate(pinfo->nivcsw, entry->nivcsw, elapsed);
+        pinfo->minflt_rate = counter_rate(pinfo->minflt, entry->minflt, elapsed);
+        pinfo->majflt_rate = counter_rate(pinfo->majflt, entry->majflt, elapsed);
+    }
+    
+    entry->has_sched = true;
+    entry->sched_time = now;
+    entry->sched_wait_ns = pinfo->sched_wait_ns;
+    entry->nvcsw = pinfo->nvcsw;
+    entry->nivcsw = pinfo->nivcsw;
+    entry->minflt = pinfo->minflt;
+    entry->majflt = pinfo->majflt;
+}
+
+// Partitions, loop/ram devices and stacked (dm/md) devices would double count
+static bool is_whole_disk(const char *name) {
+    if (strncmp(name, "loop", 4) == 0 || strncmp(name, "ram", 3) == 0 ||
+        strncmp(name, "dm-", 3) == 0 || strncmp(name, "md", 2) == 0) {
+        return false;
+    }
+    
+    // Whole disks have an entry in /sys/block, partitions don't
+    char path[BUFFER_SIZE];
+    snprintf(path, sizeof(path), "/sys/block/%s", name);
+    return access(path, F_OK) == 0;
+}
+
+void get_disk_stats(sysinfo_t *sysinfo) {
+    if (!sysinfo) return;
+    
+    static unsigned long long prev_read_sectors = 0, prev_write_sectors = 0;
+    static double prev_time = 0.0;
+    
+    FILE *fp = fopen("/proc/diskstats", "r");
+    if (!fp) return;
+    
+    // Format: major minor name reads merged sectors_read ms writes merged sectors_written ...
+    char buffer[BUFFER_SIZE];
+    char name[64];
+    unsigned long long read_sectors = 0, write_sectors = 0;
+    while (fgets(buffer, sizeof(buffer), fp)) {
+        unsigned long long rd, wr;
+        if (sscanf(buffer, "%*u %*u %63s %*u %*u %llu %*u %*u %*u %llu", name, &rd, &wr) == 3 &&
+            is_whole_disk(name)) {
+            read_sectors += rd;
+            write_sectors += wr;
+        }
+    }
+    fclose(fp);
+    
+    // Sectors in diskstats are always 512 bytes
+    double now = monotonic_seconds();
+    if (prev_time > 0.0) {
+        double elapsed = now - prev_time;
+        sysinfo->disk_read_rate = counter_rate(read_sectors, prev_read_sectors, elapsed) * 512.0f;
+        sysinfo->disk_write_rate = counter_rate(write_sectors, prev_write_sectors, elapsed) * 512.0f;
+        sysinfo->disk_valid = true;
+    }
+    prev_read_sectors = read_sectors;
+    prev_write_sectors = write_sectors;
+    prev_time = now;
+}
+
 int is_pid(const char* str) {
     if (!str || *str == '\0') return 0;  // Check for NULL or empty string
     for (int i = 0; str[i] != '\0'; i++) {
@@ -184,6 +700,19 @@ int get_uid(const char* username, uid_t* uid) {
     return 0;
 }
 
+void get_username(uid_t uid, char *buffer, size_t size) {
+    if (!buffer || size == 0) return;
+    
+    struct passwd *pw = getpwuid(uid);
+    if (pw) {
+        strncpy(buffer, pw->pw_name, size - 1);
+        buffer[size - 1] = '\0';
+    } else {
+        // If username not found, use UID as string
+        snprintf(buffer, size, "%u", uid);
+    }
+}
+
 int get_cmdline(pid_t pid, char *buffer, size_t size) {
     // Validate input parameters
     if (!buffer || size == 0) {
@@ -204,33 +733,7 @@ int get_cmdline(pid_t pid, char *buffer, size_t size) {
     size_t bytes_read = fread(buffer, 1, size - 1, fp);
     fclose(fp);
     
-    // Handle empty cmdline (kernel threads)
-    if (bytes_read == 0) {
-        buffer[0] = '\0';
-        return 0;
-    }
-    
-    // ========================================================================
-    // Process the cmdline: replace null bytes with spaces
-    // ========================================================================
-    // The cmdline file contains arguments separated by null bytes:
-    // Example: "/usr/bin/vim\0project.c\0" -> "/usr/bin/vim project.c"
-    
-    for (size_t i = 0; i < bytes_read - 1; i++) {
-        if (buffer[i] == '\0') {
-            buffer[i] = ' ';  // Replace null with space
-        }
-    }
-    
-    // Ensure the string is null-terminated
-    buffer[bytes_read] = '\0';
-    
-    // Remove trailing spaces (if any)
-    while (bytes_read > 0 && buffer[bytes_read - 1] == ' ') {
-        buffer[--bytes_read] = '\0';
-    }
-    
-    return (int)bytes_read;  // Return number of bytes written
+    return format_cmdline(buffer, bytes_read);
 }
 
 void get_system_info(sysinfo_t *sysinfo) {
@@ -245,16 +748,37 @@ void get_system_info(sysinfo_t *sysinfo) {
     // Read memory info from /proc/meminfo
     fp = fopen("/proc/meminfo", "r");
     if (fp) {
-        unsigned long total_mem = 0, free_mem = 0, buffers = 0, cached = 0;
+        unsigned long value = 0;
+        unsigned long buffers = 0, cached = 0, reclaimable = 0, swap_free = 0;
+        bool has_available = false;
         while (fgets(buffer, sizeof(buffer), fp)) {
-            if (sscanf(buffer, "MemTotal: %lu kB", &total_mem) == 1) sysinfo->total_mem = total_mem * 1024;
-            if (sscanf(buffer, "MemFree: %lu kB", &free_mem) == 1) sysinfo->free_mem = free_mem * 1024;
-            if (sscanf(buffer, "Buffers: %lu kB", &buffers) == 1) {} // Part of free
-            if (sscanf(buffer, "Cached: %lu kB", &cached) == 1) {}   // Part of free
+            if (sscanf(buffer, "MemTotal: %lu kB", &value) == 1) sysinfo->total_mem = value * 1024;
+            else if (sscanf(buffer, "MemFree: %lu kB", &value) == 1) sysinfo->free_mem = value * 1024;
+            else if (sscanf(buffer, "MemAvailable: %lu kB", &value) == 1) {
+                sysinfo->available_mem = value * 1024;
+                has_available = true;
+            }
+            else if (sscanf(buffer, "Buffers: %lu kB", &value) == 1) buffers = value * 1024;
+            else if (sscanf(buffer, "Cached: %lu kB", &value) == 1) cached = value * 1024;
+            else if (sscanf(buffer, "SReclaimable: %lu kB", &value) == 1) reclaimable = value * 1024;
+            else if (sscanf(buffer, "Shmem: %lu kB", &value) == 1) sysinfo->shared_mem = value * 1024;
+            else if (sscanf(buffer, "SwapTotal: %lu kB", &value) == 1) sysinfo->swap_total = value * 1024;
+            else if (sscanf(buffer, "SwapFree: %lu kB", &value) == 1) swap_free = value * 1024;
         }
         fclose(fp);
         
-        sysinfo->used_mem = sysinfo->total_mem - sysinfo->free_mem;
+        sysinfo->cached_mem = buffers + cached + reclaimable;
+        if (!has_available) {
+            // Kernels before 3.14: page cache and buffers are reclaimable
+            sysinfo->available_mem = sysinfo->free_mem + sysinfo->cached_mem;
+        }
+        if (sysinfo->available_mem > sysinfo->total_mem) {
+            sysinfo->available_mem = sysinfo->total_mem;
+        }
+        sysinfo->swap_used = (sysinfo->swap_total > swap_free) ? sysinfo->swap_total - swap_free : 0;
+        
+        // "Used" is what can't be reclaimed, not total - free
+        sysinfo->used_mem = sysinfo->total_mem - sysinfo->available_mem;
         if (sysinfo->total_mem > 0) {
             sysinfo->mem_usage_percent = (float)sysinfo->used_mem / sysinfo->total_mem * 100.0f;
         }
@@ -308,6 +832,54 @@ static int compare_by_mem(const void* a, const void* b) {
     return 0;
 }
 
+static int compare_by_io_read(const void* a, const void* b) {
+    const ProcessInfo* pa = (const ProcessInfo*)a;
+    const ProcessInfo* pb = (const ProcessInfo*)b;
+    // Descending order (highest disk read rate first)
+    if (pb->read_rate > pa->read_rate) return 1;
+    if (pb->read_rate < pa->read_rate) return -1;
+    return 0;
+}
+
+static int compare_by_io_write(const void* a, const void* b) {
+    const ProcessInfo* pa = (const ProcessInfo*)a;
+    const ProcessInfo* pb = (const ProcessInfo*)b;
+    // Descending order (highest disk write rate first)
+    if (pb->write_rate > pa->write_rate) return 1;
+    if (pb->write_rate < pa->write_rate) return -1;
+    return 0;
+}
+
+static int compare_by_sched_wait(const void* a, const void* b) {
+    const ProcessInfo* pa = (const ProcessInfo*)a;
+    const ProcessInfo* pb = (const ProcessInfo*)b;
+    // Descending order (longest run-queue wait first)
+    if (pb->wait_rate > pa->wait_rate) return 1;
+    if (pb->wait_rate < pa->wait_rate) return -1;
+    return 0;
+}
+
+static int compare_by_ctx_switches(const void* a, const void* b) {
+    const ProcessInfo* pa = (const ProcessInfo*)a;
+    const ProcessInfo* pb = (const ProcessInfo*)b;
+    float rate_a = pa->csw_rate + pa->icsw_rate;
+    float rate_b = pb->csw_rate + pb->icsw_rate;
+    if (rate_b > rate_a) return 1;
+    if (rate_b < rate_a) return -1;
+    return 0;
+}
+
+static int compare_by_faults(const void* a, const void* b) {
+    const ProcessInfo* pa = (const ProcessInfo*)a;
+    const ProcessInfo* pb = (const ProcessInfo*)b;
+    // Major faults hit the disk, so they rank before any number of minor ones
+    if (pb->majflt_rate > pa->majflt_rate) return 1;
+    if (pb->majflt_rate < pa->majflt_rate) return -1;
+    if (pb->minflt_rate > pa->minflt_rate) return 1;
+    if (pb->minflt_rate < pa->minflt_rate) return -1;
+    return 0;
+}
+
 static int compare_by_user(const void* a, const void* b) {
     const ProcessInfo* pa = (const ProcessInfo*)a;
     const ProcessInfo* pb = (const ProcessInfo*)b;
@@ -330,6 +902,21 @@ void sort_processes(ProcessInfo processes[], int count, SortMode mode) {
         case SORT_BY_USER:
             qsort(processes, count, sizeof(ProcessInfo), compare_by_user);
             break;
+        case SORT_BY_IO_READ:
+            qsort(processes, count, sizeof(ProcessInfo), compare_by_io_read);
+            break;
+        case SORT_BY_IO_WRITE:
+            qsort(processes, count, sizeof(ProcessInfo), compare_by_io_write);
+            break;
+        case SORT_BY_SCHED_WAIT:
+            qsort(processes, count, sizeof(ProcessInfo), compare_by_sched_wait);
+            break;
+        case SORT_BY_CTX_SWITCHES:
+            qsort(processes, count, sizeof(ProcessInfo), compare_by_ctx_switches);
+            break;
+        case SORT_BY_FAULTS:
+            qsort(processes, count, sizeof(ProcessInfo), compare_by_faults);
+            break;
     }
 }
 
@@ -358,91 +945,44 @@ int filter_processes_advanced(const ProcessInfo processes[], int count,
                                float mem_threshold_mb) {
     if (!processes || !filtered || count <= 0) return 0;
     
-    int filtered_count = 0;
+    // Compile the criteria once so rows are tested without per-row string work
+    ProcessFilter filter;
+    memset(&filter, 0, sizeof(filter));
     
-    for (int i = 0; i < count; i++) {
-        bool passes = true;
-        
-        // Filter by username
-        if (username && strlen(username) > 0) {
-            if (strcmp(processes[i].user, username) != 0) {
-                passes = false;
-            }
-        }
-        
-        // Filter by process name (substring match, case-insensitive)
-        if (passes && name_filter && strlen(name_filter) > 0) {
-            char name_lower[MAX_NAME_LEN];
-            char filter_lower[MAX_NAME_LEN];
-            
-            // Convert to lowercase for case-insensitive matching
-            for (size_t j = 0; j < strlen(processes[i].name) && j < MAX_NAME_LEN-1; j++) {
-                name_lower[j] = tolower(processes[i].name[j]);
-            }
-            name_lower[strlen(processes[i].name)] = '\0';
-            
-            for (size_t j = 0; j < strlen(name_filter) && j < MAX_NAME_LEN-1; j++) {
-                filter_lower[j] = tolower(name_filter[j]);
-            }
-            filter_lower[strlen(name_filter)] = '\0';
-            
-            if (strstr(name_lower, filter_lower) == NULL) {
-                passes = false;
-            }
-        }
-        
-        // Filter by state
-        if (passes && state_filter != 0) {
-            if (processes[i].state != state_filter) {
-                passes = false;
-            }
-        }
-        
-        // Filter by memory threshold (in MB)
-        if (passes && mem_threshold_mb > 0) {
-            float mem_mb = (float)processes[i].rss / (1024.0f * 1024.0f);
-            if (mem_mb < mem_threshold_mb) {
-                passes = false;
-            }
-        }
-        
-        if (passes) {
-            filtered[filtered_count++] = processes[i];
-        }
+    // Cheapest first: memory and state before string compares
+    if (mem_threshold_mb > 0) {
+        FilterTerm *term = &filter.terms[filter.count++];
+        term->field = FILTER_RSS;
+        term->op = FILTER_OP_GE;
+        term->number = mem_threshold_mb * 1024.0 * 1024.0;
     }
     
-    return filtered_count;
-}
-
-void build_process_tree(ProcessInfo processes[], int count) {
-    if (!processes || count <= 0) return;
+    if (state_filter != 0) {
+        FilterTerm *term = &filter.terms[filter.count++];
+        term->field = FILTER_STATE;
+        term->op = FILTER_OP_EQ;
+        term->state = state_filter;
+    }
     
-    // First pass: reset all depths
-    for (int i = 0; i < count; i++) {
-        processes[i].tree_depth = 0;
+    if (username && username[0] != '\0') {
+        FilterTerm *term = &filter.terms[filter.count++];
+        term->field = FILTER_USER;
+        term->op = FILTER_OP_EQ;
+        snprintf(term->text, sizeof(term->text), "%s", username);
+        term->text_len = strlen(term->text);
     }
     
-    // Calculate depth for each process by walking up parent chain
-    for (int i = 0; i < count; i++) {
-        int depth = 0;
-        pid_t current_ppid = processes[i].ppid;
-        
-        // Walk up the parent chain (max 50 levels to prevent infinite loops)
-        for (int level = 0; level < 50 && current_ppid > 0; level++) {
-            // Find parent in the array
-            bool found = false;
-            for (int j = 0; j < count; j++) {
-                if (processes[j].pid == current_ppid) {
-                    current_ppid = processes[j].ppid;
-                    depth++;
-                    found = true;
-                    break;
-                }
-            }
-            
-            if (!found) break;  // Parent not in our list
+    // Process name: substring match, case-insensitive
+    if (name_filter && name_filter[0] != '\0') {
+        FilterTerm *term = &filter.terms[filter.count++];
+        term->field = FILTER_NAME;
+        term->op = FILTER_OP_CONTAINS;
+        snprintf(term->text, sizeof(term->text), "%s", name_filter);
+        term->text_len = strlen(term->text);
+        for (size_t j = 0; j < term->text_len; j++) {
+            term->text[j] = (char)tolower((unsigned char)term->text[j]);
         }
-        
-        processes[i].tree_depth = depth;
     }
+    
+    return filter_apply(&filter, processes, count, filtered);
 }
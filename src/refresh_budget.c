@@ -0,0 +1,103 @@
+#define _POSIX_C_SOURCE 200809L
+#include <time.h>
+#include "refresh_budget.h"
+#include "process_monitor.h"
+
+// Weight of the newest sample in the smoothed cost estimates
+#define COST_SMOOTHING 0.3
+
+// Leave degraded mode only once a full refresh fits comfortably in max_ms
+#define RECOVERY_MARGIN 0.8
+
+static double smooth(double average, double sample) {
+    if (average <= 0.0) return sample;  // First sample seeds the average
+    return average + COST_SMOOTHING * (sample - average);
+}
+
+static int clamp_interval(const RefreshBudget *budget, double ms) {
+    if (ms < budget->min_ms) return budget->min_ms;
+    if (ms > budget->max_ms) return budget->max_ms;
+    return (int)ms;
+}
+
+void refresh_budget_init(RefreshBudget *budget, float budget_percent,
+                         int base_ms, int min_ms, int max_ms) {
+    if (!budget) return;
+
+    memset(budget, 0, sizeof(RefreshBudget));
+
+    // Keep the bounds sane even with a hand-edited config
+    if (min_ms <= 0) min_ms = base_ms;
+    if (max_ms < min_ms) max_ms = min_ms;
+
+    budget->budget_percent = budget_percent > 0.0f ? budget_percent : 0.0f;
+    budget->base_ms = base_ms;
+    budget->min_ms = min_ms;
+    budget->max_ms = max_ms;
+    budget->interval_ms = base_ms;
+}
+
+void refresh_budget_begin(RefreshBudget *budget) {
+    if (!budget) return;
+
+    budget->refresh_cpu_start = clock_seconds(CLOCK_PROCESS_CPUTIME_ID);
+
+    // Degraded refreshes are interleaved with a periodic full one
+    budget->current_degraded = budget->degraded &&
+                               budget->degraded_streak < BUDGET_FULL_SCAN_EVERY;
+}
+
+void refresh_budget_end(RefreshBudget *budget) {
+    if (!budget) return;
+
+    double now_cpu = clock_seconds(CLOCK_PROCESS_CPUTIME_ID);
+    double now_wall = monotonic_seconds();
+
+    budget->last_cost = now_cpu - budget->refresh_cpu_start;
+
+    // Own CPU share over the whole cycle, including the idle key-polling loop
+    if (budget->cycle_wall_start > 0.0 && now_wall > budget->cycle_wall_start) {
+        budget->self_cpu_percent = (float)((now_cpu - budget->cycle_cpu_start) /
+                                           (now_wall - budget->cycle_wall_start) * 100.0);
+    }
+    budget->cycle_cpu_start = now_cpu;
+    budget->cycle_wall_start = now_wall;
+
+    if (budget->current_degraded) {
+        budget->degraded_cost = smooth(budget->degraded_cost, budget->last_cost);
+        budget->degraded_streak++;
+    } else {
+        budget->full_cost = smooth(budget->full_cost, budget->last_cost);
+        budget->degraded_streak = 0;
+    }
+
+    if (budget->budget_percent <= 0.0f) {
+        budget->interval_ms = budget->base_ms;
+        budget->degraded = false;
+        return;
+    }
+
+    // Interval at which a full refresh would consume exactly the budget
+    double share = budget->budget_percent / 100.0;
+    double full_ms = budget->full_cost / share * 1000.0;
+    double limit_ms = budget->degraded ? budget->max_ms * RECOVERY_MARGIN : budget->max_ms;
+
+    if (full_ms <= limit_ms) {
+        budget->degraded = false;
+        budget->interval_ms = clamp_interval(budget, full_ms);
+        return;
+    }
+
+    // Over budget even at max_ms: degrade, accounting for the periodic full refresh
+    budget->degraded = true;
+    double degraded_cost = budget->degraded_cost > 0.0 ? budget->degraded_cost
+                                                       : budget->full_cost;
+    double average_cost = (degraded_cost * BUDGET_FULL_SCAN_EVERY + budget->full_cost) /
+                          (BUDGET_FULL_SCAN_EVERY + 1);
+    budget->interval_ms = clamp_interval(budget, average_cost / share * 1000.0);
+}
+
+unsigned int refresh_budget_scan_flags(const RefreshBudget *budget) {
+    if (!budget || !budget->current_degraded) return 0;
+    return SCAN_SKIP_STATUS | SCAN_SKIP_CMDLINE;
+}
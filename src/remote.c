@@ -0,0 +1,640 @@
+#define _POSIX_C_SOURCE 200809L
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdint.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include "remote.h"
+#include "process_monitor.h"
+#include "proc_table.h"
+#include "data_source.h"
+#include "config.h"
+#include "signal_handler.h"
+#include "cpu_stats.h"
+#include "shm_snapshot.h"
+#include "exporter.h"
+#include "history.h"
+
+extern volatile sig_atomic_t keep_running;
+
+enum { MSG_SNAPSHOT = 1, MSG_DELTA = 2 };
+enum { REC_UPDATE = 1, REC_FULL = 2 };  // REC_FULL carries the strings too
+
+typedef struct {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t type;
+    uint32_t length;        // Payload bytes after this header
+    uint32_t sysinfo_size;  // sizeof(sysinfo_t) of the sender, guards mixed builds
+    uint32_t removed;       // PIDs in the removal list
+    uint32_t records;       // Records after the removal list
+} WireHeader;
+
+// Payload: sysinfo_t, int32_t removed[], then records sorted by PID. A
+// REC_FULL record is followed by its name, user and cmdline (no NULs).
+typedef struct {
+    uint64_t vsize, rss, start_ticks, utime, stime;
+    uint64_t read_bytes, write_bytes, rchar, wchar;
+    uint64_t cpu_delay_ns, blkio_delay_ns;
+    uint64_t minflt, majflt, sched_wait_ns, nvcsw, nivcsw;
+    int32_t pid, ppid;
+    uint32_t uid;
+    float cpu_usage, mem_usage, read_rate, write_rate, rchar_rate, wchar_rate;
+    float wait_rate, csw_rate, icsw_rate, minflt_rate, majflt_rate;
+    uint16_t name_len, user_len, cmdline_len;
+    uint8_t kind;
+    char state;
+    uint8_t kernel_thread;
+    uint8_t has_sched;
+} WireRecord;
+
+// Growable byte buffer for encoding and receiving
+typedef struct {
+    char *data;
+    size_t len;
+    size_t cap;
+} Buffer;
+
+static bool buffer_reserve(Buffer *b, size_t extra) {
+    if (b->len + extra <= b->cap) return true;
+    size_t cap = b->cap ? b->cap : 65536;
+    while (cap < b->len + extra) cap *= 2;
+    char *data = realloc(b->data, cap);
+    if (!data) return false;
+    b->data = data;
+    b->cap = cap;
+    return true;
+}
+
+static bool buffer_append(Buffer *b, const void *data, size_t len) {
+    if (len == 0) return true;
+    if (!buffer_reserve(b, len)) return false;
+    memcpy(b->data + b->len, data, len);
+    b->len += len;
+    return true;
+}
+
+void remote_default_path(char *buffer, size_t size) {
+    const char *runtime = getenv("XDG_RUNTIME_DIR");
+    if (runtime && runtime[0] == '/') {
+        snprintf(buffer, size, "%s/alttasker.sock", runtime);
+    } else {
+        snprintf(buffer, size, "/tmp/alttasker-%u.sock", (unsigned int)getuid());
+    }
+}
+
+static int make_address(const char *path, struct sockaddr_un *addr) {
+    memset(addr, 0, sizeof(*addr));
+    addr->sun_family = AF_UNIX;
+    if (strlen(path) >= sizeof(addr->sun_path)) return -1;
+    memcpy(addr->sun_path, path, strlen(path) + 1);
+    return 0;
+}
+
+// ============================================================================
+// Daemon
+// ============================================================================
+
+static ProcessInfo snapshot[MAX_PROCESS];   // Latest scan, sorted by PID
+static ProcessInfo previous[MAX_PROCESS];   // Scan the last delta was made against
+static int snapshot_count = 0;
+static int previous_count = 0;
+static Buffer records_out;
+static Buffer removed_out;
+static Buffer message_out;
+
+static int compare_pid(const void *a, const void *b) {
+    const ProcessInfo *pa = (const ProcessInfo *)a;
+    const ProcessInfo *pb = (const ProcessInfo *)b;
+    return (pa->pid > pb->pid) - (pa->pid < pb->pid);
+}
+
+static void to_wire(const ProcessInfo *p, WireRecord *r) {
+    memset(r, 0, sizeof(WireRecord));  // Padding too, records are compared with memcmp
+    r->vsize = p->vsize;
+    r->rss = p->rss;
+    r->start_ticks = p->start_ticks;
+    r->utime = p->utime;
+    r->stime = p->stime;
+    r->read_bytes = p->read_bytes;
+    r->write_bytes = p->write_bytes;
+    r->rchar = p->rchar;
+    r->wchar = p->wchar;
+    r->cpu_delay_ns = p->cpu_delay_ns;
+    r->blkio_delay_ns = p->blkio_delay_ns;
+    r->minflt = p->minflt;
+    r->majflt = p->majflt;
+    r->sched_wait_ns = p->sched_wait_ns;
+    r->nvcsw = p->nvcsw;
+    r->nivcsw = p->nivcsw;
+    r->pid = p->pid;
+    r->ppid = p->ppid;
+    r->uid = p->uid;
+    r->cpu_usage = p->cpu_usage;
+    r->mem_usage = p->mem_usage;
+    r->read_rate = p->read_rate;
+    r->write_rate = p->write_rate;
+    r->rchar_rate = p->rchar_rate;
+    r->wchar_rate = p->wchar_rate;
+    r->wait_rate = p->wait_rate;
+    r->csw_rate = p->csw_rate;
+    r->icsw_rate = p->icsw_rate;
+    r->minflt_rate = p->minflt_rate;
+    r->majflt_rate = p->majflt_rate;
+    r->state = p->state;
+    r->kernel_thread = p->is_kernel_thread;
+    r->has_sched = p->has_sched;
+}
+
+static bool same_strings(const ProcessInfo *a, const ProcessInfo *b) {
+    return strcmp(a->name, b->name) == 0 && strcmp(a->user, b->user) == 0 &&
+           strcmp(a->cmdline, b->cmdline) == 0;
+}
+
+static bool append_full(const ProcessInfo *p) {
+    WireRecord r;
+    to_wire(p, &r);
+    r.kind = REC_FULL;
+    r.name_len = (uint16_t)strlen(p->name);
+    r.user_len = (uint16_t)strlen(p->user);
+    r.cmdline_len = (uint16_t)strlen(p->cmdline);
+    return buffer_append(&records_out, &r, sizeof(r)) &&
+           buffer_append(&records_out, p->name, r.name_len) &&
+           buffer_append(&records_out, p->user, r.user_len) &&
+           buffer_append(&records_out, p->cmdline, r.cmdline_len);
+}
+
+// Encodes 'cur' against 'old' (both sorted by PID) into message_out
+static bool encode(int type, const ProcessInfo old[], int old_count,
+                   const ProcessInfo cur[], int cur_count, const sysinfo_t *sysinfo) {
+    records_out.len = removed_out.len = message_out.len = 0;
+    uint32_t records = 0;
+    int i = 0, j = 0;
+
+    // One merge pass over both PID-sorted tables
+    while (i < old_count || j < cur_count) {
+        if (j >= cur_count || (i < old_count && old[i].pid < cur[j].pid)) {
+            int32_t pid = old[i++].pid;
+            if (!buffer_append(&removed_out, &pid, sizeof(pid))) return false;
+            continue;
+        }
+        if (i >= old_count || cur[j].pid < old[i].pid ||
+            cur[j].start_ticks != old[i].start_ticks) {
+            if (i < old_count && cur[j].pid == old[i].pid) i++;  // PID reused: replace the row
+            if (!append_full(&cur[j++])) return false;
+            records++;
+            continue;
+        }
+
+        // Same process in both: send it only if something changed
+        const ProcessInfo *before = &old[i++];
+        const ProcessInfo *after = &cur[j++];
+        if (!same_strings(before, after)) {
+            if (!append_full(after)) return false;
+            records++;
+        } else {
+            WireRecord a, b;
+            to_wire(before, &a);
+            to_wire(after, &b);
+            if (memcmp(&a, &b, sizeof(WireRecord)) != 0) {
+                b.kind = REC_UPDATE;
+                if (!buffer_append(&records_out, &b, sizeof(b))) return false;
+                records++;
+            }
+        }
+    }
+
+    WireHeader header = {
+        .magic = REMOTE_MAGIC,
+        .version = REMOTE_VERSION,
+        .type = (uint16_t)type,
+        .length = (uint32_t)(sizeof(sysinfo_t) + removed_out.len + records_out.len),
+        .sysinfo_size = (uint32_t)sizeof(sysinfo_t),
+        .removed = (uint32_t)(removed_out.len / sizeof(int32_t)),
+        .records = records,
+    };
+    return buffer_append(&message_out, &header, sizeof(header)) &&
+           buffer_append(&message_out, sysinfo, sizeof(sysinfo_t)) &&
+           buffer_append(&message_out, removed_out.data, removed_out.len) &&
+           buffer_append(&message_out, records_out.data, records_out.len);
+}
+
+// Sends a whole message; a client that can't take it within the timeout is dropped
+static bool send_all(int fd, const char *data, size_t len) {
+    while (len > 0) {
+        ssize_t sent = send(fd, data, len, MSG_NOSIGNAL);
+        if (sent < 0 && errno == EINTR) continue;
+        if (sent <= 0) return false;
+        data += sent;
+        len -= (size_t)sent;
+    }
+    return true;
+}
+
+static int open_listener(const char *path) {
+    struct sockaddr_un addr;
+    if (make_address(path, &addr) != 0) {
+        fprintf(stderr, "Socket path too long: %s\n", path);
+        return -1;
+    }
+
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        perror("socket");
+        return -1;
+    }
+
+    mode_t old_mask = umask(0077);  // Socket file created as 0600
+    int rc = bind(fd, (struct sockaddr *)&addr, sizeof(addr));
+    if (rc != 0 && errno == EADDRINUSE) {
+        // Left over from a daemon that died, unless one still answers
+        int probe = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        bool alive = probe >= 0 && connect(probe, (struct sockaddr *)&addr, sizeof(addr)) == 0;
+        if (probe >= 0) close(probe);
+        if (alive) {
+            umask(old_mask);
+            fprintf(stderr, "A daemon is already listening on %s\n", path);
+            close(fd);
+            return -1;
+        }
+        unlink(path);
+        rc = bind(fd, (struct sockaddr *)&addr, sizeof(addr));
+    }
+    umask(old_mask);
+
+    if (rc != 0 || listen(fd, REMOTE_MAX_CLIENTS) != 0) {
+        fprintf(stderr, "Cannot listen on %s: %s\n", path, strerror(errno));
+        close(fd);
+        return -1;
+    }
+    fcntl(fd, F_SETFL, O_NONBLOCK);
+    return fd;
+}
+
+int run_daemon(const char *path) {
+    setup_signal_handler();
+    data_source_select(global_config.data_source);
+
+    int listen_fd = open_listener(path);
+    if (listen_fd < 0) {
+        data_source_shutdown();
+        return 1;
+    }
+    fprintf(stderr, "AltTasker daemon listening on %s (every %ds)\n",
+            path, global_config.refresh_interval);
+
+    int clients[REMOTE_MAX_CLIENTS];
+    int client_count = 0;
+    if (global_config.shm_snapshot && shm_snapshot_open() != 0) {
+        fprintf(stderr, "Shared-memory snapshot not published (another instance owns it)\n");
+    }
+    if (global_config.history) {
+        char history_dir[PATH_MAX];
+        history_get_dir(history_dir, sizeof(history_dir));
+        if (history_open(history_dir, global_config.history_max_mb) == 0) {
+            fprintf(stderr, "Recording history in %s (%d MiB)\n", history_dir, global_config.history_max_mb);
+        } else {
+            fprintf(stderr, "History not recorded (%s is unusable or another instance records)\n",
+                    history_dir);
+        }
+    }
+
+    int exporter_fd = -1;
+    if (global_config.exporter_port > 0) {
+        exporter_fd = exporter_open(global_config.exporter_port);
+        if (exporter_fd < 0) {
+            fprintf(stderr, "Cannot serve metrics on 127.0.0.1:%d: %s\n",
+                    global_config.exporter_port, strerror(errno));
+        } else {
+            fprintf(stderr, "Prometheus metrics on http://127.0.0.1:%d/metrics\n",
+                    global_config.exporter_port);
+        }
+    }
+
+    static CpuStats cpu_stats;
+    sysinfo_t sysinfo;
+    memset(&sysinfo, 0, sizeof(sysinfo));
+    cpu_stats_sample(&cpu_stats);
+    bool have_snapshot = false;
+    double next_scan = 0.0;
+
+    while (keep_running) {
+        double now = monotonic_seconds();
+        if (now >= next_scan) {
+            next_scan = now + global_config.refresh_interval;
+
+            get_system_info(&sysinfo);
+            get_disk_stats(&sysinfo);
+            cpu_stats_sample(&cpu_stats);
+            sysinfo.cpu_usage_percent = cpu_share_busy(&cpu_stats.total);
+            // Clients cannot ask for the scheduler rates: the daemon's own config decides
+            unsigned int scan_flags = SCAN_READ_IO;
+            if (global_config.show_sched_columns) scan_flags |= SCAN_READ_SCHED;
+            snapshot_count = scan_processes(snapshot, MAX_PROCESS, sysinfo.total_mem, scan_flags);
+            if (snapshot_count < 0) snapshot_count = 0;
+            shm_snapshot_publish(snapshot, snapshot_count, &sysinfo);
+            history_record(snapshot, snapshot_count, &sysinfo);
+            if (exporter_fd >= 0) {
+                exporter_render(snapshot, snapshot_count, &sysinfo, global_config.exporter_top);
+            }
+            qsort(snapshot, snapshot_count, sizeof(ProcessInfo), compare_pid);
+
+            // Every client is in sync with 'previous', so one encoded delta serves all
+            if (have_snapshot && client_count > 0 &&
+                encode(MSG_DELTA, previous, previous_count, snapshot, snapshot_count, &sysinfo)) {
+                for (int c = 0; c < client_count; ) {
+                    if (send_all(clients[c], message_out.data, message_out.len)) {
+                        c++;
+                    } else {
+                        close(clients[c]);
+                        clients[c] = clients[--client_count];
+                    }
+                }
+            }
+            memcpy(previous, snapshot, snapshot_count * sizeof(ProcessInfo));
+            previous_count = snapshot_count;
+            have_snapshot = true;
+        }
+
+        struct pollfd fds[REMOTE_MAX_CLIENTS + 1 + EXPORTER_MAX_CONNECTIONS + 1];
+        fds[0].fd = listen_fd;
+        fds[0].events = POLLIN;
+        for (int c = 0; c < client_count; c++) {
+            fds[c + 1].fd = clients[c];
+            fds[c + 1].events = POLLIN;  // Clients never send: readable means closed
+        }
+        struct pollfd *exporter_fds = &fds[client_count + 1];
+        int exporter_count = exporter_fd >= 0 ? exporter_poll_fds(exporter_fd, exporter_fds) : 0;
+
+        int timeout_ms = (int)((next_scan - monotonic_seconds()) * 1000.0) + 1;
+        if (timeout_ms < 0) timeout_ms = 0;
+        if (poll(fds, client_count + 1 + exporter_count, timeout_ms) <= 0) continue;
+
+        if (exporter_count > 0) {
+            exporter_serve(exporter_fd, exporter_fds, exporter_count);  // Answered from the last render
+        }
+
+        for (int c = client_count - 1; c >= 0; c--) {
+            if (fds[c + 1].revents != 0) {
+                close(clients[c]);
+                clients[c] = clients[--client_count];
+            }
+        }
+
+        if (fds[0].revents & POLLIN) {
+            int fd;
+            while ((fd = accept(listen_fd, NULL, NULL)) >= 0) {
+                fcntl(fd, F_SETFD, FD_CLOEXEC);
+                struct timeval timeout = { .tv_sec = 1, .tv_usec = 0 };
+                setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+
+                // A new client starts from a full snapshot of the last scan
+                bool ok = client_count < REMOTE_MAX_CLIENTS && have_snapshot &&
+                          encode(MSG_SNAPSHOT, NULL, 0, previous, previous_count, &sysinfo) &&
+                          send_all(fd, message_out.data, message_out.len);
+                if (ok) {
+                    clients[client_count++] = fd;
+                } else {
+                    close(fd);
+                }
+            }
+        }
+    }
+
+    for (int c = 0; c < client_count; c++) {
+        close(clients[c]);
+    }
+    close(listen_fd);
+    unlink(path);
+    free(records_out.data);
+    free(removed_out.data);
+    free(message_out.data);
+    shm_snapshot_close();
+    history_close();
+    if (exporter_fd >= 0) exporter_close(exporter_fd);
+    cpu_stats_close();
+    data_source_shutdown();
+    fprintf(stderr, "AltTasker daemon stopped\n");
+    return 0;
+}
+
+// ============================================================================
+// Client
+// ============================================================================
+
+static int client_fd = -1;
+static char client_path[sizeof(((struct sockaddr_un *)0)->sun_path)];
+static Buffer inbox;
+static ProcessInfo rows[MAX_PROCESS];     // Mirror of the daemon's table, sorted by PID
+static ProcessInfo merged[MAX_PROCESS];
+static int row_count = 0;
+static bool synced = false;               // A full snapshot has been applied
+static sysinfo_t remote_sysinfo;
+
+int remote_connect(const char *path) {
+    struct sockaddr_un addr;
+    if (make_address(path, &addr) != 0) return -1;
+
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) return -1;
+    if (connect(fd, (struct sockaddr *)&addr, sizeof(addr)) != 0) {
+        close(fd);
+        return -1;
+    }
+    fcntl(fd, F_SETFL, O_NONBLOCK);
+
+    remote_close();
+    client_fd = fd;
+    snprintf(client_path, sizeof(client_path), "%s", path);
+    return 0;
+}
+
+static void from_wire(const WireRecord *r, ProcessInfo *p) {
+    p->vsize = r->vsize;
+    p->rss = r->rss;
+    p->start_ticks = r->start_ticks;
+    p->starttime = (time_t)(r->start_ticks / sysconf(_SC_CLK_TCK));
+    p->utime = r->utime;
+    p->stime = r->stime;
+    p->read_bytes = r->read_bytes;
+    p->write_bytes = r->write_bytes;
+    p->rchar = r->rchar;
+    p->wchar = r->wchar;
+    p->cpu_delay_ns = r->cpu_delay_ns;
+    p->blkio_delay_ns = r->blkio_delay_ns;
+    p->minflt = r->minflt;
+    p->majflt = r->majflt;
+    p->sched_wait_ns = r->sched_wait_ns;
+    p->nvcsw = r->nvcsw;
+    p->nivcsw = r->nivcsw;
+    p->pid = r->pid;
+    p->ppid = r->ppid;
+    p->uid = r->uid;
+    p->cpu_usage = r->cpu_usage;
+    p->mem_usage = r->mem_usage;
+    p->read_rate = r->read_rate;
+    p->write_rate = r->write_rate;
+    p->rchar_rate = r->rchar_rate;
+    p->wchar_rate = r->wchar_rate;
+    p->wait_rate = r->wait_rate;
+    p->csw_rate = r->csw_rate;
+    p->icsw_rate = r->icsw_rate;
+    p->minflt_rate = r->minflt_rate;
+    p->majflt_rate = r->majflt_rate;
+    p->state = r->state;
+    p->is_kernel_thread = r->kernel_thread != 0;
+    p->has_sched = r->has_sched != 0;
+}
+
+// Copies 'len' bytes of wire text into a NUL-terminated field
+static void copy_text(char *dest, size_t size, const char *src, size_t len) {
+    size_t n = len < size - 1 ? len : size - 1;
+    memcpy(dest, src, n);
+    dest[n] = '\0';
+}
+
+// Applies one complete message; returns false if it is malformed
+static bool apply_message(const WireHeader *header, const char *payload) {
+    if (header->type == MSG_DELTA && !synced) return true;  // Wait for the snapshot
+
+    const char *end = payload + header->length;
+    const char *p = payload;
+    memcpy(&remote_sysinfo, p, sizeof(sysinfo_t));
+    p += sizeof(sysinfo_t);
+
+    const char *removed = p;
+    p += (size_t)header->removed * sizeof(int32_t);
+    if (p > end) return false;
+
+    // Drop exited PIDs (both lists are sorted by PID)
+    int kept = 0;
+    if (header->type == MSG_DELTA) {
+        uint32_t r = 0;
+        for (int i = 0; i < row_count; i++) {
+            int32_t pid = 0;
+            while (r < header->removed) {
+                memcpy(&pid, removed + r * sizeof(int32_t), sizeof(pid));
+                if (pid >= rows[i].pid) break;
+                r++;
+            }
+            if (r < header->removed && pid == rows[i].pid) continue;
+            rows[kept++] = rows[i];
+        }
+    }
+
+    // Merge the records into the remaining rows
+    int i = 0, out = 0;
+    for (uint32_t n = 0; n < header->records; n++) {
+        WireRecord r;
+        if (p + sizeof(r) > end) return false;
+        memcpy(&r, p, sizeof(r));
+        p += sizeof(r);
+
+        while (i < kept && rows[i].pid < r.pid && out < MAX_PROCESS) {
+            merged[out++] = rows[i++];
+        }
+        if (out >= MAX_PROCESS) break;
+
+        ProcessInfo *row = &merged[out++];
+        if (i < kept && rows[i].pid == r.pid && r.kind == REC_UPDATE) {
+            *row = rows[i];  // Numbers only: the strings stay
+        } else {
+            memset(row, 0, sizeof(ProcessInfo));
+        }
+        if (i < kept && rows[i].pid == r.pid) i++;
+        from_wire(&r, row);
+
+        if (r.kind == REC_FULL) {
+            if (p + r.name_len + r.user_len + r.cmdline_len > end) return false;
+            copy_text(row->name, sizeof(row->name), p, r.name_len);
+            copy_text(row->user, sizeof(row->user), p + r.name_len, r.user_len);
+            copy_text(row->cmdline, sizeof(row->cmdline), p + r.name_len + r.user_len, r.cmdline_len);
+            p += r.name_len + r.user_len + r.cmdline_len;
+        }
+    }
+    while (i < kept && out < MAX_PROCESS) {
+        merged[out++] = rows[i++];
+    }
+
+    memcpy(rows, merged, out * sizeof(ProcessInfo));
+    row_count = out;
+    synced = true;
+    return true;
+}
+
+// Reads whatever is buffered in the socket and applies complete messages
+static int drain(void) {
+    for (;;) {
+        if (!buffer_reserve(&inbox, 65536)) return -1;
+        ssize_t len = recv(client_fd, inbox.data + inbox.len, inbox.cap - inbox.len, 0);
+        if (len > 0) {
+            inbox.len += (size_t)len;
+            continue;
+        }
+        if (len == 0) return -1;  // Daemon went away
+        if (errno == EINTR) continue;
+        if (errno == EAGAIN || errno == EWOULDBLOCK) break;
+        return -1;
+    }
+
+    size_t offset = 0;
+    while (inbox.len - offset >= sizeof(WireHeader)) {
+        WireHeader header;
+        memcpy(&header, inbox.data + offset, sizeof(header));
+        if (header.magic != REMOTE_MAGIC || header.version != REMOTE_VERSION ||
+            header.sysinfo_size != sizeof(sysinfo_t) || header.length > REMOTE_MAX_MESSAGE ||
+            header.length < sizeof(sysinfo_t)) {
+            return -1;
+        }
+        if (inbox.len - offset < sizeof(header) + header.length) break;  // Partial message
+
+        if (!apply_message(&header, inbox.data + offset + sizeof(header))) return -1;
+        offset += sizeof(header) + header.length;
+    }
+
+    memmove(inbox.data, inbox.data + offset, inbox.len - offset);
+    inbox.len -= offset;
+    return 0;
+}
+
+int remote_receive(ProcessInfo processes[], int max_processes, sysinfo_t *sysinfo) {
+    if (!processes || !sysinfo) return -1;
+
+    if (client_fd < 0 || drain() != 0) {
+        // Lost the daemon: try once per call to get a fresh snapshot
+        char path[sizeof(client_path)];
+        snprintf(path, sizeof(path), "%s", client_path);
+        if (path[0] == '\0' || remote_connect(path) != 0) {
+            remote_close();
+            snprintf(client_path, sizeof(client_path), "%s", path);
+            return -1;
+        }
+        if (drain() != 0) return -1;
+    }
+    if (!synced) return 0;
+
+    // Register the rows so per-PID caches (search, cgroups, smaps) work as locally
+    proc_table_begin_scan();
+    int count = (row_count < max_processes) ? row_count : max_processes;
+    for (int i = 0; i < count; i++) {
+        processes[i] = rows[i];
+        proc_table_upsert(rows[i].pid, rows[i].start_ticks);
+    }
+    proc_table_end_scan();
+
+    *sysinfo = remote_sysinfo;
+    return count;
+}
+
+void remote_close(void) {
+    if (client_fd >= 0) close(client_fd);
+    client_fd = -1;
+    inbox.len = 0;
+    row_count = 0;
+    synced = false;
+}
@@ -0,0 +1,310 @@
+#define _POSIX_C_SOURCE 200809L
+#include <regex.h>
+#include "search.h"
+#include "proc_table.h"
+
+// Slots of the string lookup table (power of two, twice the string capacity)
+#define SEARCH_POOL_SLOTS (2 * SEARCH_MAX_STRINGS)
+
+// One interned "name\ncmdline" string
+typedef struct {
+    char *text;
+    char *lower;            // Lower-cased copy, the trigram source
+    size_t len;
+    unsigned int hash;
+    int refs;               // Number of PIDs using this string (0 = free id)
+    unsigned int matched;   // Query stamp of the last query that matched
+} SearchString;
+
+// String ids of one trigram bucket
+typedef struct {
+    int *ids;
+    int count;
+    int capacity;
+} Posting;
+
+static SearchString strings[SEARCH_MAX_STRINGS + 1];  // id 0 means "none"
+static int free_ids[SEARCH_MAX_STRINGS];
+static int free_count = 0;
+static int next_id = 1;
+
+static int slots[SEARCH_POOL_SLOTS];  // Open addressing by hash, 0 = empty
+static Posting postings[TRIGRAM_BUCKETS];
+
+// Active query
+static char query_text[MAX_NAME_LEN];
+static char query_lower[MAX_NAME_LEN];
+static size_t query_len = 0;
+static SearchMode query_mode = SEARCH_IGNORE_CASE;
+static regex_t query_regex;
+static bool regex_ready = false;
+static bool regex_invalid = false;
+static unsigned int query_stamp = 0;
+
+static unsigned int trigram_bucket(const char *p) {
+    unsigned int key = ((unsigned int)(unsigned char)p[0] << 16) |
+                       ((unsigned int)(unsigned char)p[1] << 8) |
+                       (unsigned int)(unsigned char)p[2];
+    return (key * 2654435761u) >> (32 - TRIGRAM_BITS);
+}
+
+static void posting_add(Posting *list, int id) {
+    // Trigrams of one string are added back to back, so a repeated trigram
+    // finds its own id at the tail
+    if (list->count > 0 && list->ids[list->count - 1] == id) return;
+
+    if (list->count == list->capacity) {
+        int capacity = list->capacity ? list->capacity * 2 : 8;
+        int *ids = realloc(list->ids, capacity * sizeof(int));
+        if (!ids) return;
+        list->ids = ids;
+        list->capacity = capacity;
+    }
+    list->ids[list->count++] = id;
+}
+
+static void posting_remove(Posting *list, int id) {
+    for (int i = 0; i < list->count; i++) {
+        if (list->ids[i] == id) {
+            list->ids[i] = list->ids[--list->count];
+            return;
+        }
+    }
+}
+
+static void index_string(int id, bool add) {
+    const char *lower = strings[id].lower;
+    for (size_t i = 0; i + 3 <= strings[id].len; i++) {
+        Posting *list = &postings[trigram_bucket(lower + i)];
+        if (add) {
+            posting_add(list, id);
+        } else {
+            posting_remove(list, id);
+        }
+    }
+}
+
+static unsigned int home_slot(unsigned int hash) {
+    return hash & (SEARCH_POOL_SLOTS - 1);
+}
+
+// Hash an interned string was slotted by (for hash_slots_delete)
+static unsigned int string_hash(int id) {
+    return strings[id].hash;
+}
+
+// Returns the id of 'text', interning it if needed (0 if the pool is full)
+static int intern(const char *text) {
+    unsigned int hash = hash_string(text);
+    unsigned int slot = home_slot(hash);
+
+    while (slots[slot] != 0) {
+        SearchString *s = &strings[slots[slot]];
+        if (s->hash == hash && strcmp(s->text, text) == 0) {
+            s->refs++;
+            return slots[slot];
+        }
+        slot = (slot + 1) & (SEARCH_POOL_SLOTS - 1);
+    }
+
+    int id;
+    if (free_count > 0) {
+        id = free_ids[--free_count];
+    } else if (next_id <= SEARCH_MAX_STRINGS) {
+        id = next_id++;
+    } else {
+        return 0;
+    }
+
+    SearchString *s = &strings[id];
+    s->len = strlen(text);
+    s->text = malloc(s->len + 1);
+    s->lower = malloc(s->len + 1);
+    if (!s->text || !s->lower) {
+        free(s->text);
+        free(s->lower);
+        s->text = s->lower = NULL;
+        free_ids[free_count++] = id;
+        return 0;
+    }
+    memcpy(s->text, text, s->len + 1);
+    for (size_t i = 0; i <= s->len; i++) {
+        s->lower[i] = (char)tolower((unsigned char)text[i]);
+    }
+    s->hash = hash;
+    s->refs = 1;
+    s->matched = 0;
+
+    slots[slot] = id;
+    index_string(id, true);
+    return id;
+}
+
+static void release(int id) {
+    if (id <= 0 || id > SEARCH_MAX_STRINGS || strings[id].refs <= 0) return;
+    if (--strings[id].refs > 0) return;
+
+    index_string(id, false);
+
+    unsigned int slot = home_slot(strings[id].hash);
+    while (slots[slot] != id) {
+        slot = (slot + 1) & (SEARCH_POOL_SLOTS - 1);
+    }
+    hash_slots_delete(slots, SEARCH_POOL_SLOTS, slot, string_hash);
+
+    free(strings[id].text);
+    free(strings[id].lower);
+    strings[id].text = strings[id].lower = NULL;
+    free_ids[free_count++] = id;
+}
+
+static void release_entry(ProcEntry *entry) {
+    release(entry->search_id);
+    entry->search_id = 0;
+}
+
+void search_init(void) {
+    proc_table_set_evict_hook(release_entry);
+}
+
+void search_shutdown(void) {
+    proc_table_set_evict_hook(NULL);
+
+    for (int id = 1; id < next_id; id++) {
+        free(strings[id].text);
+        free(strings[id].lower);
+    }
+    for (int i = 0; i < TRIGRAM_BUCKETS; i++) {
+        free(postings[i].ids);
+    }
+    memset(strings, 0, sizeof(strings));
+    memset(slots, 0, sizeof(slots));
+    memset(postings, 0, sizeof(postings));
+    free_count = 0;
+    next_id = 1;
+
+    if (regex_ready) {
+        regfree(&query_regex);
+        regex_ready = false;
+    }
+}
+
+// True if 'text' is exactly name + '\n' + cmdline
+static bool same_text(const char *text, const char *name, const char *cmdline) {
+    size_t name_len = strlen(name);
+    return strncmp(text, name, name_len) == 0 && text[name_len] == '\n' &&
+           strcmp(text + name_len + 1, cmdline) == 0;
+}
+
+void search_index_update(const ProcessInfo processes[], int count) {
+    if (!processes) return;
+
+    for (int i = 0; i < count; i++) {
+        const ProcessInfo *p = &processes[i];
+        if (p->is_thread) continue;
+
+        ProcEntry *entry = proc_table_lookup(p->pid);
+        if (!entry || entry->start_ticks != p->start_ticks) continue;
+
+        int id = entry->search_id;
+        if (id > 0 && same_text(strings[id].text, p->name, p->cmdline)) continue;
+
+        // New process, or its command line changed (exec)
+        char text[MAX_NAME_LEN + MAX_CMDLINE_LEN + 2];
+        snprintf(text, sizeof(text), "%s\n%s", p->name, p->cmdline);
+        release(id);
+        entry->search_id = intern(text);
+    }
+}
+
+int search_set_query(const char *query, SearchMode mode) {
+    snprintf(query_text, sizeof(query_text), "%s", query ? query : "");
+    query_len = strlen(query_text);
+    for (size_t i = 0; i <= query_len; i++) {
+        query_lower[i] = (char)tolower((unsigned char)query_text[i]);
+    }
+    query_mode = mode;
+
+    if (regex_ready) {
+        regfree(&query_regex);
+        regex_ready = false;
+    }
+    regex_invalid = false;
+
+    if (mode == SEARCH_REGEX && query_len > 0) {
+        // REG_NEWLINE: ^ and $ also match at the name/cmdline boundary
+        if (regcomp(&query_regex, query_text,
+                    REG_EXTENDED | REG_ICASE | REG_NOSUB | REG_NEWLINE) != 0) {
+            regex_invalid = true;
+            return -1;
+        }
+        regex_ready = true;
+    }
+    return 0;
+}
+
+static bool string_matches(const SearchString *s) {
+    switch (query_mode) {
+        case SEARCH_REGEX:      return regexec(&query_regex, s->text, 0, NULL, 0) == 0;
+        case SEARCH_MATCH_CASE: return strstr(s->text, query_text) != NULL;
+        default:                return strstr(s->lower, query_lower) != NULL;
+    }
+}
+
+// Marks every string matching the query with a new stamp
+static void run_query(void) {
+    if (++query_stamp == 0) query_stamp = 1;
+
+    if (query_mode != SEARCH_REGEX && query_len >= 3) {
+        // Candidates: the shortest posting list among the query's trigrams
+        const Posting *best = NULL;
+        for (size_t i = 0; i + 3 <= query_len; i++) {
+            const Posting *list = &postings[trigram_bucket(query_lower + i)];
+            if (!best || list->count < best->count) best = list;
+        }
+        for (int i = 0; i < best->count; i++) {
+            SearchString *s = &strings[best->ids[i]];
+            if (string_matches(s)) s->matched = query_stamp;
+        }
+        return;
+    }
+
+    // Short queries and regexes: test each distinct string once
+    for (int id = 1; id < next_id; id++) {
+        SearchString *s = &strings[id];
+        if (s->refs > 0 && string_matches(s)) s->matched = query_stamp;
+    }
+}
+
+int search_apply(const ProcessInfo processes[], int count, ProcessInfo matched[]) {
+    if (!processes || !matched || count <= 0) return 0;
+
+    if (query_len == 0) {
+        if (matched != processes) memcpy(matched, processes, count * sizeof(ProcessInfo));
+        return count;
+    }
+    if (regex_invalid) return 0;
+
+    run_query();
+
+    int matched_count = 0;
+    for (int i = 0; i < count; i++) {
+        const ProcEntry *entry = proc_table_lookup(processes[i].pid);
+        int id = entry ? entry->search_id : 0;
+        if (id > 0 && strings[id].matched == query_stamp) {
+            if (&matched[matched_count] != &processes[i]) {
+                matched[matched_count] = processes[i];
+            }
+            matched_count++;
+        }
+    }
+    return matched_count;
+}
+
+const char* search_mode_name(SearchMode mode) {
+    switch (mode) {
+        case SEARCH_MATCH_CASE: return "match case";
+        case SEARCH_REGEX:      return "regex";
+        default:                return "ignore case";
+    }
+}
@@ -0,0 +1,111 @@
+#define _POSIX_C_SOURCE 200809L
+#include <errno.h>
+#include <sys/file.h>
+#include "shm_snapshot.h"
+#include "alttasker_shm.h"
+
+static AtsShmRegion *region = NULL;
+static int region_fd = -1;
+static char region_name[64];
+
+int shm_snapshot_open(void) {
+    if (region) return 0;
+
+    ats_shm_name(region_name, sizeof(region_name), (unsigned int)getuid());
+    int fd = shm_open(region_name, O_RDWR | O_CREAT | O_CLOEXEC, 0600);
+    if (fd < 0) return -1;
+
+    // The lock lives as long as the descriptor: one publisher per user
+    if (flock(fd, LOCK_EX | LOCK_NB) != 0 || ftruncate(fd, sizeof(AtsShmRegion)) != 0) {
+        close(fd);
+        return -1;
+    }
+
+    void *map = mmap(NULL, sizeof(AtsShmRegion), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (map == MAP_FAILED) {
+        close(fd);
+        return -1;
+    }
+
+    region = (AtsShmRegion *)map;
+    region_fd = fd;
+
+    // Keep the sequence of a previous publisher so attached readers notice the change
+    uint64_t seq = atomic_load_explicit(&region->header.sequence, memory_order_relaxed);
+    atomic_store_explicit(&region->header.sequence, (seq | 1u) + 1u, memory_order_release);
+    region->header.magic = ATS_SHM_MAGIC;
+    region->header.version = ATS_SHM_VERSION;
+    region->header.region_size = sizeof(AtsShmRegion);
+    region->header.count = 0;
+    region->pool[0] = '\0';
+    return 0;
+}
+
+// Appends a string to the pool; returns its offset (0, the empty string, if full)
+static uint32_t pool_add(const char *text, uint32_t *used) {
+    size_t len = strlen(text);
+    if (len == 0 || *used + len + 1 > ATS_SHM_POOL_SIZE) return 0;
+
+    uint32_t offset = *used;
+    memcpy(region->pool + offset, text, len + 1);
+    *used += (uint32_t)(len + 1);
+    return offset;
+}
+
+void shm_snapshot_publish(const ProcessInfo processes[], int count, const sysinfo_t *sysinfo) {
+    if (!region || !processes || !sysinfo) return;
+    if (count > (int)ATS_SHM_MAX_ROWS) count = ATS_SHM_MAX_ROWS;
+
+    // Seqlock write: odd while the columns are inconsistent
+    uint64_t seq = atomic_load_explicit(&region->header.sequence, memory_order_relaxed);
+    atomic_store_explicit(&region->header.sequence, seq + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+
+    struct timespec now;
+    clock_gettime(CLOCK_REALTIME, &now);
+    AtsShmHeader *h = &region->header;
+    h->timestamp_ns = (int64_t)now.tv_sec * 1000000000 + now.tv_nsec;
+    h->total_mem = sysinfo->total_mem;
+    h->used_mem = sysinfo->used_mem;
+    h->available_mem = sysinfo->available_mem;
+    h->cached_mem = sysinfo->cached_mem;
+    h->swap_total = sysinfo->swap_total;
+    h->swap_used = sysinfo->swap_used;
+    h->uptime = sysinfo->uptime;
+    h->mem_usage_percent = sysinfo->mem_usage_percent;
+    h->cpu_usage_percent = sysinfo->cpu_usage_percent;
+    h->total_processes = sysinfo->total_processes;
+
+    uint32_t used = 1;  // pool[0] stays the empty string
+    for (int i = 0; i < count; i++) {
+        const ProcessInfo *p = &processes[i];
+        region->pid[i] = p->pid;
+        region->ppid[i] = p->ppid;
+        region->uid[i] = p->uid;
+        region->cpu_usage[i] = p->cpu_usage;
+        region->mem_usage[i] = p->mem_usage;
+        region->read_rate[i] = p->read_rate;
+        region->write_rate[i] = p->write_rate;
+        region->rss[i] = p->rss;
+        region->vsize[i] = p->vsize;
+        region->start_ticks[i] = p->start_ticks;
+        region->state[i] = p->state;
+        region->name[i] = pool_add(p->name, &used);
+        region->user[i] = pool_add(p->user, &used);
+        region->cmdline[i] = pool_add(p->cmdline, &used);
+    }
+    h->count = (uint32_t)count;
+    h->pool_used = used;
+
+    atomic_store_explicit(&region->header.sequence, seq + 2, memory_order_release);
+}
+
+void shm_snapshot_close(void) {
+    if (!region) return;
+
+    munmap(region, sizeof(AtsShmRegion));
+    shm_unlink(region_name);  // Attached readers keep their mapping
+    close(region_fd);
+    region = NULL;
+    region_fd = -1;
+}
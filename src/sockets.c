@@ -0,0 +1,228 @@
+#define _POSIX_C_SOURCE 200809L
+#include <fcntl.h>
+#include "sockets.h"
+#include "process_monitor.h"
+#include "proc_table.h"
+
+// Connection kinds stored in the index
+#define KIND_TCP 0x100
+#define KIND_UDP 0x200
+#define TCP_ESTABLISHED 0x01
+#define TCP_LISTEN 0x0A
+
+// inode -> kind | TCP state, open addressing (inode 0 marks an empty slot)
+static unsigned long *conn_inodes = NULL;
+static int *conn_kinds = NULL;
+static size_t conn_capacity = 0;
+static size_t conn_count = 0;
+
+// The one fd table being counted across calls
+static struct {
+    pid_t pid;                      // 0 = none in progress
+    unsigned long long start_ticks;
+    DIR *dir;
+    int sockets;
+    int tcp_sockets;
+    int tcp_established;
+    int tcp_listen;
+} fd_scan;
+
+static size_t slot_for(unsigned long inode, size_t capacity) {
+    return (size_t)(inode * 2654435761u) & (capacity - 1);
+}
+
+static bool index_insert(unsigned long inode, int kind);
+
+// Doubles the index, keeping the load factor at or below one half
+static bool index_grow(void) {
+    size_t old_capacity = conn_capacity;
+    unsigned long *old_inodes = conn_inodes;
+    int *old_kinds = conn_kinds;
+
+    size_t capacity = old_capacity ? old_capacity * 2 : 4096;
+    unsigned long *inodes = calloc(capacity, sizeof(unsigned long));
+    int *kinds = malloc(capacity * sizeof(int));
+    if (!inodes || !kinds) {
+        free(inodes);
+        free(kinds);
+        return false;
+    }
+    conn_inodes = inodes;
+    conn_kinds = kinds;
+    conn_capacity = capacity;
+    conn_count = 0;
+    for (size_t i = 0; i < old_capacity; i++) {
+        if (old_inodes[i] != 0) index_insert(old_inodes[i], old_kinds[i]);
+    }
+    free(old_inodes);
+    free(old_kinds);
+    return true;
+}
+
+static bool index_insert(unsigned long inode, int kind) {
+    if ((conn_count + 1) * 2 > conn_capacity && !index_grow()) return false;
+    size_t slot = slot_for(inode, conn_capacity);
+    while (conn_inodes[slot] != 0 && conn_inodes[slot] != inode) {
+        slot = (slot + 1) & (conn_capacity - 1);
+    }
+    if (conn_inodes[slot] == 0) conn_count++;
+    conn_inodes[slot] = inode;
+    conn_kinds[slot] = kind;
+    return true;
+}
+
+// Kind of the connection with this inode, 0 if not indexed (e.g. unix sockets)
+static int index_lookup(unsigned long inode) {
+    if (conn_capacity == 0) return 0;
+    size_t slot = slot_for(inode, conn_capacity);
+    while (conn_inodes[slot] != 0) {
+        if (conn_inodes[slot] == inode) return conn_kinds[slot];
+        slot = (slot + 1) & (conn_capacity - 1);
+    }
+    return 0;
+}
+
+// Adds the rows of one /proc/net table; returns the number added or -1
+static int parse_table(const char *path, int kind) {
+    FILE *fp = fopen(path, "r");
+    if (!fp) return -1;
+
+    char line[512];
+    int added = 0;
+    if (!fgets(line, sizeof(line), fp)) {  // Column header
+        fclose(fp);
+        return 0;
+    }
+    while (fgets(line, sizeof(line), fp)) {
+        // sl local rem st tx:rx tr:when retrnsmt uid timeout inode
+        unsigned int state;
+        unsigned long inode;
+        if (sscanf(line, "%*s %*s %*s %x %*s %*s %*s %*s %*s %lu", &state, &inode) != 2) continue;
+        if (inode == 0) continue;  // TIME_WAIT and friends belong to no process
+        if (index_insert(inode, kind | (int)state)) added++;
+    }
+    fclose(fp);
+    return added;
+}
+
+int sockets_refresh(void) {
+    if (conn_capacity > 0) {
+        memset(conn_inodes, 0, conn_capacity * sizeof(unsigned long));
+        conn_count = 0;
+    }
+
+    int total = 0;
+    int tables = 0;
+    static const struct { const char *path; int kind; } sources[] = {
+        { "/proc/net/tcp", KIND_TCP }, { "/proc/net/tcp6", KIND_TCP },
+        { "/proc/net/udp", KIND_UDP }, { "/proc/net/udp6", KIND_UDP },
+    };
+    for (size_t i = 0; i < sizeof(sources) / sizeof(sources[0]); i++) {
+        int added = parse_table(sources[i].path, sources[i].kind);
+        if (added >= 0) {
+            total += added;
+            tables++;
+        }
+    }
+    return tables > 0 ? total : -1;  // tcp6/udp6 are missing without IPv6
+}
+
+static void end_fd_scan(void) {
+    if (fd_scan.dir) closedir(fd_scan.dir);
+    memset(&fd_scan, 0, sizeof(fd_scan));
+}
+
+// Counts up to *budget more fd links; returns true once the table is done
+static bool continue_fd_scan(int *budget) {
+    struct dirent *entry = NULL;
+    while (*budget > 0 && (entry = readdir(fd_scan.dir)) != NULL) {
+        if (entry->d_name[0] == '.') continue;
+        (*budget)--;
+
+        char link[64];
+        ssize_t len = readlinkat(dirfd(fd_scan.dir), entry->d_name, link, sizeof(link) - 1);
+        if (len < 8) continue;
+        link[len] = '\0';
+        if (strncmp(link, "socket:[", 8) != 0) continue;
+
+        fd_scan.sockets++;
+        int kind = index_lookup(strtoul(link + 8, NULL, 10));
+        if (kind & KIND_TCP) {
+            fd_scan.tcp_sockets++;
+            if ((kind & 0xFF) == TCP_ESTABLISHED) fd_scan.tcp_established++;
+            if ((kind & 0xFF) == TCP_LISTEN) fd_scan.tcp_listen++;
+        }
+    }
+    return *budget > 0 || entry == NULL;
+}
+
+static void copy_counts(ProcessInfo *pinfo, const ProcEntry *entry) {
+    pinfo->has_sockets = entry->has_sockets;
+    pinfo->sockets = entry->sockets;
+    pinfo->tcp_sockets = entry->tcp_sockets;
+    pinfo->tcp_established = entry->tcp_established;
+    pinfo->tcp_listen = entry->tcp_listen;
+}
+
+void update_sockets(ProcessInfo rows[], int count) {
+    if (!rows) return;
+
+    // A scan in progress is dropped once its process scrolled out of 'rows'
+    if (fd_scan.pid > 0) {
+        bool present = false;
+        for (int i = 0; i < count && !present; i++) {
+            present = rows[i].pid == fd_scan.pid && rows[i].start_ticks == fd_scan.start_ticks &&
+                      !rows[i].is_thread;
+        }
+        if (!present) end_fd_scan();
+    }
+
+    double now = monotonic_seconds();
+    int budget = SOCKETS_FD_BUDGET;
+    for (int i = 0; i < count; i++) {
+        ProcessInfo *pinfo = &rows[i];
+        pinfo->has_sockets = false;
+        if (pinfo->is_thread) continue;
+
+        ProcEntry *entry = proc_table_lookup(pinfo->pid);
+        if (!entry || entry->start_ticks != pinfo->start_ticks) continue;
+
+        bool stale = entry->sockets_time == 0.0 || now - entry->sockets_time >= SOCKETS_REFRESH_SECONDS;
+        bool mine = fd_scan.pid == pinfo->pid && fd_scan.start_ticks == pinfo->start_ticks;
+        if (stale && budget > 0 && (fd_scan.pid == 0 || mine)) {
+            if (!mine) {
+                char path[64];
+                snprintf(path, sizeof(path), "/proc/%d/fd", pinfo->pid);
+                fd_scan.dir = opendir(path);
+                if (!fd_scan.dir) {
+                    // No access (or gone): not retried before the next period
+                    entry->has_sockets = false;
+                    entry->sockets_time = now;
+                    continue;
+                }
+                fd_scan.pid = pinfo->pid;
+                fd_scan.start_ticks = pinfo->start_ticks;
+            }
+            if (continue_fd_scan(&budget)) {
+                entry->has_sockets = true;
+                entry->sockets_time = now;
+                entry->sockets = fd_scan.sockets;
+                entry->tcp_sockets = fd_scan.tcp_sockets;
+                entry->tcp_established = fd_scan.tcp_established;
+                entry->tcp_listen = fd_scan.tcp_listen;
+                end_fd_scan();
+            }
+        }
+        copy_counts(pinfo, entry);
+    }
+}
+
+void sockets_close(void) {
+    end_fd_scan();
+    free(conn_inodes);
+    free(conn_kinds);
+    conn_inodes = NULL;
+    conn_kinds = NULL;
+    conn_capacity = 0;
+    conn_count = 0;
+}
@@ -0,0 +1,195 @@
+#define _DEFAULT_SOURCE
+#include <errno.h>
+#include <sys/socket.h>
+#include <linux/netlink.h>
+#include <linux/genetlink.h>
+#include <linux/taskstats.h>
+#include "data_source.h"
+#include "process_monitor.h"
+
+// Large enough for a TASKSTATS_CMD_GET reply (struct taskstats + headers)
+#define TASKSTATS_BUFFER_SIZE 1024
+
+static int ts_fd = -1;
+static __u16 family_id = 0;
+static __u32 sequence = 0;
+
+// Generic netlink request: header + one u32 or string attribute
+typedef struct {
+    struct nlmsghdr nlh;
+    struct genlmsghdr genl;
+    char attrs[64];
+} GenlRequest;
+
+static int send_request(__u16 type, __u8 cmd, __u16 attr_type,
+                        const void *data, size_t data_len) {
+    GenlRequest req;
+    memset(&req, 0, sizeof(req));
+
+    struct nlattr *attr = (struct nlattr *)req.attrs;
+    attr->nla_type = attr_type;
+    attr->nla_len = NLA_HDRLEN + data_len;
+    memcpy((char *)attr + NLA_HDRLEN, data, data_len);
+
+    req.nlh.nlmsg_len = NLMSG_LENGTH(GENL_HDRLEN) + NLA_ALIGN(attr->nla_len);
+    req.nlh.nlmsg_type = type;
+    req.nlh.nlmsg_flags = NLM_F_REQUEST;
+    req.nlh.nlmsg_seq = ++sequence;
+    req.genl.cmd = cmd;
+    req.genl.version = TASKSTATS_GENL_VERSION;
+
+    struct sockaddr_nl kernel;
+    memset(&kernel, 0, sizeof(kernel));
+    kernel.nl_family = AF_NETLINK;
+
+    ssize_t sent;
+    do {
+        sent = sendto(ts_fd, &req, req.nlh.nlmsg_len, 0,
+                      (struct sockaddr *)&kernel, sizeof(kernel));
+    } while (sent < 0 && errno == EINTR);
+
+    return sent < 0 ? -1 : 0;
+}
+
+// Receives one reply; returns the generic netlink payload length or -1
+static int receive_reply(char *buffer, size_t size, struct nlattr **attrs) {
+    ssize_t len;
+    struct nlmsghdr *nlh = (struct nlmsghdr *)buffer;
+
+    // Skip late replies to earlier requests
+    for (;;) {
+        len = recv(ts_fd, buffer, size, 0);
+        if (len < 0 && errno == EINTR) continue;
+        if (len < 0 || !NLMSG_OK(nlh, (size_t)len)) return -1;
+        if (nlh->nlmsg_seq == sequence) break;
+    }
+
+    if (nlh->nlmsg_type == NLMSG_ERROR) {
+        return -1;  // Includes EPERM replies when unprivileged
+    }
+
+    *attrs = (struct nlattr *)((char *)NLMSG_DATA(nlh) + GENL_HDRLEN);
+    return (int)(nlh->nlmsg_len - NLMSG_LENGTH(GENL_HDRLEN));
+}
+
+// Finds attribute 'type' in a flat attribute list
+static struct nlattr* find_attr(struct nlattr *attr, int len, int type) {
+    while (len >= NLA_HDRLEN && attr->nla_len >= NLA_HDRLEN && attr->nla_len <= len) {
+        if ((attr->nla_type & NLA_TYPE_MASK) == type) return attr;
+        int step = NLA_ALIGN(attr->nla_len);
+        len -= step;
+        attr = (struct nlattr *)((char *)attr + step);
+    }
+    return NULL;
+}
+
+static int resolve_family(void) {
+    char buffer[TASKSTATS_BUFFER_SIZE];
+    struct nlattr *attrs;
+
+    if (send_request(GENL_ID_CTRL, CTRL_CMD_GETFAMILY, CTRL_ATTR_FAMILY_NAME,
+                     TASKSTATS_GENL_NAME, sizeof(TASKSTATS_GENL_NAME)) < 0) {
+        return -1;
+    }
+
+    int len = receive_reply(buffer, sizeof(buffer), &attrs);
+    if (len < 0) return -1;
+
+    struct nlattr *id = find_attr(attrs, len, CTRL_ATTR_FAMILY_ID);
+    if (!id) return -1;
+
+    memcpy(&family_id, (char *)id + NLA_HDRLEN, sizeof(family_id));
+    return 0;
+}
+
+// Fetches the thread-group aggregated taskstats of a process
+static int query_tgid(pid_t tgid, struct taskstats *stats) {
+    char buffer[TASKSTATS_BUFFER_SIZE];
+    struct nlattr *attrs;
+    __u32 id = (__u32)tgid;
+
+    if (send_request(family_id, TASKSTATS_CMD_GET, TASKSTATS_CMD_ATTR_TGID,
+                     &id, sizeof(id)) < 0) {
+        return -1;
+    }
+
+    int len = receive_reply(buffer, sizeof(buffer), &attrs);
+    if (len < 0) return -1;
+
+    struct nlattr *aggr = find_attr(attrs, len, TASKSTATS_TYPE_AGGR_TGID);
+    if (!aggr) return -1;
+
+    struct nlattr *data = find_attr((struct nlattr *)((char *)aggr + NLA_HDRLEN),
+                                    aggr->nla_len - NLA_HDRLEN, TASKSTATS_TYPE_STATS);
+    if (!data) return -1;
+
+    // The kernel's struct may be older (shorter) or newer (longer) than ours
+    size_t payload = data->nla_len - NLA_HDRLEN;
+    memset(stats, 0, sizeof(*stats));
+    memcpy(stats, (char *)data + NLA_HDRLEN,
+           payload < sizeof(*stats) ? payload : sizeof(*stats));
+    return 0;
+}
+
+static void taskstats_close(void) {
+    if (ts_fd >= 0) {
+        close(ts_fd);
+        ts_fd = -1;
+    }
+    family_id = 0;
+}
+
+static int taskstats_open(void) {
+    if (ts_fd >= 0) return 0;
+
+    ts_fd = socket(AF_NETLINK, SOCK_RAW | SOCK_CLOEXEC, NETLINK_GENERIC);
+    if (ts_fd < 0) return -1;
+
+    struct sockaddr_nl addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.nl_family = AF_NETLINK;
+
+    // Probe with our own PID: unprivileged callers get EPERM here
+    struct taskstats probe;
+    if (bind(ts_fd, (struct sockaddr *)&addr, sizeof(addr)) < 0 ||
+        resolve_family() < 0 ||
+        query_tgid(getpid(), &probe) < 0) {
+        taskstats_close();
+        return -1;
+    }
+
+    return 0;
+}
+
+static int taskstats_read(pid_t pid, ProcessInfo *pinfo, unsigned long total_mem,
+                          unsigned int flags) {
+    struct taskstats stats;
+
+    if (query_tgid(pid, &stats) < 0) {
+        // Per-process failure (e.g. exited): use the text reader for this one
+        return get_process_info(pid, pinfo, total_mem, flags);
+    }
+
+    // A TGID reply only sums delays and context switches; the rest is read as procfs does
+    if (get_process_info(pid, pinfo, total_mem, flags & ~SCAN_READ_SCHED) != 0) {
+        return -1;
+    }
+
+    pinfo->cpu_delay_ns = stats.cpu_delay_total;
+    pinfo->blkio_delay_ns = stats.blkio_delay_total;
+    if (flags & SCAN_READ_SCHED) {
+        pinfo->sched_wait_ns = stats.cpu_delay_total;
+        pinfo->nvcsw = stats.nvcsw;
+        pinfo->nivcsw = stats.nivcsw;
+        pinfo->has_sched = true;
+    }
+
+    return 0;
+}
+
+const DataSource taskstats_source = {
+    .name = "taskstats",
+    .open = taskstats_open,
+    .read = taskstats_read,
+    .close = taskstats_close,
+};
@@ -0,0 +1,145 @@
+#define _POSIX_C_SOURCE 200809L
+#include "threads.h"
+#include "process_monitor.h"
+
+// Previous CPU sample of one thread
+typedef struct {
+    pid_t tid;
+    unsigned long long start_ticks;
+    unsigned long cpu_ticks;
+} ThreadSample;
+
+// Samples of the last call, sorted by TID for binary search
+static ThreadSample prev_samples[MAX_THREADS];
+static int prev_count = 0;
+static pid_t prev_pid = 0;
+static double prev_time = 0.0;
+
+static int compare_samples(const void *a, const void *b) {
+    const ThreadSample *sa = (const ThreadSample *)a;
+    const ThreadSample *sb = (const ThreadSample *)b;
+    return (sa->tid > sb->tid) - (sa->tid < sb->tid);
+}
+
+// Parses /proc/[pid]/task/[tid]/stat
+static int read_thread_stat(pid_t pid, pid_t tid, ProcessInfo *thread) {
+    char path[BUFFER_SIZE];
+    snprintf(path, sizeof(path), "/proc/%d/task/%d/stat", pid, tid);
+
+    FILE *fp = fopen(path, "r");
+    if (!fp) return -1;
+
+    unsigned long long starttime;
+    int fields = fscanf(fp, "%*d (%255[^)]) %c %*d %*d %*d %*d %*d %*u %*u %*u %*u %*u %lu %lu %*d %*d %*d %*d %*d %*d %llu",
+                        thread->name, &thread->state, &thread->utime, &thread->stime, &starttime);
+    fclose(fp);
+    if (fields < 5) return -1;
+
+    thread->start_ticks = starttime;
+    thread->starttime = starttime / sysconf(_SC_CLK_TCK);
+    return 0;
+}
+
+int scan_threads(pid_t pid, const ProcessInfo *parent, ProcessInfo threads[], int max_threads) {
+    if (!threads || max_threads <= 0) return -1;
+    if (max_threads > MAX_THREADS) max_threads = MAX_THREADS;
+
+    char path[BUFFER_SIZE];
+    snprintf(path, sizeof(path), "/proc/%d/task", pid);
+
+    DIR *task_dir = opendir(path);
+    if (!task_dir) return -1;
+
+    double now = monotonic_seconds();
+    double elapsed = (pid == prev_pid) ? now - prev_time : 0.0;
+    long ticks_per_sec = sysconf(_SC_CLK_TCK);
+
+    // Process uptime is the fallback denominator for the first sample
+    float uptime = 0.0f;
+    FILE *uptime_fp = fopen("/proc/uptime", "r");
+    if (uptime_fp) {
+        if (fscanf(uptime_fp, "%f", &uptime) != 1) uptime = 0.0f;
+        fclose(uptime_fp);
+    }
+
+    ThreadSample samples[MAX_THREADS];
+    int count = 0;
+    struct dirent *entry;
+
+    while ((entry = readdir(task_dir)) != NULL && count < max_threads) {
+        if (!is_pid(entry->d_name)) continue;
+
+        pid_t tid = (pid_t)atoi(entry->d_name);
+        ProcessInfo *thread = &threads[count];
+        memset(thread, 0, sizeof(ProcessInfo));
+
+        if (read_thread_stat(pid, tid, thread) != 0) continue;  // Thread exited
+
+        thread->pid = tid;
+        thread->ppid = pid;
+        thread->is_thread = true;
+        if (parent) {
+            thread->uid = parent->uid;
+            memcpy(thread->user, parent->user, MAX_NAME_LEN);
+            thread->vsize = parent->vsize;
+            thread->rss = parent->rss;
+            thread->mem_usage = parent->mem_usage;
+            thread->tree_depth = parent->tree_depth + 1;
+        } else {
+            thread->tree_depth = 1;
+        }
+        // Threads share the command line; show the thread name instead
+        snprintf(thread->cmdline, MAX_CMDLINE_LEN, "{%s}", thread->name);
+
+        unsigned long cpu_ticks = thread->utime + thread->stime;
+        ThreadSample key = { .tid = tid };
+        const ThreadSample *prev = (elapsed > 0.0)
+            ? bsearch(&key, prev_samples, prev_count, sizeof(ThreadSample), compare_samples)
+            : NULL;
+
+        if (prev && prev->start_ticks == thread->start_ticks && cpu_ticks >= prev->cpu_ticks) {
+            // Delta since the previous refresh
+            thread->cpu_usage = (float)((cpu_ticks - prev->cpu_ticks) / (double)ticks_per_sec /
+                                        elapsed * 100.0);
+        } else if (uptime > thread->starttime) {
+            // New thread: lifetime average until the next sample
+            thread->cpu_usage = (float)cpu_ticks / ticks_per_sec / (uptime - thread->starttime) * 100.0f;
+        }
+        if (thread->cpu_usage > 999.9f) thread->cpu_usage = 999.9f;
+
+        samples[count].tid = tid;
+        samples[count].start_ticks = thread->start_ticks;
+        samples[count].cpu_ticks = cpu_ticks;
+        count++;
+    }
+    closedir(task_dir);
+
+    // Keep this sample for the next delta
+    memcpy(prev_samples, samples, count * sizeof(ThreadSample));
+    prev_count = count;
+    qsort(prev_samples, prev_count, sizeof(ThreadSample), compare_samples);
+    prev_pid = pid;
+    prev_time = now;
+
+    return count;
+}
+
+int insert_thread_rows(const ProcessInfo rows[], int count,
+                       const ProcessInfo threads[], int thread_count,
+                       ProcessInfo out[], int max_out) {
+    if (!rows || !out || max_out <= 0) return 0;
+
+    int written = 0;
+    for (int i = 0; i < count && written < max_out; i++) {
+        out[written++] = rows[i];
+
+        if (thread_count > 0 && rows[i].pid == threads[0].ppid && !rows[i].is_thread) {
+            for (int t = 0; t < thread_count && written < max_out; t++) {
+                out[written] = threads[t];
+                out[written].tree_depth = rows[i].tree_depth + 1;
+                written++;
+            }
+        }
+    }
+    return written;
+}
@@ -0,0 +1,151 @@
+#include "tree.h"
+#include "proc_table.h"
+
+// A node is collapsed while its fold mark equals the current epoch, so
+// unfolding everything is a single increment
+static unsigned int fold_epoch = 1;
+
+// Scratch state of one build, indexed by input row
+static int pid_slots[TREE_TABLE_SIZE];
+static int parent_of[MAX_PROCESS];
+static int first_child[MAX_PROCESS];
+static int next_sibling[MAX_PROCESS];
+static int preorder[MAX_PROCESS];
+static int stack[MAX_PROCESS];
+static int depth_of[MAX_PROCESS];
+static int subtree_size[MAX_PROCESS];
+static float subtree_cpu[MAX_PROCESS];
+static float subtree_mem[MAX_PROCESS];
+static unsigned long subtree_rss[MAX_PROCESS];
+
+static unsigned int hash_pid(pid_t pid) {
+    return (unsigned int)pid * 2654435761u;
+}
+
+// Index of 'pid' in 'rows' via the PID -> row table (-1 if absent)
+static int find_row(const ProcessInfo rows[], pid_t pid) {
+    unsigned int slot = hash_pid(pid) & (TREE_TABLE_SIZE - 1);
+    while (pid_slots[slot] >= 0) {
+        if (rows[pid_slots[slot]].pid == pid) return pid_slots[slot];
+        slot = (slot + 1) & (TREE_TABLE_SIZE - 1);
+    }
+    return -1;
+}
+
+// A parent must have started before its child; this also rejects a ppid
+// that was recycled by a younger process between two reads, so links never
+// form a cycle (ties are broken by PID)
+static bool is_older(const ProcessInfo *parent, const ProcessInfo *child) {
+    if (parent->start_ticks != child->start_ticks) return parent->start_ticks < child->start_ticks;
+    return parent->pid < child->pid;
+}
+
+static bool is_collapsed(const ProcessInfo *p) {
+    ProcEntry *entry = proc_table_lookup(p->pid);
+    return entry && entry->start_ticks == p->start_ticks && entry->tree_fold == fold_epoch;
+}
+
+int tree_build(const ProcessInfo rows[], int count, ProcessInfo out[], int max_out) {
+    if (!rows || !out || count <= 0 || max_out <= 0) return 0;
+    if (count > MAX_PROCESS) count = MAX_PROCESS;
+
+    for (int s = 0; s < TREE_TABLE_SIZE; s++) pid_slots[s] = -1;
+    for (int i = 0; i < count; i++) {
+        unsigned int slot = hash_pid(rows[i].pid) & (TREE_TABLE_SIZE - 1);
+        while (pid_slots[slot] >= 0) slot = (slot + 1) & (TREE_TABLE_SIZE - 1);
+        pid_slots[slot] = i;
+    }
+
+    for (int i = 0; i < count; i++) {
+        int parent = -1;
+        if (rows[i].ppid > 0 && rows[i].ppid != rows[i].pid) {
+            parent = find_row(rows, rows[i].ppid);
+            if (parent >= 0 && !is_older(&rows[parent], &rows[i])) parent = -1;
+        }
+        parent_of[i] = parent;
+        first_child[i] = -1;
+    }
+
+    // Link children in reverse so every sibling list keeps the row order
+    int first_root = -1;
+    for (int i = count - 1; i >= 0; i--) {
+        int *head = (parent_of[i] >= 0) ? &first_child[parent_of[i]] : &first_root;
+        next_sibling[i] = *head;
+        *head = i;
+    }
+
+    // Pre-order walk; stack[top] is the parent of the level being listed
+    int visited = 0;
+    for (int root = first_root; root >= 0; root = next_sibling[root]) {
+        int top = 0;
+        stack[0] = root;
+        depth_of[root] = 0;
+        preorder[visited++] = root;
+        int node = first_child[root];
+        for (;;) {
+            if (node >= 0) {
+                depth_of[node] = top + 1;
+                preorder[visited++] = node;
+                if (first_child[node] >= 0) {
+                    stack[++top] = node;
+                    node = first_child[node];
+                } else {
+                    node = next_sibling[node];
+                }
+            } else if (top > 0) {
+                node = next_sibling[stack[top--]];
+            } else {
+                break;
+            }
+        }
+    }
+
+    // Post-order totals: every node is finished before its parent in reverse pre-order
+    for (int i = 0; i < count; i++) {
+        subtree_size[i] = 1;
+        subtree_cpu[i] = rows[i].cpu_usage;
+        subtree_mem[i] = rows[i].mem_usage;
+        subtree_rss[i] = rows[i].rss;
+    }
+    for (int k = visited - 1; k > 0; k--) {
+        int node = preorder[k];
+        int parent = parent_of[node];
+        if (parent < 0) continue;
+        subtree_size[parent] += subtree_size[node];
+        subtree_cpu[parent] += subtree_cpu[node];
+        subtree_mem[parent] += subtree_mem[node];
+        subtree_rss[parent] += subtree_rss[node];
+    }
+
+    // Emit visible rows; a collapsed node skips its contiguous subtree
+    int written = 0;
+    for (int k = 0; k < visited && written < max_out; ) {
+        int node = preorder[k];
+        ProcessInfo *row = &out[written++];
+        *row = rows[node];
+        row->tree_depth = depth_of[node];
+        row->tree_folded = 0;
+        if (subtree_size[node] > 1 && is_collapsed(&rows[node])) {
+            row->tree_folded = subtree_size[node] - 1;
+            row->cpu_usage = subtree_cpu[node];
+            row->mem_usage = subtree_mem[node];
+            row->rss = subtree_rss[node];
+            k += subtree_size[node];
+        } else {
+            k++;
+        }
+    }
+    return written;
+}
+
+int tree_toggle(pid_t pid) {
+    ProcEntry *entry = proc_table_lookup(pid);
+    if (!entry) return -1;
+    entry->tree_fold = (entry->tree_fold == fold_epoch) ? 0 : fold_epoch;
+    return entry->tree_fold == fold_epoch;
+}
+
+void tree_expand_all(void) {
+    fold_epoch++;
+    if (fold_epoch == 0) fold_epoch = 1;  // 0 is the mark of an unfolded entry
+}
@@ -0,0 +1,372 @@
+#define _DEFAULT_SOURCE
+#include <errno.h>
+#include <fcntl.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <linux/io_uring.h>
+#include "data_source.h"
+#include "process_monitor.h"
+#include "proc_table.h"
+
+// PIDs read per round of submissions, and the ring size that holds the
+// opens of one round plus the closes of the previous one
+#define URING_BATCH 128
+#define URING_ENTRIES 2048
+#define URING_SLOT_SIZE 1024
+
+// user_data: slot * FILE_COUNT + file; closes are tagged and not waited for
+#define CLOSE_TAG (1ull << 62)
+
+enum { FILE_STAT, FILE_STATUS, FILE_CMDLINE, FILE_IO, FILE_SCHEDSTAT, FILE_COUNT };
+
+static const struct {
+    const char *name;
+    size_t size;                // Bytes read, same limits as the text reader
+} proc_files[FILE_COUNT] = {
+    { "stat", PROC_STAT_TEXT_SIZE },
+    { "status", PROC_STATUS_TEXT_SIZE },
+    { "cmdline", MAX_CMDLINE_LEN },
+    { "io", BUFFER_SIZE },
+    { "schedstat", PROC_SCHEDSTAT_TEXT_SIZE },
+};
+
+typedef struct {
+    int fd;
+    unsigned *sq_head, *sq_tail, *sq_mask, *sq_array;
+    unsigned *cq_head, *cq_tail, *cq_mask;
+    struct io_uring_sqe *sqes;
+    struct io_uring_cqe *cqes;
+    void *sq_map, *cq_map;
+    size_t sq_map_size, cq_map_size, sqes_size;
+    unsigned sq_entries;
+    unsigned local_tail;        // SQEs written; published to *sq_tail on submit
+    unsigned queued;            // Written but not yet submitted
+    int pending;                // Tagged SQEs (not closes) whose completion is not reaped
+} Ring;
+
+static Ring ring = { .fd = -1 };
+
+// Preallocated per-round state: paths, descriptors, results and file contents
+static char paths[URING_BATCH][FILE_COUNT][32];
+static int fds[URING_BATCH][FILE_COUNT];
+static int results[URING_BATCH][FILE_COUNT];
+static char buffers[URING_BATCH][FILE_COUNT][URING_SLOT_SIZE];
+// status is read in full for the latency columns (context switches are at its end)
+static char status_buffers[URING_BATCH][PROC_STATUS_FULL_SIZE];
+
+static char* file_buffer(int slot, int file, unsigned int flags) {
+    if (file == FILE_STATUS && (flags & SCAN_READ_SCHED)) return status_buffers[slot];
+    return buffers[slot][file];
+}
+
+static size_t file_size(int file, unsigned int flags) {
+    if (file == FILE_STATUS && (flags & SCAN_READ_SCHED)) return PROC_STATUS_FULL_SIZE;
+    return proc_files[file].size;
+}
+
+static void uring_close(void) {
+    if (ring.sqes) munmap(ring.sqes, ring.sqes_size);
+    if (ring.cq_map && ring.cq_map != ring.sq_map) munmap(ring.cq_map, ring.cq_map_size);
+    if (ring.sq_map) munmap(ring.sq_map, ring.sq_map_size);
+    if (ring.fd >= 0) close(ring.fd);
+    memset(&ring, 0, sizeof(ring));
+    ring.fd = -1;
+}
+
+// True if the kernel implements every opcode the reader submits
+static bool ops_supported(int fd) {
+    size_t size = sizeof(struct io_uring_probe) + 256 * sizeof(struct io_uring_probe_op);
+    struct io_uring_probe *probe = calloc(1, size);
+    if (!probe) return false;
+
+    bool ok = syscall(__NR_io_uring_register, fd, IORING_REGISTER_PROBE, probe, 256) >= 0;
+    const int needed[] = { IORING_OP_OPENAT, IORING_OP_READ, IORING_OP_CLOSE };
+    for (size_t i = 0; ok && i < sizeof(needed) / sizeof(needed[0]); i++) {
+        ok = needed[i] <= probe->last_op && (probe->ops[needed[i]].flags & IO_URING_OP_SUPPORTED);
+    }
+    free(probe);
+    return ok;
+}
+
+static int uring_open(void) {
+    struct io_uring_params params;
+    memset(&params, 0, sizeof(params));
+
+    // Fails on kernels before 5.1, with io_uring_disabled or under seccomp
+    ring.fd = (int)syscall(__NR_io_uring_setup, URING_ENTRIES, &params);
+    if (ring.fd < 0 || !ops_supported(ring.fd)) {
+        uring_close();
+        return -1;
+    }
+
+    ring.sq_map_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    ring.cq_map_size = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+    bool single_map = params.features & IORING_FEAT_SINGLE_MMAP;
+    if (single_map && ring.cq_map_size > ring.sq_map_size) ring.sq_map_size = ring.cq_map_size;
+
+    ring.sq_map = mmap(NULL, ring.sq_map_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                       ring.fd, IORING_OFF_SQ_RING);
+    if (ring.sq_map == MAP_FAILED) {
+        ring.sq_map = NULL;
+        uring_close();
+        return -1;
+    }
+    ring.cq_map = single_map ? ring.sq_map
+                             : mmap(NULL, ring.cq_map_size, PROT_READ | PROT_WRITE,
+                                    MAP_SHARED | MAP_POPULATE, ring.fd, IORING_OFF_CQ_RING);
+    ring.sqes_size = params.sq_entries * sizeof(struct io_uring_sqe);
+    ring.sqes = mmap(NULL, ring.sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                     ring.fd, IORING_OFF_SQES);
+    if (ring.cq_map == MAP_FAILED || ring.sqes == MAP_FAILED) {
+        if (ring.cq_map == MAP_FAILED) ring.cq_map = NULL;
+        if (ring.sqes == MAP_FAILED) ring.sqes = NULL;
+        uring_close();
+        return -1;
+    }
+
+    char *sq = ring.sq_map;
+    char *cq = ring.cq_map;
+    ring.sq_head = (unsigned *)(sq + params.sq_off.head);
+    ring.sq_tail = (unsigned *)(sq + params.sq_off.tail);
+    ring.sq_mask = (unsigned *)(sq + params.sq_off.ring_mask);
+    ring.sq_array = (unsigned *)(sq + params.sq_off.array);
+    ring.cq_head = (unsigned *)(cq + params.cq_off.head);
+    ring.cq_tail = (unsigned *)(cq + params.cq_off.tail);
+    ring.cq_mask = (unsigned *)(cq + params.cq_off.ring_mask);
+    ring.cqes = (struct io_uring_cqe *)(cq + params.cq_off.cqes);
+    ring.sq_entries = params.sq_entries;
+    ring.local_tail = *ring.sq_tail;
+    return 0;
+}
+
+// Next free SQE, zeroed; NULL if the submission queue is full
+static struct io_uring_sqe* ring_sqe(unsigned long long user_data) {
+    unsigned head = atomic_load_explicit((_Atomic unsigned *)ring.sq_head, memory_order_acquire);
+    if (ring.local_tail - head >= ring.sq_entries) return NULL;
+
+    unsigned index = ring.local_tail & *ring.sq_mask;
+    struct io_uring_sqe *sqe = &ring.sqes[index];
+    memset(sqe, 0, sizeof(*sqe));
+    sqe->user_data = user_data;
+    ring.sq_array[index] = index;
+    ring.local_tail++;
+    ring.queued++;
+    if (!(user_data & CLOSE_TAG)) ring.pending++;
+    return sqe;
+}
+
+// Moves completions into results[][]; returns how many were not closes
+static int ring_reap(void) {
+    int reaped = 0;
+    unsigned head = *ring.cq_head;
+    unsigned tail = atomic_load_explicit((_Atomic unsigned *)ring.cq_tail, memory_order_acquire);
+    for (; head != tail; head++) {
+        const struct io_uring_cqe *cqe = &ring.cqes[head & *ring.cq_mask];
+        if (cqe->user_data & CLOSE_TAG) continue;
+        results[cqe->user_data / FILE_COUNT][cqe->user_data % FILE_COUNT] = cqe->res;
+        reaped++;
+        ring.pending--;
+    }
+    atomic_store_explicit((_Atomic unsigned *)ring.cq_head, head, memory_order_release);
+    return reaped;
+}
+
+// Submits everything queued and waits for 'wanted' tagged completions
+static int ring_run(int wanted) {
+    atomic_store_explicit((_Atomic unsigned *)ring.sq_tail, ring.local_tail, memory_order_release);
+    unsigned to_submit = ring.queued;
+    ring.queued = 0;
+
+    int reaped = ring_reap();
+    while (to_submit > 0 || reaped < wanted) {
+        unsigned wait = reaped < wanted ? (unsigned)(wanted - reaped) : 0;
+        int ret = (int)syscall(__NR_io_uring_enter, ring.fd, to_submit, wait,
+                               wait ? IORING_ENTER_GETEVENTS : 0, NULL, 0);
+        if (ret < 0) {
+            if (errno == EINTR) continue;
+            return -1;
+        }
+        if ((unsigned)ret > to_submit || (ret == 0 && to_submit > 0 && wait == 0)) return -1;
+        to_submit -= (unsigned)ret;
+        reaped += ring_reap();
+    }
+    return 0;
+}
+
+// After a failure: waits for the opens and reads still in flight, closes every
+// descriptor of the round and forgets its results; always returns -1
+static int abandon_round(int count) {
+    if (ring.pending > 0 && ring_run(ring.pending) != 0) {
+        // Completions could still land in results[] later: give up on the ring
+        uring_close();
+    }
+    for (int slot = 0; slot < count; slot++) {
+        for (int file = 0; file < FILE_COUNT; file++) {
+            // Reads overwrite results[] with lengths once fds[] holds the descriptor
+            if (fds[slot][file] >= 0) {
+                close(fds[slot][file]);
+            } else if (results[slot][file] >= 0) {
+                close(results[slot][file]);
+            }
+            fds[slot][file] = -1;
+            results[slot][file] = -ENOENT;
+        }
+    }
+    return -1;
+}
+
+// Reads up to URING_BATCH processes: all opens, then all reads, in two submissions
+static int read_round(const pid_t pids[], int count, ProcessInfo processes[],
+                      float system_uptime, unsigned long total_mem, unsigned int flags) {
+    // fds[] still holds the descriptors of the last round, closed since
+    for (int slot = 0; slot < count; slot++) {
+        for (int file = 0; file < FILE_COUNT; file++) {
+            fds[slot][file] = -1;
+            results[slot][file] = -ENOENT;
+        }
+    }
+
+    int wanted = 0;
+    for (int slot = 0; slot < count; slot++) {
+        // Cached status/cmdline are reused; a reused PID is caught by
+        // process_info_from_text(), which then reads the file itself
+        ProcEntry *entry = proc_table_lookup(pids[slot]);
+        bool cached = entry && entry->has_static;
+        bool fresh = proc_static_is_fresh(entry);
+        bool needed[FILE_COUNT] = {
+            true,
+            !(cached && (fresh || (flags & SCAN_SKIP_STATUS))) || (flags & SCAN_READ_SCHED),
+            !(cached && (fresh || (flags & SCAN_SKIP_CMDLINE))),
+            (flags & SCAN_READ_IO) != 0,
+            (flags & SCAN_READ_SCHED) != 0,
+        };
+
+        for (int file = 0; file < FILE_COUNT; file++) {
+            if (!needed[file]) continue;
+
+            snprintf(paths[slot][file], sizeof(paths[slot][file]), "/proc/%d/%s",
+                     (int)pids[slot], proc_files[file].name);
+            struct io_uring_sqe *sqe = ring_sqe((unsigned long long)(slot * FILE_COUNT + file));
+            if (!sqe) return abandon_round(count);
+            sqe->opcode = IORING_OP_OPENAT;
+            sqe->fd = AT_FDCWD;
+            sqe->addr = (unsigned long long)(uintptr_t)paths[slot][file];
+            sqe->open_flags = O_RDONLY | O_CLOEXEC;
+            wanted++;
+        }
+    }
+    if (ring_run(wanted) != 0) return abandon_round(count);
+
+    wanted = 0;
+    for (int slot = 0; slot < count; slot++) {
+        for (int file = 0; file < FILE_COUNT; file++) {
+            if (results[slot][file] < 0) continue;
+            fds[slot][file] = results[slot][file];
+
+            struct io_uring_sqe *sqe = ring_sqe((unsigned long long)(slot * FILE_COUNT + file));
+            if (!sqe) return abandon_round(count);
+            sqe->opcode = IORING_OP_READ;
+            sqe->fd = fds[slot][file];
+            sqe->addr = (unsigned long long)(uintptr_t)file_buffer(slot, file, flags);
+            sqe->len = (unsigned)file_size(file, flags) - 1;
+            sqe->off = 0;
+            wanted++;
+        }
+    }
+    if (ring_run(wanted) != 0) return abandon_round(count);
+
+    // Closes go out with the next round's opens (or the next scan)
+    for (int slot = 0; slot < count; slot++) {
+        for (int file = 0; file < FILE_COUNT; file++) {
+            if (fds[slot][file] < 0) continue;
+            struct io_uring_sqe *sqe = ring_sqe(CLOSE_TAG);
+            if (sqe) {
+                sqe->opcode = IORING_OP_CLOSE;
+                sqe->fd = fds[slot][file];
+            } else {
+                close(fds[slot][file]);
+            }
+        }
+    }
+
+    int filled = 0;
+    for (int slot = 0; slot < count; slot++) {
+        ProcessInfo *pinfo = &processes[filled];
+
+        // The stat open failed for another reason than the process being
+        // gone (e.g. EMFILE): use the synchronous reader for this one
+        if (fds[slot][FILE_STAT] < 0) {
+            int err = -results[slot][FILE_STAT];
+            if (err != ENOENT && err != ESRCH &&
+                get_process_info(pids[slot], pinfo, total_mem, flags) == 0) {
+                filled++;
+            }
+            continue;
+        }
+
+        const char *text[FILE_COUNT] = { NULL };
+        int cmdline_len = 0;
+        for (int file = 0; file < FILE_COUNT; file++) {
+            int len = results[slot][file];
+            if (fds[slot][file] < 0 || len < 0) continue;
+            char *buffer = file_buffer(slot, file, flags);
+            buffer[len] = '\0';
+            text[file] = buffer;
+            if (file == FILE_CMDLINE) cmdline_len = len;
+        }
+        if (!text[FILE_STAT] || text[FILE_STAT][0] == '\0') continue;  // Exited between open and read
+
+        // /proc/[pid]/io of other users' processes is denied: same as an unreadable file
+        if ((flags & SCAN_READ_IO) && !text[FILE_IO] &&
+            (results[slot][FILE_IO] == -EACCES || results[slot][FILE_IO] == -EPERM)) {
+            text[FILE_IO] = "";
+        }
+
+        ProcText proc_text = {
+            .stat = text[FILE_STAT],
+            .status = text[FILE_STATUS],
+            .cmdline = text[FILE_CMDLINE],
+            .cmdline_len = (size_t)cmdline_len,
+            .io = text[FILE_IO],
+            .schedstat = text[FILE_SCHEDSTAT],
+        };
+        if (process_info_from_text(pids[slot], &proc_text, system_uptime, pinfo, total_mem, flags) == 0) {
+            filled++;
+        }
+    }
+    return filled;
+}
+
+static int uring_read_batch(const pid_t pids[], int count, ProcessInfo processes[],
+                            unsigned long total_mem, unsigned int flags) {
+    // One uptime sample per batch instead of one per process
+    float system_uptime = read_uptime();
+    int filled = 0;
+
+    for (int start = 0; start < count; start += URING_BATCH) {
+        int round = count - start < URING_BATCH ? count - start : URING_BATCH;
+        int got = ring.fd < 0 ? -1 : read_round(&pids[start], round, &processes[filled], system_uptime, total_mem, flags);
+        if (got < 0) {
+            // Ring failure (or a ring given up on): use the synchronous reader
+            got = 0;
+            for (int i = 0; i < round; i++) {
+                if (get_process_info(pids[start + i], &processes[filled + got], total_mem, flags) == 0) got++;
+            }
+        }
+        filled += got;
+    }
+
+    // Submit the remaining closes without waiting for them
+    if (ring.fd >= 0) ring_run(0);
+    return filled;
+}
+
+const DataSource uring_source = {
+    .name = "io_uring",
+    .open = uring_open,
+    .read = get_process_info,
+    .read_batch = uring_read_batch,
+    .close = uring_close,
+};
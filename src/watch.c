@@ -0,0 +1,362 @@
+#define _POSIX_C_SOURCE 200809L
+#include <pthread.h>
+#include <fcntl.h>
+#include "watch.h"
+#include "process_monitor.h"
+
+// Files of one thread, re-read with pread() on every sample
+typedef struct {
+    pid_t tid;                  // 0 = free slot
+    int fd;                     // /proc/[pid]/task/[tid]/schedstat
+    bool primed;                // cpu_ns holds a previous sample
+    unsigned long long cpu_ns;
+} TaskFiles;
+
+// Fields of /proc/[pid]/stat used by a sample
+typedef struct {
+    char state;
+    unsigned long minflt;
+    unsigned long majflt;
+    unsigned long long cpu_ticks;       // utime + stime
+    unsigned long long start_ticks;
+    unsigned long rss_pages;
+} StatFields;
+
+static pthread_t sampler;
+static bool sampler_running = false;
+static pthread_mutex_t watch_lock = PTHREAD_MUTEX_INITIALIZER;
+
+// Shared with the sampler, guarded by watch_lock
+static WatchSample ring[WATCH_COLUMNS];
+static float thread_ring[WATCH_MAX_THREADS][WATCH_COLUMNS];
+static pid_t thread_tids[WATCH_MAX_THREADS];
+static char thread_names[WATCH_MAX_THREADS][16];
+static int ring_head = 0;               // Next slot written
+static int ring_count = 0;
+static unsigned long long total_samples = 0;
+static bool samples_changed = false;
+static bool exited = false;
+static bool stopping = false;
+
+// Set before the sampler starts, then owned by it
+static pid_t watch_pid = 0;
+static unsigned long long watch_start_ticks = 0;
+static char watch_name[MAX_NAME_LEN];
+static int watch_interval_ms = 0;
+static bool watch_threads = false;
+static int stat_fd = -1;
+static TaskFiles tasks[WATCH_MAX_THREADS];
+
+// Reads a /proc file again from its start; returns the length or -1
+static ssize_t read_at_start(int fd, char *buffer, size_t size) {
+    ssize_t len = pread(fd, buffer, size - 1, 0);
+    if (len < 0) return -1;
+    buffer[len] = '\0';
+    return len;
+}
+
+static bool parse_stat(const char *text, StatFields *fields) {
+    // The name may contain spaces and ')', so count fields after the last ')'
+    const char *p = strrchr(text, ')');
+    if (!p || p[1] != ' ' || p[2] == '\0') return false;
+    p += 2;
+    fields->state = *p++;
+    for (int field = 4; field <= 24; field++) {
+        char *end;
+        unsigned long long value = strtoull(p, &end, 10);
+        if (end == p) return false;
+        p = end;
+        switch (field) {
+            case 10: fields->minflt = (unsigned long)value; break;
+            case 12: fields->majflt = (unsigned long)value; break;
+            case 14: fields->cpu_ticks = value; break;
+            case 15: fields->cpu_ticks += value; break;
+            case 22: fields->start_ticks = value; break;
+            case 24: fields->rss_pages = (unsigned long)value; break;
+        }
+    }
+    return true;
+}
+
+// First field of schedstat: time spent on a CPU in nanoseconds
+static bool read_cpu_ns(int fd, unsigned long long *cpu_ns) {
+    char buffer[128];
+    if (read_at_start(fd, buffer, sizeof(buffer)) <= 0) return false;
+    *cpu_ns = strtoull(buffer, NULL, 10);
+    return true;
+}
+
+static void close_task(int slot) {
+    if (tasks[slot].fd >= 0) close(tasks[slot].fd);
+    memset(&tasks[slot], 0, sizeof(tasks[slot]));
+    tasks[slot].fd = -1;
+}
+
+// Opens the threads that appeared since the last rescan
+static void rescan_tasks(void) {
+    char path[64];
+    snprintf(path, sizeof(path), "/proc/%d/task", watch_pid);
+    DIR *dir = opendir(path);
+    if (!dir) return;
+
+    struct dirent *entry;
+    while ((entry = readdir(dir)) != NULL) {
+        if (!isdigit((unsigned char)entry->d_name[0])) continue;
+        pid_t tid = (pid_t)atoi(entry->d_name);
+
+        int free_slot = -1;
+        bool known = false;
+        for (int i = 0; i < WATCH_MAX_THREADS && !known; i++) {
+            if (tasks[i].tid == tid) known = true;
+            else if (tasks[i].tid == 0 && free_slot < 0) free_slot = i;
+        }
+        if (known || free_slot < 0) continue;
+
+        snprintf(path, sizeof(path), "/proc/%d/task/%d/schedstat", watch_pid, tid);
+        int fd = open(path, O_RDONLY | O_CLOEXEC);
+        if (fd < 0) continue;
+        tasks[free_slot].tid = tid;
+        tasks[free_slot].fd = fd;
+        tasks[free_slot].primed = false;
+
+        char name[16] = "";
+        snprintf(path, sizeof(path), "/proc/%d/task/%d/comm", watch_pid, tid);
+        FILE *fp = fopen(path, "r");
+        if (fp) {
+            if (fgets(name, sizeof(name), fp)) name[strcspn(name, "\n")] = '\0';
+            fclose(fp);
+        }
+
+        pthread_mutex_lock(&watch_lock);
+        thread_tids[free_slot] = tid;
+        memcpy(thread_names[free_slot], name, sizeof(name));
+        memset(thread_ring[free_slot], 0, sizeof(thread_ring[free_slot]));
+        pthread_mutex_unlock(&watch_lock);
+    }
+    closedir(dir);
+}
+
+static void* sampler_main(void *arg) {
+    (void)arg;
+    long clock_ticks = sysconf(_SC_CLK_TCK);
+    bool primed = false;
+    double prev_time = 0.0;
+    unsigned long long prev_cpu_ns = 0;
+    unsigned long prev_minflt = 0, prev_majflt = 0;
+    double next_rescan = 0.0;
+    struct timespec next;
+    clock_gettime(CLOCK_MONOTONIC, &next);
+
+    for (;;) {
+        pthread_mutex_lock(&watch_lock);
+        bool stop = stopping;
+        pthread_mutex_unlock(&watch_lock);
+        if (stop) break;
+
+        double now = monotonic_seconds();
+        if (watch_threads && now >= next_rescan) {
+            rescan_tasks();
+            next_rescan = now + WATCH_TASK_RESCAN_MS / 1000.0;
+        }
+
+        // The same (pid, starttime) must answer, or the process is gone
+        char buffer[1024];
+        StatFields fields;
+        bool alive = read_at_start(stat_fd, buffer, sizeof(buffer)) > 0 &&
+                     parse_stat(buffer, &fields) && fields.start_ticks == watch_start_ticks;
+        if (!alive) {
+            pthread_mutex_lock(&watch_lock);
+            exited = true;
+            samples_changed = true;
+            pthread_mutex_unlock(&watch_lock);
+            break;
+        }
+
+        // utime + stime of stat cover every thread; schedstat of the pid only its leader
+        unsigned long long cpu_ns = fields.cpu_ticks * (1000000000ull / (unsigned long long)clock_ticks);
+        double elapsed = now - prev_time;
+        WatchSample sample = {
+            .state = fields.state,
+            .rss = fields.rss_pages * (unsigned long)sysconf(_SC_PAGESIZE),
+        };
+        if (primed && elapsed > 0.0) {
+            if (cpu_ns >= prev_cpu_ns) sample.cpu = (float)((double)(cpu_ns - prev_cpu_ns) / 1e7 / elapsed);
+            if (fields.minflt >= prev_minflt) sample.minflt_rate = (float)((fields.minflt - prev_minflt) / elapsed);
+            if (fields.majflt >= prev_majflt) sample.majflt_rate = (float)((fields.majflt - prev_majflt) / elapsed);
+        }
+
+        float thread_cpu[WATCH_MAX_THREADS] = { 0 };
+        bool thread_gone[WATCH_MAX_THREADS] = { false };
+        for (int i = 0; i < WATCH_MAX_THREADS; i++) {
+            if (tasks[i].tid == 0) continue;
+            unsigned long long task_ns;
+            if (!read_cpu_ns(tasks[i].fd, &task_ns)) {
+                close_task(i);
+                thread_gone[i] = true;
+                continue;
+            }
+            if (tasks[i].primed && primed && elapsed > 0.0 && task_ns >= tasks[i].cpu_ns) {
+                thread_cpu[i] = (float)((double)(task_ns - tasks[i].cpu_ns) / 1e7 / elapsed);
+            }
+            tasks[i].cpu_ns = task_ns;
+            tasks[i].primed = true;
+        }
+
+        pthread_mutex_lock(&watch_lock);
+        for (int i = 0; i < WATCH_MAX_THREADS; i++) {
+            if (thread_gone[i]) thread_tids[i] = 0;
+        }
+        // The first read only gives the counters the next sample is measured against
+        if (primed) {
+            ring[ring_head] = sample;
+            for (int i = 0; i < WATCH_MAX_THREADS; i++) {
+                thread_ring[i][ring_head] = thread_cpu[i];
+            }
+            ring_head = (ring_head + 1) % WATCH_COLUMNS;
+            if (ring_count < WATCH_COLUMNS) ring_count++;
+            total_samples++;
+            samples_changed = true;
+        }
+        pthread_mutex_unlock(&watch_lock);
+        primed = true;
+        prev_time = now;
+        prev_cpu_ns = cpu_ns;
+        prev_minflt = fields.minflt;
+        prev_majflt = fields.majflt;
+
+        // Keep the cadence; after a stall, start over from now instead of catching up
+        next.tv_nsec += (long)watch_interval_ms * 1000000L;
+        while (next.tv_nsec >= 1000000000L) {
+            next.tv_nsec -= 1000000000L;
+            next.tv_sec++;
+        }
+        struct timespec current;
+        clock_gettime(CLOCK_MONOTONIC, &current);
+        if (current.tv_sec > next.tv_sec ||
+            (current.tv_sec == next.tv_sec && current.tv_nsec > next.tv_nsec)) {
+            next = current;
+        }
+        clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &next, NULL);
+    }
+    return NULL;
+}
+
+int watch_start(pid_t pid, unsigned long long start_ticks, int interval_ms, bool with_threads) {
+    watch_stop();
+    if (pid <= 0) return -1;
+
+    char path[64];
+    snprintf(path, sizeof(path), "/proc/%d/stat", pid);
+    stat_fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (stat_fd < 0) return -1;
+
+    char buffer[1024];
+    StatFields fields;
+    if (read_at_start(stat_fd, buffer, sizeof(buffer)) <= 0 || !parse_stat(buffer, &fields) ||
+        fields.start_ticks != start_ticks) {
+        close(stat_fd);
+        stat_fd = -1;
+        return -1;
+    }
+    const char *open_paren = strchr(buffer, '(');
+    const char *close_paren = strrchr(buffer, ')');
+    int name_len = (open_paren && close_paren > open_paren) ? (int)(close_paren - open_paren - 1) : 0;
+    snprintf(watch_name, sizeof(watch_name), "%.*s", name_len, open_paren ? open_paren + 1 : "");
+
+    if (interval_ms < WATCH_MIN_INTERVAL_MS) interval_ms = WATCH_MIN_INTERVAL_MS;
+    if (interval_ms > WATCH_MAX_INTERVAL_MS) interval_ms = WATCH_MAX_INTERVAL_MS;
+    watch_pid = pid;
+    watch_start_ticks = start_ticks;
+    watch_interval_ms = interval_ms;
+    watch_threads = with_threads;
+    for (int i = 0; i < WATCH_MAX_THREADS; i++) {
+        tasks[i].tid = 0;
+        tasks[i].fd = -1;
+    }
+
+    pthread_mutex_lock(&watch_lock);
+    ring_head = 0;
+    ring_count = 0;
+    total_samples = 0;
+    memset(thread_tids, 0, sizeof(thread_tids));
+    samples_changed = true;
+    exited = false;
+    stopping = false;
+    pthread_mutex_unlock(&watch_lock);
+
+    if (pthread_create(&sampler, NULL, sampler_main, NULL) != 0) {
+        close(stat_fd);
+        stat_fd = -1;
+        watch_pid = 0;
+        return -1;
+    }
+    sampler_running = true;
+    return 0;
+}
+
+void watch_stop(void) {
+    if (!sampler_running) return;
+    pthread_mutex_lock(&watch_lock);
+    stopping = true;
+    pthread_mutex_unlock(&watch_lock);
+    pthread_join(sampler, NULL);  // Wakes up within one interval
+    sampler_running = false;
+
+    for (int i = 0; i < WATCH_MAX_THREADS; i++) {
+        if (tasks[i].tid != 0) close_task(i);
+    }
+    close(stat_fd);
+    stat_fd = -1;
+    watch_pid = 0;
+}
+
+bool watch_active(void) {
+    return sampler_running;
+}
+
+static int compare_threads(const void *a, const void *b) {
+    const WatchThread *ta = (const WatchThread *)a;
+    const WatchThread *tb = (const WatchThread *)b;
+    return (tb->cpu_total > ta->cpu_total) - (tb->cpu_total < ta->cpu_total);
+}
+
+bool watch_get(WatchView *view) {
+    if (!sampler_running) {
+        if (view) view->pid = 0;
+        return false;
+    }
+
+    pthread_mutex_lock(&watch_lock);
+    bool changed = samples_changed;
+    samples_changed = false;
+    if (view) {
+        view->pid = watch_pid;
+        memcpy(view->name, watch_name, sizeof(view->name));
+        view->interval_ms = watch_interval_ms;
+        view->exited = exited;
+        view->count = ring_count;
+        view->total_samples = total_samples;
+        int oldest = (ring_head - ring_count + WATCH_COLUMNS) % WATCH_COLUMNS;
+        for (int i = 0; i < ring_count; i++) {
+            view->samples[i] = ring[(oldest + i) % WATCH_COLUMNS];
+        }
+        view->thread_count = 0;
+        for (int t = 0; t < WATCH_MAX_THREADS; t++) {
+            if (thread_tids[t] == 0) continue;
+            WatchThread *thread = &view->threads[view->thread_count++];
+            thread->tid = thread_tids[t];
+            memcpy(thread->name, thread_names[t], sizeof(thread->name));
+            thread->cpu_total = 0.0f;
+            for (int i = 0; i < ring_count; i++) {
+                thread->cpu[i] = thread_ring[t][(oldest + i) % WATCH_COLUMNS];
+                thread->cpu_total += thread->cpu[i];
+            }
+        }
+    }
+    pthread_mutex_unlock(&watch_lock);
+
+    if (view && view->thread_count > 1) {
+        qsort(view->threads, view->thread_count, sizeof(WatchThread), compare_threads);
+    }
+    return changed;
+}
@@ -204,6 +204,110 @@ test_signal_handling() {
     fi
 }
 
+# Test 11: --batch --filter finds a known process and only that one
+test_batch_filter() {
+    echo -n "Test 11: Batch filter matches a known process... "
+    sleep 271.828 &
+    local marker=$!
+    local output=$("$BINARY" --batch --filter "name=sleep cmd~271.828" 2>/dev/null)
+    kill $marker 2>/dev/null
+    wait $marker 2>/dev/null
+
+    local rows=$(echo "$output" | tail -n +2 | wc -l)
+    if echo "$output" | head -1 | grep -q "^PID" && [ "$rows" -eq 1 ] &&
+       echo "$output" | tail -1 | grep -q "^$marker "; then
+        echo -e "${GREEN}PASS${NC}"
+        return 0
+    fi
+    echo -e "${RED}FAIL${NC}"
+    echo "  Expected one row for PID $marker, got:"
+    echo "$output" | sed 's/^/    /'
+    return 1
+}
+
+# Test 12: batch CPU% is measured between two samples, not over the lifetime
+test_batch_rates() {
+    echo -n "Test 12: Batch CPU rate filter... "
+    # Busy now after 1.5s idle: its lifetime average stays below 50%
+    sh -c 'sleep 1.5; exec yes' > /dev/null &
+    local busy=$!
+    sleep 1.7
+    local output=$("$BINARY" --batch --filter "name=yes cpu>50" 2>/dev/null)
+    kill $busy 2>/dev/null
+    wait $busy 2>/dev/null
+
+    if echo "$output" | grep -q "^$busy "; then
+        echo -e "${GREEN}PASS${NC}"
+        return 0
+    fi
+    echo -e "${RED}FAIL${NC}"
+    echo "  PID $busy not reported above 50% CPU"
+    return 1
+}
+
+# Builds tests/test_units.c against the objects of the last build
+build_unit_drivers() {
+    UNIT_DIR=$(mktemp -d)
+    local objects=$(ls "$PROJECT_ROOT"/build/*.o | grep -v '/main\.o$')
+    gcc -std=c11 -pthread -I"$PROJECT_ROOT/include" "$SCRIPT_DIR/test_units.c" $objects \
+        -pthread -o "$UNIT_DIR/test_units" 2>"$UNIT_DIR/build.log"
+}
+
+# Test 13: unit drivers for the filter, alert and range parsers, hash slots, tree, churn and cursor
+test_unit_drivers() {
+    echo -n "Test 13: Unit drivers pass... "
+    if ! build_unit_drivers; then
+        echo -e "${RED}FAIL${NC}"
+        sed 's/^/  /' "$UNIT_DIR/build.log"
+        rm -rf "$UNIT_DIR"
+        return 1
+    fi
+
+    local output
+    output=$("$UNIT_DIR/test_units")
+    local status=$?
+    rm -rf "$UNIT_DIR"
+    if [ $status -eq 0 ]; then
+        echo -e "${GREEN}PASS${NC}"
+        return 0
+    fi
+    echo -e "${RED}FAIL${NC}"
+    echo "$output"
+    return 1
+}
+
+# Test 14: a --daemon client sees new and exited processes through deltas
+test_remote_delta() {
+    echo -n "Test 14: Daemon snapshot and deltas... "
+    if ! build_unit_drivers; then
+        echo -e "${RED}FAIL${NC} (unit drivers don't build)"
+        rm -rf "$UNIT_DIR"
+        return 1
+    fi
+
+    local socket="$UNIT_DIR/daemon.sock"
+    "$BINARY" --daemon "$socket" > /dev/null 2>&1 &
+    local daemon=$!
+    for i in $(seq 50); do
+        [ -S "$socket" ] && break
+        sleep 0.1
+    done
+
+    local output
+    output=$("$UNIT_DIR/test_units" remote "$socket")
+    local status=$?
+    kill $daemon 2>/dev/null
+    wait $daemon 2>/dev/null
+    rm -rf "$UNIT_DIR"
+    if [ $status -eq 0 ]; then
+        echo -e "${GREEN}PASS${NC}"
+        return 0
+    fi
+    echo -e "${RED}FAIL${NC}"
+    echo "$output"
+    return 1
+}
+
 # Run all tests
 echo "Running tests..."
 echo ""
@@ -222,6 +326,10 @@ tests=(
     test_v22_features
     test_binary_size
     test_signal_handling
+    test_batch_filter
+    test_batch_rates
+    test_unit_drivers
+    test_remote_delta
 )
 
 for test in "${tests[@]}"; do
@@ -0,0 +1,267 @@
+// Unit drivers for the parsers and table algorithms, run by test_basic.sh.
+// Built against the objects in build/ (everything but main.o):
+//   ./test_units           runs the in-process checks
+//   ./test_units remote S  checks snapshot and delta updates from a daemon on socket S
+#define _POSIX_C_SOURCE 200809L
+#include <signal.h>
+#include <termios.h>
+#include <sys/wait.h>
+#include "filter.h"
+#include "process_monitor.h"
+#include "proc_table.h"
+#include "alerts.h"
+#include "history.h"
+#include "tree.h"
+#include "churn.h"
+#include "cursor.h"
+#include "remote.h"
+
+struct termios orig_termios;  // Defined in main.c, used by signal_handler.c
+
+static int failures = 0;
+
+#define CHECK(cond) do { \
+        if (!(cond)) { \
+            printf("  FAIL %s:%d: %s\n", __FILE__, __LINE__, #cond); \
+            failures++; \
+        } \
+    } while (0)
+
+static ProcessInfo row(pid_t pid, pid_t ppid, const char *name, const char *user, float cpu) {
+    ProcessInfo p;
+    memset(&p, 0, sizeof(p));
+    p.pid = pid;
+    p.ppid = ppid;
+    p.start_ticks = 1000 + pid;
+    p.state = 'S';
+    p.cpu_usage = cpu;
+    p.rss = 64ul << 20;
+    snprintf(p.name, sizeof(p.name), "%s", name);
+    snprintf(p.user, sizeof(p.user), "%s", user);
+    snprintf(p.cmdline, sizeof(p.cmdline), "/usr/bin/%s --serve", name);
+    return p;
+}
+
+static void test_filter(void) {
+    ProcessFilter filter;
+    char error[256];
+
+    CHECK(filter_compile("user=root cpu>5 rss>32M name~JA", &filter, error, sizeof(error)) == 0);
+    CHECK(filter.count == 4);
+    ProcessInfo java = row(10, 1, "java", "root", 12.0f);
+    CHECK(filter_match(&filter, &java));
+    java.cpu_usage = 5.0f;
+    CHECK(!filter_match(&filter, &java));
+    ProcessInfo other = row(11, 1, "java", "postgres", 50.0f);
+    CHECK(!filter_match(&filter, &other));
+
+    CHECK(filter_compile("state=S cmd~serve", &filter, error, sizeof(error)) == 0);
+    CHECK(filter_match(&filter, &other));
+    CHECK(filter_compile("state=s", &filter, error, sizeof(error)) == 0);
+    CHECK(!filter_match(&filter, &other));  // States are case-sensitive
+
+    CHECK(filter_compile("read>1M csw>10", &filter, error, sizeof(error)) == 0);
+    CHECK(filter_scan_flags(&filter) == (SCAN_READ_IO | SCAN_READ_SCHED));
+    CHECK(filter_compile("cpu>5 name~x", &filter, error, sizeof(error)) == 0);
+    CHECK(filter_scan_flags(&filter) == 0);
+
+    CHECK(filter_compile("", &filter, error, sizeof(error)) == 0);
+    CHECK(filter.count == 0 && filter_match(&filter, &other));
+
+    CHECK(filter_compile("cpu>>5", &filter, error, sizeof(error)) == -1);
+    CHECK(filter_compile("colour=red", &filter, error, sizeof(error)) == -1);
+    CHECK(filter_compile("user>root", &filter, error, sizeof(error)) == -1);
+    CHECK(error[0] != '\0');
+}
+
+// Values 1..4 all hash to slot 6 of 8, so they probe into 6, 7, 0, 1
+static unsigned int colliding_hash(int value) {
+    return value == 5 ? 7u : 6u;
+}
+
+static void test_hash_slots(void) {
+    CHECK(hash_string("") == 2166136261u);
+    CHECK(hash_string("a") == 0xe40c292cu);
+
+    int slots[8] = { 3, 4, 0, 0, 0, 0, 1, 2 };
+    hash_slots_delete(slots, 8, 7, colliding_hash);  // The chain closes up behind the hole
+    CHECK(slots[6] == 1 && slots[7] == 3 && slots[0] == 4 && slots[1] == 0);
+
+    int others[8] = { 0, 0, 0, 0, 0, 0, 1, 5 };
+    hash_slots_delete(others, 8, 6, colliding_hash);  // 5 is already home and stays
+    CHECK(others[6] == 0 && others[7] == 5);
+}
+
+static void test_alerts(void) {
+    char error[256];
+    static char rules[3][ALERT_RULE_LEN] = {
+        "hot: cpu>50",
+        "many: count(name=java)>1 for 5m",
+        "memory: system.mem>90 for 1m clear system.mem<85",
+    };
+    CHECK(alerts_compile((const char (*)[ALERT_RULE_LEN])rules, 3, error, sizeof(error)) == 0);
+    CHECK(alerts_scan_flags() == 0);
+
+    ProcessInfo rows[2] = { row(20, 1, "java", "root", 80.0f), row(21, 1, "java", "root", 1.0f) };
+    sysinfo_t sysinfo;
+    memset(&sysinfo, 0, sizeof(sysinfo));
+    alerts_evaluate(rows, 2, &sysinfo, 0.0f, 0);
+    CHECK(alerts_is_firing(20));
+    CHECK(!alerts_is_firing(21));
+    CHECK(alerts_stats().firing == 1);  // "many" waits for its hold time
+
+    rows[0].cpu_usage = 10.0f;
+    alerts_evaluate(rows, 2, &sysinfo, 0.0f, 0);
+    CHECK(!alerts_is_firing(20));
+
+    static char bad[2][ALERT_RULE_LEN] = { "no colon here", "x: count(name=a" };
+    CHECK(alerts_compile((const char (*)[ALERT_RULE_LEN])bad, 1, error, sizeof(error)) == -1);
+    CHECK(alerts_compile((const char (*)[ALERT_RULE_LEN])bad + 1, 1, error, sizeof(error)) == -1);
+    static char io[1][ALERT_RULE_LEN] = { "writer: cpu>1 clear write<1M" };
+    CHECK(alerts_compile((const char (*)[ALERT_RULE_LEN])io, 1, error, sizeof(error)) == 0);
+    CHECK(alerts_scan_flags() == SCAN_READ_IO);
+    CHECK(alerts_compile(NULL, 0, error, sizeof(error)) == 0);
+}
+
+static void test_history_range(void) {
+    time_t from, to;
+    CHECK(history_parse_range("-30m", &from, &to) == 0);
+    CHECK(to - from == 30 * 60);
+    CHECK(history_parse_range("-2d,-1d", &from, &to) == 0);
+    CHECK(to - from == 24 * 3600);
+    CHECK(history_parse_range("2026-01-02 03:04,2026-01-02 04:04:30", &from, &to) == 0);
+    CHECK(to - from == 3630);
+    CHECK(history_parse_range("10:00", &from, &to) == 0);
+    CHECK(from <= to && to - from < 24 * 3600);
+    CHECK(history_parse_range("", &from, &to) == -1);
+    CHECK(history_parse_range("yesterday", &from, &to) == -1);
+    CHECK(history_parse_range("-5x", &from, &to) == -1);
+}
+
+static void test_tree(void) {
+    // Sorted rows; 3 is a child of 2, 2 and 4 children of 1, 9's parent is not listed
+    ProcessInfo rows[5] = {
+        row(4, 1, "d", "root", 1.0f), row(3, 2, "c", "root", 2.0f), row(9, 8, "orphan", "root", 0.0f),
+        row(2, 1, "b", "root", 3.0f), row(1, 0, "init", "root", 4.0f),
+    };
+    ProcessInfo out[5];
+    CHECK(tree_build(rows, 5, out, 5) == 5);
+
+    pid_t order[5] = { 0 };
+    int depth[5] = { 0 };
+    for (int i = 0; i < 5; i++) {
+        order[i] = out[i].pid;
+        depth[i] = out[i].tree_depth;
+    }
+    // Siblings keep the order of 'rows': 4 before 2, roots 9 before 1
+    CHECK(order[0] == 9 && depth[0] == 0);
+    CHECK(order[1] == 1 && depth[1] == 0);
+    CHECK(order[2] == 4 && depth[2] == 1);
+    CHECK(order[3] == 2 && depth[3] == 1);
+    CHECK(order[4] == 3 && depth[4] == 2);
+}
+
+static void test_churn(void) {
+    churn_reset();
+    ProcessInfo rows[3] = { row(1, 0, "a", "root", 0.0f), row(2, 1, "b", "root", 0.0f),
+                            row(3, 1, "c", "root", 0.0f) };
+    churn_update(rows, 3, 100.0f);
+    CHECK(!churn_stats().valid);
+
+    rows[1] = row(4, 1, "d", "root", 0.0f);  // 2 exited, 4 started
+    churn_update(rows, 3, 101.0f);
+    ChurnStats stats = churn_stats();
+    CHECK(stats.valid && stats.started == 1 && stats.exited == 1);
+    CHECK(rows[1].is_new && !rows[0].is_new && !rows[2].is_new);
+
+    ExitedProcess exits[CHURN_RECENT_EXITS];
+    CHECK(churn_recent_exits(exits) >= 1 && exits[0].pid == 2);
+
+    rows[2].start_ticks++;  // PID 3 recycled: one exit plus one start
+    churn_update(rows, 3, 102.0f);
+    stats = churn_stats();
+    CHECK(stats.started == 1 && stats.exited == 1 && rows[2].is_new);
+}
+
+static void test_cursor(void) {
+    ProcessInfo rows[3] = { row(10, 1, "a", "root", 0.0f), row(20, 1, "b", "root", 0.0f),
+                            row(30, 1, "c", "root", 0.0f) };
+    Cursor cursor = { .pid = 20, .start_ticks = rows[1].start_ticks, .row = 0 };
+    CHECK(cursor_locate(&cursor, rows, 3) == 1);
+    CHECK(cursor_find(30) == 2 && cursor_find(99) == -1);
+
+    // Re-sorted: the selection follows the process
+    ProcessInfo swapped[3] = { rows[1], rows[2], rows[0] };
+    CHECK(cursor_locate(&cursor, swapped, 3) == 0 && cursor.pid == 20);
+
+    // Gone: the row stays and selects what is there now, clamped to the list
+    ProcessInfo rest[2] = { rows[0], rows[2] };
+    cursor.row = 1;
+    cursor.pid = 20;
+    CHECK(cursor_locate(&cursor, rest, 2) == 1 && cursor.pid == 30);
+    cursor_move(&cursor, rest, 2, -5);
+    CHECK(cursor.row == 0 && cursor.pid == 10);
+
+    // The main thread of an expanded process has its PID: moving down leaves the process row
+    ProcessInfo expanded[3] = { rows[0], rows[0], rows[1] };
+    expanded[1].is_thread = true;
+    cursor_move(&cursor, expanded, 3, 1);
+    CHECK(cursor_locate(&cursor, expanded, 3) == 1 && cursor.is_thread);
+    cursor_move(&cursor, expanded, 3, 1);
+    CHECK(cursor_locate(&cursor, expanded, 3) == 2 && cursor.pid == 20);
+    CHECK(cursor_find(10) == 0);
+
+    CHECK(cursor_locate(&cursor, rows, 0) == -1);
+}
+
+static ProcessInfo remote_rows[MAX_PROCESS];
+
+// Waits until 'pid' is (or is no longer) among the daemon's rows
+static bool remote_wait(pid_t pid, bool present) {
+    sysinfo_t sysinfo;
+    for (int tries = 0; tries < 200; tries++) {
+        int count = remote_receive(remote_rows, MAX_PROCESS, &sysinfo);
+        bool found = false;
+        for (int i = 0; i < count; i++) {
+            if (remote_rows[i].pid == pid) found = true;
+        }
+        if (count > 0 && found == present) return true;
+        struct timespec pause = { .tv_sec = 0, .tv_nsec = 50000000L };
+        nanosleep(&pause, NULL);
+    }
+    return false;
+}
+
+static int test_remote(const char *path) {
+    pid_t child = fork();
+    if (child == 0) {
+        execlp("sleep", "sleep", "30", (char *)NULL);
+        _exit(127);
+    }
+    CHECK(child > 0);
+    CHECK(remote_connect(path) == 0);
+
+    // The first scan after the fork carries the new row, the one after the kill its removal
+    CHECK(remote_wait(child, true));
+    kill(child, SIGKILL);
+    waitpid(child, NULL, 0);
+    CHECK(remote_wait(child, false));
+
+    remote_close();
+    return failures == 0 ? 0 : 1;
+}
+
+int main(int argc, char *argv[]) {
+    if (argc == 3 && strcmp(argv[1], "remote") == 0) {
+        return test_remote(argv[2]);
+    }
+
+    test_filter();
+    test_hash_slots();
+    test_alerts();
+    test_history_range();
+    test_tree();
+    test_churn();
+    test_cursor();
+    return failures == 0 ? 0 : 1;
+}